@@ -929,6 +929,8 @@ define_or_generate(Pred) :-
     '$get_predicate_attribute'(Pred, last_modified_generation, Gen).
 '$predicate_property'(indexed(Indices), Pred) :-
     '$get_predicate_attribute'(Pred, indexed, Indices).
+'$predicate_property'(list_indexed(Positions), Pred) :-
+    '$get_predicate_attribute'(Pred, list_indexed, Positions).
 '$predicate_property'(noprofile, Pred) :-
     '$get_predicate_attribute'(Pred, noprofile, 1).
 '$predicate_property'(iso, Pred) :-
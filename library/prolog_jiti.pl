@@ -35,19 +35,37 @@
 
 :- module(prolog_jiti,
           [ jiti_list/0,
-            jiti_list/1                         % +Spec
+            jiti_list/1,                        % +Spec
+            jiti_save_manifest/1,               % +File
+            jiti_load_manifest/1,               % +File
+            jiti_load_manifest/2,               % +File, +Options
+            jiti_range_index/2,                 % :Head, +Arg
+            jiti_range/4,                       % :Head, +Arg, ?Low, ?High
+            jiti_range_clauses/5                % :Head, +Arg, ?Low, ?High, -Refs
           ]).
 :- use_module(library(apply)).
 :- use_module(library(dcg/basics)).
+:- use_module(library(lists)).
+:- use_module(library(option)).
+:- use_module(library(error)).
+:- use_module(library(thread), [concurrent/3]).
 
 :- meta_predicate
-    jiti_list(:).
+    jiti_list(:),
+    jiti_range_index(:, +),
+    jiti_range(:, +, ?, ?),
+    jiti_range_clauses(:, +, ?, ?, -).
 
 /** <module> Just In Time Indexing (JITI) utilities
 
 This module provides utilities to   examine just-in-time indexes created
 by the system and can help diagnosing space and performance issues.
 
+In addition, it allows saving the indexes  created by a running process
+to an _index manifest_ and  creating  these   indexes  eagerly  in a new
+process. This avoids  the  delay  of   building  large  indexes  on the
+first queries that need them.
+
 @tbd	Use print_message/2 and dynamically figure out the column width.
 */
 
@@ -71,6 +89,10 @@ by the system and can help diagnosing space and performance issues.
 %       - A plain integer refers to a 1-based argument number
 %       - _|A+B|_ is a multi-argument index on the arguments _A_ and _B_.
 %       - _|A/B|_ is a deep-index on sub-argument _B_ of argument _A_.
+%       - _|A/[B]|_ is a deep-index on argument _B_ of a list cell
+%         in argument _A_, where _B_ is `1` for the head of the list.
+%       - _|A.K|_ is an index on the value of key _K_ of a dict in
+%         argument _A_.  Dicts with different key sets may be mixed.
 %     - The _Buckets_ specifies the number of buckets of the hash table
 %     - The _Speedup_ specifies the selectivity of the index
 %     - The _Flags_ describes additional properties, currently:
@@ -101,8 +123,12 @@ jiti_list(Module:Name) :-
     jiti_list(Module:Head).
 jiti_list(Head) :-
     findall(Head-Indexed,
-            (   predicate_property(Head, indexed(Indexed)),
-                \+ predicate_property(Head, imported_from(_))
+            (   predicate_property(Head, indexed(Indexed0)),
+                \+ predicate_property(Head, imported_from(_)),
+                (   predicate_property(Head, list_indexed(Lists))
+                ->  maplist(mark_list_index(Lists), Indexed0, Indexed)
+                ;   Indexed = Indexed0
+                )
             ), Pairs),
     format('Predicate~46|~w ~t~8+ ~t~w~6+ ~t~w~6+ ~t~w~5+~n',
            ['Indexed','Buckets','Speedup','Flags']),
@@ -120,6 +146,11 @@ print_indexed((M:Head)-[Args-hash(Buckets,Speedup,_Size,List)|More]) :-
 print_indexed(Pair) :-
     format('Failed: ~p~n', [Pair]).
 
+mark_list_index(Lists, deep(Path)-Hash, list(Path)-Hash) :-
+    memberchk(Path, Lists),
+    !.
+mark_list_index(_, Index, Index).
+
 print_secondary_index(Args-hash(Buckets,Speedup,_Size,List)) :-
     phrase(iarg_spec(Args), ArgsS),
     phrase(iflags(List), Flags),
@@ -133,8 +164,14 @@ iarg_spec(single(N)) -->
     number(N).
 iarg_spec(multi(L)) -->
     plus_list(L).
+iarg_spec(dict_key(N, Key)) -->
+    number(N),
+    ".",
+    atom(Key).
 iarg_spec(deep(List)) -->
     deep_list(List).
+iarg_spec(list(List)) -->
+    list_path(List).
 
 plus_list([H|T]) -->
     number(H),
@@ -152,6 +189,189 @@ deep_list([H|T]) -->
     "/",
     deep_list(T).
 
+list_path([H,Last]) -->
+    !,
+    number(H),
+    "/[",
+    iarg_spec(Last),
+    "]".
+list_path([H|T]) -->
+    number(H),
+    "/",
+    list_path(T).
+
 
 iflags(true)  --> "L".
 iflags(false) --> "".
+
+
+		 /*******************************
+		 *          MANIFEST		*
+		 *******************************/
+
+%!  jiti_save_manifest(+File) is det.
+%
+%   Save the indexes that are currently   available for all predicates
+%   to File. The file  contains  terms  of   the  form  below,  where
+%   Indexed is a term as described   with  predicate_property/2 using
+%   indexed(List) and Buckets is the number of buckets of the index.
+%
+%       jiti_index(Module:Name/Arity, Indexed, Buckets).
+%
+%   Using jiti_load_manifest/1,2, a new process   can create the same
+%   indexes before they are needed, for example after loading a large
+%   fact base from a saved state or QLF file.
+
+jiti_save_manifest(File) :-
+    findall(jiti_index(M:Name/Arity, Where, Buckets),
+            manifest_index(M:Name/Arity, Where, Buckets),
+            Indexes0),
+    sort(Indexes0, Indexes),
+    setup_call_cleanup(
+        open(File, write, Out, [encoding(utf8)]),
+        ( format(Out, '/* Index manifest created by jiti_save_manifest/1 */~n~n', []),
+          forall(member(Index, Indexes),
+                 write_term(Out, Index,
+                            [ quoted(true),
+                              fullstop(true),
+                              nl(true)
+                            ]))
+        ),
+        close(Out)).
+
+manifest_index(M:Name/Arity, Where, Buckets) :-
+    predicate_property(M:Head, indexed(Indexed)),
+    \+ predicate_property(M:Head, imported_from(_)),
+    functor(Head, Name, Arity),
+    member(Where-hash(Buckets, _Speedup, _Size, _IsList), Indexed).
+
+%!  jiti_load_manifest(+File) is det.
+%!  jiti_load_manifest(+File, +Options) is det.
+%
+%   Create the indexes described in the  index manifest File, created
+%   using jiti_save_manifest/1. Indexes for  predicates that  do not
+%   exist or for which the index is   no longer considered worthwhile
+%   are silently ignored. Options:
+%
+%     - threads(+Count)
+%       Build the indexes of different predicates using Count threads.
+%       Default is the Prolog flag `cpu_count`.  Using `1` creates
+%       the indexes in the calling thread.
+
+jiti_load_manifest(File) :-
+    jiti_load_manifest(File, []).
+
+jiti_load_manifest(File, Options) :-
+    read_manifest(File, Indexes),
+    manifest_goals(Indexes, Goals),
+    (   current_prolog_flag(threads, true)
+    ->  current_prolog_flag(cpu_count, DefThreads)
+    ;   DefThreads = 1
+    ),
+    option(threads(Threads0), Options, DefThreads),
+    must_be(positive_integer, Threads0),
+    length(Goals, Len),
+    Threads is max(1, min(Threads0, Len)),
+    (   Threads =:= 1
+    ->  maplist(call, Goals)
+    ;   concurrent(Threads, Goals, [])
+    ).
+
+read_manifest(File, Indexes) :-
+    setup_call_cleanup(
+        open(File, read, In, [encoding(utf8)]),
+        read_manifest_terms(In, Indexes),
+        close(In)).
+
+read_manifest_terms(In, Indexes) :-
+    read_term(In, Term, []),
+    (   Term == end_of_file
+    ->  Indexes = []
+    ;   Term = jiti_index(_,_,_)
+    ->  Indexes = [Term|T],
+        read_manifest_terms(In, T)
+    ;   type_error(jiti_index, Term)
+    ).
+
+%   manifest_goals(+Indexes, -Goals) creates a goal per predicate. The
+%   indexes of a single predicate are created sequentially, top-level
+%   indexes before deep indexes that depend on them.
+
+manifest_goals(Indexes, Goals) :-
+    map_list_to_pairs(index_pred, Indexes, Pairs0),
+    keysort(Pairs0, Pairs),
+    group_pairs_by_key(Pairs, Grouped),
+    maplist(pred_goal, Grouped, Goals).
+
+index_pred(jiti_index(PI, _, _), PI).
+
+pred_goal((M:Name/Arity)-Indexes, create_indexes(M:Head, Ordered)) :-
+    functor(Head, Name, Arity),
+    map_list_to_pairs(index_order, Indexes, Pairs0),
+    keysort(Pairs0, Pairs),
+    pairs_values(Pairs, Ordered).
+
+index_order(jiti_index(_, deep(Path), _), Depth) :-
+    !,
+    length(Path, Depth).
+index_order(_, 0).
+
+create_indexes(M:Head, Indexes) :-
+    (   current_predicate(_, M:Head),
+        \+ predicate_property(M:Head, imported_from(_))
+    ->  forall(member(jiti_index(_, Where, Buckets), Indexes),
+               ignore('$jiti_create_index'(M:Head, Where, Buckets)))
+    ;   true
+    ).
+
+
+		 /*******************************
+		 *        RANGE QUERIES		*
+		 *******************************/
+
+%!  jiti_range_index(:Head, +Arg) is det.
+%
+%   Select a sorted _range index_ on argument Arg of the predicate Head.
+%   The index is created immediately and maintained incrementally when
+%   clauses are added or removed: assertz/1 and asserta/1 add the clause
+%   to a small unsorted part that is merged into the sorted part by a
+%   later query, and retracted clauses are removed by clause garbage
+%   collection.  Only inserting a clause in the middle of the predicate,
+%   which happens when reloading a file, causes the next query to rebuild
+%   the index.  Range indexes are used by jiti_range/4 and
+%   jiti_range_clauses/5, which select a range index on Arg themselves
+%   if the predicate has none.
+
+jiti_range_index(M:Head, Arg) :-
+    '$jiti_range_index'(M:Head, Arg).
+
+%!  jiti_range(:Head, +Arg, ?Low, ?High) is nondet.
+%
+%   Call the clauses of the predicate Head  for which argument Arg is an
+%   atomic value in the range Low..High (inclusive) in the standard
+%   order of terms. Low  and/or High may  be  unbound to denote an open
+%   bound. Clauses are tried in the standard  order of the key in Arg
+%   rather than in clause order. Clauses for  which Arg is not atomic or
+%   is a string are not considered.
+%
+%   The clauses are found using a  sorted _range index_ on Arg. See
+%   jiti_range_index/2.
+
+jiti_range(M:Head, Arg, Low, High) :-
+    '$clause_range'(M:Head, Arg, Low, High, Refs),
+    member(Ref, Refs),
+    clause(M:Head, Body, Ref),
+    (   Body == true
+    ->  true
+    ;   clause_property(Ref, module(CM)),
+        call(CM:Body)
+    ).
+
+%!  jiti_range_clauses(:Head, +Arg, ?Low, ?High, -Refs) is det.
+%
+%   Refs is a list of clause references  for the clauses of Head whose
+%   argument Arg is in the range Low..High,  ordered by the key in Arg.
+%   See jiti_range/4.
+
+jiti_range_clauses(M:Head, Arg, Low, High, Refs) :-
+    '$clause_range'(M:Head, Arg, Low, High, Refs).
@@ -90,6 +90,8 @@ save_option(foreign,     qsave_foreign_option,
             "Include foreign code in state").
 save_option(obfuscate,   boolean,
             "Obfuscate identifiers").
+save_option(lazy_load,   boolean,
+            "Load clauses on first call").
 save_option(verbose,     boolean,
             "Be more verbose about the state creation").
 save_option(undefined,   oneof([ignore,error]),
@@ -261,6 +263,7 @@ convert_option(_, Value, Value, '~w').
 
 doption(Name) :- min_stack(Name, _).
 doption(init_file).
+doption(lazy_load).
 doption(system_init_file).
 doption(class).
 doption(home).
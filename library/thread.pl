@@ -38,6 +38,8 @@
             concurrent_maplist/2,       % :Goal, +List
             concurrent_maplist/3,       % :Goal, ?List1, ?List2
             concurrent_maplist/4,       % :Goal, ?List1, ?List2, ?List3
+            concurrent_forall/2,        % :Cond, :Action
+            concurrent_forall/3,        % :Cond, :Action, +Options
             first_solution/3            % -Var, :Goals, +Options
           ]).
 :- use_module(library(debug)).
@@ -53,11 +55,16 @@
     concurrent_maplist(1, +),
     concurrent_maplist(2, ?, ?),
     concurrent_maplist(3, ?, ?, ?),
+    concurrent_forall(0, 0),
+    concurrent_forall(0, 0, +),
     first_solution(-, :, +).
 
 :- predicate_options(concurrent/3, 3,
                      [ pass_to(system:thread_create/3, 3)
                      ]).
+:- predicate_options(concurrent_forall/3, 3,
+                     [ threads(nonneg)
+                     ]).
 :- predicate_options(first_solution/3, 3,
                      [ on_fail(oneof([stop,continue])),
                        on_error(oneof([stop,continue])),
@@ -94,6 +101,21 @@ following consequences:
     with long-blocking foreign predicates may result in long delays,
     even if another thread asks for cancellation.
 
+concurrent_maplist/2, concurrent_forall/2 and first_solution/3 run their
+goals as _tasks_ on the task scheduler of the core rather than creating
+threads for each call. The scheduler uses a fixed pool of worker threads
+that is shared by all threads. The pool is created on first use and its
+size is defined by the Prolog flag `task_threads` or, if this is 0, the
+number of CPUs. A worker that waits for the tasks it submitted runs
+other tasks meanwhile, so these predicates may be nested. The solvers of
+first_solution/3 must run at the same time. Each of them runs in a
+_solver_ worker of its own. Solver workers are created as needed and
+reused by later calls. Tasks that are no longer needed are cancelled by
+making them raise the exception '$task_cancelled'. As the workers are
+not terminated after a task, thread_local/1 clauses and global variables
+created by a task remain visible to later tasks that run on the same
+worker.
+
 @author Jan Wielemaker
 */
 
@@ -285,24 +307,23 @@ join_all([Id|T]) :-
 %!  concurrent_maplist(:Goal, +List1, +List2) is semidet.
 %!  concurrent_maplist(:Goal, +List1, +List2, +List3) is semidet.
 %
-%   Concurrent version of maplist/2. This   predicate uses concurrent/3,
-%   using multiple _worker_ threads.  The  number   of  threads  is  the
-%   minimum of the list length and the   number  of cores available. The
-%   number of cores is determined using  the prolog flag =cpu_count=. If
-%   this flag is absent or 1 or List   has  less than two elements, this
-%   predicate calls the corresponding maplist/N  version using a wrapper
-%   based on once/1. Note that all goals   are executed as if wrapped in
-%   once/1 and therefore these predicates are _semidet_.
+%   Concurrent version of maplist/2. This predicate  runs the calls for
+%   each element as tasks on the task   scheduler  (see the introduction
+%   of this section). If the Prolog flag =cpu_count= is absent or 1 or
+%   List has less than  two  elements,   this  predicate  calls  the
+%   corresponding maplist/N version using a wrapper based on once/1.
+%   Note that all goals are executed as  if wrapped in once/1 and
+%   therefore these predicates are _semidet_.
 %
-%   Note that the the overhead  of   this  predicate is considerable and
-%   therefore Goal must  be  fairly  expensive   before  one  reaches  a
-%   speedup.
+%   Each call is copied to a worker and the instantiated call is copied
+%   back. Goal must be more expensive than  these copies before one
+%   reaches a speedup.
 
 concurrent_maplist(Goal, List) :-
-    workers(List, WorkerCount),
+    workers(List, _),
     !,
     maplist(ml_goal(Goal), List, Goals),
-    concurrent(WorkerCount, Goals, []).
+    '$run_tasks'(Goals, all).
 concurrent_maplist(M:Goal, List) :-
     maplist(once_in_module(M, Goal), List).
 
@@ -313,10 +334,10 @@ ml_goal(Goal, Elem, call(Goal, Elem)).
 
 concurrent_maplist(Goal, List1, List2) :-
     same_length(List1, List2),
-    workers(List1, WorkerCount),
+    workers(List1, _),
     !,
     maplist(ml_goal(Goal), List1, List2, Goals),
-    concurrent(WorkerCount, Goals, []).
+    '$run_tasks'(Goals, all).
 concurrent_maplist(M:Goal, List1, List2) :-
     maplist(once_in_module(M, Goal), List1, List2).
 
@@ -327,10 +348,10 @@ ml_goal(Goal, Elem1, Elem2, call(Goal, Elem1, Elem2)).
 
 concurrent_maplist(Goal, List1, List2, List3) :-
     same_length(List1, List2, List3),
-    workers(List1, WorkerCount),
+    workers(List1, _),
     !,
     maplist(ml_goal(Goal), List1, List2, List3, Goals),
-    concurrent(WorkerCount, Goals, []).
+    '$run_tasks'(Goals, all).
 concurrent_maplist(M:Goal, List1, List2, List3) :-
     maplist(once_in_module(M, Goal), List1, List2, List3).
 
@@ -352,6 +373,43 @@ same_length([_|T1], [_|T2], [_|T3]) :-
     same_length(T1, T2, T3).
 
 
+                 /*******************************
+                 *             FORALL           *
+                 *******************************/
+
+%!  concurrent_forall(:Cond, :Action) is semidet.
+%!  concurrent_forall(:Cond, :Action, +Options) is semidet.
+%
+%   Concurrent version of forall/2. The  instances   of  Action  for all
+%   solutions of Cond are  run  as  tasks   on  the  task  scheduler.
+%   Succeeds if Action succeeds for all  solutions. As soon as one of
+%   the tasks fails or raises an exception, the remaining tasks are
+%   cancelled and concurrent_forall/3 fails or re-throws the exception.
+%   All solutions of Cond are computed before the first task is started.
+%   Options:
+%
+%     - threads(+Count)
+%       If 1, run forall/2 in the calling thread.  Otherwise the tasks
+%       use the workers of the scheduler, whose number is defined by
+%       the Prolog flag `task_threads`.
+%
+%   As concurrent_maplist/2, concurrent_forall/3 calls forall/2 if the
+%   Prolog flag =cpu_count= is absent or 1.
+
+concurrent_forall(Cond, Action) :-
+    concurrent_forall(Cond, Action, []).
+
+concurrent_forall(Cond, Action, Options) :-
+    \+ option(threads(1), Options),
+    current_prolog_flag(cpu_count, Cores),
+    Cores > 1,
+    !,
+    findall(Action, Cond, Goals),
+    '$run_tasks'(Goals, forall).
+concurrent_forall(Cond, Action, _) :-
+    forall(Cond, Action).
+
+
                  /*******************************
                  *             FIRST            *
                  *******************************/
@@ -375,6 +433,10 @@ same_length([_|T1], [_|T2], [_|T3]) :-
 %                           []).
 %   ==
 %
+%   The solvers run as tasks on the task scheduler, each in a worker
+%   of its own, such that all of them run at the same time. If thread
+%   stack-sizes are given, a thread is created for each solver.
+%
 %   Options include thread stack-sizes passed   to thread_create, as
 %   well as the options =on_fail= and   =on_error= that specify what
 %   to do if a  solver  fails  or   triggers  an  error.  By default
@@ -394,6 +456,13 @@ same_length([_|T1], [_|T2], [_|T3]) :-
 %           solutions are needed wrap the solvers in findall/3.
 
 
+first_solution(X, M:List, Options) :-
+    thread_options(Options, [], RestOptions),
+    !,
+    option(on_fail(OnFail), RestOptions, stop),
+    option(on_error(OnError), RestOptions, stop),
+    maplist(solver_task(X, M), List, Tasks),
+    '$run_tasks'(Tasks, first(OnFail, OnError)).
 first_solution(X, M:List, Options) :-
     message_queue_create(Done),
     thread_options(Options, ThreadOptions, RestOptions),
@@ -407,6 +476,11 @@ first_solution(X, M:List, Options) :-
     ->  throw(Error)
     ).
 
+%   Copy the solver such that it only shares X with the caller.
+
+solver_task(X, M, Goal, M:Task) :-
+    copy_term(X-Goal, X-Task).
+
 create_solvers([], _, _, _, [], _).
 create_solvers([H|T], M, X, Done, [Id|IDs], Options) :-
     thread_create(solve(M:H, X, Done), Id, Options),
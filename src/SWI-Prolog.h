@@ -313,6 +313,7 @@ typedef struct PL_extension
 #define PL_FA_CREF		(0x10)	/* Internal: has clause-reference */
 #define PL_FA_ISO		(0x20)	/* Internal: ISO core predicate */
 #define PL_FA_META		(0x40)	/* Additional meta-argument spec */
+#define PL_FA_LEAF		(0x80)	/* deterministic, no callbacks */
 
 extern			PL_extension PL_extensions[]; /* not Win32! */
 PL_EXPORT(void)		PL_register_extensions(const PL_extension *e);
@@ -771,6 +772,12 @@ PL_EXPORT(int)		PL_same_compound(term_t t1, term_t t2);
 PL_EXPORT(int)		PL_warning(const char *fmt, ...);
 PL_EXPORT(void)		PL_fatal_error(const char *fmt, ...);
 
+		 /*******************************
+		 *	  CLAUSE DATABASE	*
+		 *******************************/
+
+PL_EXPORT(int)		PL_assertz_terms(term_t source, module_t m);
+
 		 /*******************************
 		 *      RECORDED DATABASE	*
 		 *******************************/
@@ -1098,6 +1105,7 @@ PL_EXPORT(intptr_t)	PL_query(int);	/* get information from Prolog */
 
 #define PL_THREAD_NO_DEBUG	0x01	/* Start thread in nodebug mode */
 #define PL_THREAD_NOT_DETACHED	0x02	/* Allow Prolog to join */
+#define PL_THREAD_POOLED	0x04	/* Recycle engine through the pool */
 
 typedef enum
 { PL_THREAD_CANCEL_FAILED = FALSE,	/* failed to cancel; try abort */
@@ -1165,6 +1173,34 @@ PL_EXPORT(void*)	PL_prof_call(void *handle, PL_prof_type_t *type);
 PL_EXPORT(void)		PL_prof_exit(void *node);
 
 
+		 /*******************************
+		 *	  PAUSE STATISTICS	*
+		 *******************************/
+
+#define PL_PAUSE_GC_USER	    0	/* garbage_collect/0 */
+#define PL_PAUSE_GC_EXCEPTION	    1	/* GC before handling an exception */
+#define PL_PAUSE_GC_GLOBAL_OVERFLOW 2	/* GC for global stack overflow */
+#define PL_PAUSE_GC_TRAIL_OVERFLOW  3	/* GC for trail stack overflow */
+#define PL_PAUSE_GC_GLOBAL_REQUEST  4	/* GC requested by global stack */
+#define PL_PAUSE_GC_TRAIL_REQUEST   5	/* GC requested by trail stack */
+#define PL_PAUSE_AGC		    6	/* atom garbage collection */
+#define PL_PAUSE_CGC		    7	/* clause garbage collection */
+#define PL_PAUSE_SHIFT		    8	/* stack shift (resize) */
+#define PL_PAUSE_KINDS		    9
+
+#define PL_PAUSE_BUCKETS	  128	/* 4 buckets per power of 2 */
+
+typedef struct
+{ int64_t	count;			/* # pauses */
+  int64_t	total;			/* summed pause time (usec) */
+  int64_t	max;			/* longest pause (usec) */
+  int64_t	buckets[PL_PAUSE_BUCKETS]; /* # pauses per bucket */
+} pl_pause_histogram_t;
+
+PL_EXPORT(int)		PL_pause_histogram(int kind, pl_pause_histogram_t *h);
+PL_EXPORT(int64_t)	PL_pause_bucket_limit(int bucket);
+
+
 		 /*******************************
 		 *	 WINDOWS MESSAGES	*
 		 *******************************/
@@ -49,7 +49,8 @@ test_arith :-
 		    float_overflow,
 		    float_zero,
 		    float_special,
-		    arith_misc
+		    arith_misc,
+		    compiled
 		  ]).
 
 :- begin_tests(div).
@@ -456,3 +457,56 @@ test(string) :-
 	0'a =:= "a".
 
 :- end_tests(arith_misc).
+
+:- begin_tests(compiled).
+
+% Clauses in this unit are compiled with optimise=true to exercise the
+% type-specialised arithmetic and compare-and-branch instructions.  The
+% flag is file-scoped and thus restored after loading this file.
+
+:- set_prolog_flag(optimise, true).
+
+c_sub(X, Y, Z)  :- Z is X-Y.
+c_mul(X, Y, Z)  :- Z is X*Y.
+c_fadd(X, Z)    :- Z is X+0.5.
+c_fdiv(X, Y, Z) :- Z is float(X)/Y.
+c_lt(X, Y)      :- X < Y.
+c_ge(X)         :- X >= 10.
+
+test(sub, Z == -9223372036854775809) :-
+	c_sub(-9223372036854775808, 1, Z).
+test(sub, Z == 2.5) :-
+	c_sub(3, 0.5, Z).
+test(mul, Z == 18446744073709551616) :-
+	c_mul(4294967296, 4294967296, Z).
+test(mul, Z == -6) :-
+	c_mul(-3, 2, Z).
+test(fadd, Z == 2.5) :-
+	c_fadd(2, Z).
+test(fadd, error(evaluation_error(float_overflow))) :-
+	c_fadd(1<<10000, _).
+test(fdiv, Z == 0.5) :-
+	c_fdiv(1, 2, Z).
+test(fdiv, error(evaluation_error(zero_divisor))) :-
+	c_fdiv(1, 0.0, _).
+test(lt) :-
+	c_lt(1, 2),
+	c_lt(1.5, 2),
+	c_lt(1, 1.5),
+	c_lt(1+1, 3),
+	\+ c_lt(2, 1).
+test(lt, error(instantiation_error)) :-
+	c_lt(_, 1).
+test(ge) :-
+	c_ge(10),
+	c_ge(10.0),
+	c_ge(1<<100),
+	\+ c_ge(9.5).
+test(nan) :-				% must agree with A_LT ... A_NE
+	X is nan,
+	c_ge(X),
+	\+ c_lt(X, 1),
+	\+ c_lt(X, 1.0),
+	\+ c_lt(1.0, X).
+
+:- end_tests(compiled).
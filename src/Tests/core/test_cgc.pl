@@ -97,11 +97,48 @@ lshift(S0) :-
 lshift(_).
 
 
+%!	blocked_cgc(-Status)
+%
+%	Run clause GC while a blocked thread holds a choicepoint on a
+%	retracted clause.  Only the first CGC scans the stack of the
+%	blocked thread; later ones use the cached marks.
+
+:- dynamic hold/1.
+
+blocked_cgc(Status) :-
+	retractall(hold(_)),
+	assertz(hold(1)),
+	assertz(hold(2)),
+	thread_self(Me),
+	thread_create(hold_clause(Me), Id, []),
+	thread_get_message(holding),
+	retract(hold(2)),
+	forall(between(1, 5, _),
+	       ( forall(between(1, 1000, X),
+			( assertz(hold(x(X))),
+			  retract(hold(x(X))) )),
+		 garbage_collect_clauses
+	       )),
+	thread_send_message(Id, go),
+	thread_join(Id, Status).
+
+hold_clause(Main) :-
+	hold(X),
+	(   X == 1
+	->  thread_send_message(Main, holding),
+	    thread_get_message(go),
+	    fail
+	;   true
+	),
+	X == 2, !.
+
 :- begin_tests(cgc, [ sto(rational_trees),
 		      condition(current_prolog_flag(threads, true))
 		    ]).
 
 test(shift_cgc) :-
 	shift_cgc(4, 4).
+test(blocked, Status == true) :-
+	blocked_cgc(Status).
 
 :- end_tests(cgc).
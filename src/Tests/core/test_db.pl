@@ -76,6 +76,30 @@ test(cut_cond, Body = (! -> fail)) :-
 	assert(f :- (! -> fail)),
 	clause(f, Body),
 	retractall(f).
+test(all_list, [L == [1,2,3], cleanup(retractall(f(_)))]) :-
+	assertz(f(1)),
+	assertz_all([f(2), (f(X) :- X = 3)]),
+	findall(X, f(X), L).
+test(all_stream, [L == [a-1,b-2], cleanup(retractall(f(_,_)))]) :-
+	setup_call_cleanup(
+	    open_string("f(a,1).\nf(b,2).\n", In),
+	    assertz_all(In),
+	    close(In)),
+	findall(X-Y, f(X,Y), L).
+test(all_atomic, [ error(permission_error(modify, static_procedure, _)),
+		   cleanup(retractall(f(_)))
+		 ]) :-
+	assertz_all([f(1), atom(a)]),
+	f(_).
+test(all_no_dynamic, \+ predicate_property(all_undef(_), dynamic)) :-
+	catch(assertz_all([all_undef(1), atom(a)]), _, true).
+test(all_index, [L == [b], cleanup(retractall(f(_,_)))]) :-
+	forall(between(1, 20, X), assertz(f(X, a))),
+	f(10, _),
+	numlist(21, 100, Keys),
+	findall(f(X, b), member(X, Keys), Clauses),
+	assertz_all(Clauses),
+	findall(Y, f(50, Y), L).
 
 :- end_tests(assert).
 
@@ -47,6 +47,9 @@ test_gc :-
 		    gc_crash,
 		    gc_crash2,
 		    gc_mark,
+		    gc_generational,
+		    gc_parallel,
+		    gc_pauses,
 		    agc
 		  ]).
 
@@ -251,6 +254,147 @@ a(Y) :- length(Y,_).
 
 :- end_tests(gc_mark).
 
+:- begin_tests(gc_generational,
+	       [ setup(set_prolog_flag(gc_generational, true)),
+		 cleanup(set_prolog_flag(gc_generational, false))
+	       ]).
+
+%	Create old data with unbound variables and bind these in young
+%	data while a choicepoint is active.  The old cells must act as
+%	roots for the young collections.
+
+mk(N, L) :-
+	findall(v(I,_), between(1, N, I), L).
+
+bind_all([], _).
+bind_all([v(I,X)|T], K) :-
+	X = g(I,K,[I,K]),
+	bind_all(T, K).
+
+check_bound([], _).
+check_bound([v(I,X)|T], K) :-
+	X == g(I,K,[I,K]),
+	check_bound(T, K).
+
+set_all([], _).
+set_all([T|Ts], R) :-
+	arg(1, T, I),
+	setarg(2, T, s(I,R,[R])),
+	set_all(Ts, R).
+
+check_set([], _).
+check_set([v(I,s(I,R,[R]))|Ts], R) :-
+	check_set(Ts, R).
+
+churn(0) :- !.
+churn(N) :-
+	length(L, 100),
+	maplist(=(x(N)), L),
+	N1 is N-1,
+	churn(N1).
+
+test(bind_old, true) :-
+	mk(20000, L),
+	churn(2000),
+	(   member(K, [a,b,c]),
+	    bind_all(L, K),
+	    churn(2000),
+	    check_bound(L, K),
+	    K == c
+	->  true
+	),
+	check_bound(L, c).
+test(setarg_old, true) :-
+	mk(5000, L),
+	churn(2000),
+	(   between(1, 3, R),
+	    set_all(L, R),
+	    churn(2000),
+	    check_set(L, R),
+	    R == 3
+	->  true
+	),
+	check_set(L, 3).
+test(young, Status == true) :-
+	thread_create(young_gc, Id, []),
+	thread_join(Id, Status).
+
+test(backtrack_old, true) :-
+	statistics(globalused, G0),
+	\+ ( young_list, fail ),
+	statistics(globalused, G1),
+	G1 - G0 < 100000.
+
+young_gc :-
+	young_list,
+	statistics(young_collections, Y),
+	Y > 0.
+
+%	Promote a large list to the old generation.  Backtracking must
+%	reclaim it.
+
+young_list :-
+	numlist(1, 100000, L),
+	churn(5000),
+	sum_list(L, S),
+	S =:= 5000050000.
+
+:- end_tests(gc_generational).
+
+:- begin_tests(gc_parallel,
+	       [ condition(current_prolog_flag(threads, true)),
+		 setup(set_prolog_flag(gc_mark_threads, 2)),
+		 cleanup(set_prolog_flag(gc_mark_threads, 0))
+	       ]).
+
+%	Mark more than PARALLEL_MARK_MIN (1Mb) of data such that the
+%	marking is shared with the helper threads.
+
+tree(0, leaf) :- !.
+tree(N, node(L,N,R)) :-
+	N1 is N-1,
+	tree(N1, L),
+	tree(N1, R).
+
+mk_data(N, L) :-
+	findall(f(I,g(I,[I,I]),"str",1.5,B), (between(1, N, I), B is I<<70), L).
+
+test(mark, true) :-
+	tree(15, T),
+	mk_data(20000, L),
+	freeze(X, true),
+	garbage_collect,
+	tree(15, T2),
+	T == T2,
+	mk_data(20000, L2),
+	L == L2,
+	attvar(X).
+test(choicepoints, true) :-
+	mk_data(20000, L),
+	(   member(K, [a,b]),
+	    length(L2, 100000),
+	    maplist(=(K), L2),
+	    garbage_collect,
+	    K == b
+	->  true
+	),
+	length(L, 20000).
+
+:- end_tests(gc_parallel).
+
+:- begin_tests(gc_pauses).
+
+test(user, true) :-
+	garbage_collect,
+	statistics(gc_pauses, Pauses),
+	memberchk(pause(user, Count, Total, Max, Buckets), Pauses),
+	Count >= 1,
+	Total >= Max,
+	pairs_values(Buckets, Counts),
+	sum_list(Counts, Count).
+
+:- end_tests(gc_pauses).
+
 
 :- begin_tests(agc).
 
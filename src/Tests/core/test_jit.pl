@@ -38,9 +38,11 @@
 	  ]).
 :- use_module(library(plunit)).
 :- use_module(library(debug)).
+:- use_module(library(prolog_jiti)).
 
 test_jit :-
-	run_tests([ jit
+	run_tests([ jit,
+		    switch
 		  ]).
 
 /** <module> Test unit for Just-In-Time indexing
@@ -126,6 +128,80 @@ test(midint, [cleanup(retractall(d(_,_)))]) :-
 test(float, [cleanup(retractall(d(_,_)))]) :-
 	test_index_2(mkfloat).
 
+test(eager, [cleanup(retractall(d(_,_)))]) :-
+	forall(between(1,100,X), assertz(d(X,X))),
+	'$jiti_create_index'(d(_,_), single(2), 0),
+	assertion(has_hashes(d(_,_), [2])).
+test(eager, [cleanup(retractall(d(_,_))), fail]) :-
+	forall(between(1,100,X), assertz(d(X,a))),
+	'$jiti_create_index'(d(_,_), single(2), 0).
+test(manifest, [ setup(tmp_file_stream(text, File, Out)),
+		 cleanup((retractall(d(_,_)), delete_file(File)))
+	       ]) :-
+	close(Out),
+	forall(between(1,100,X), assertz(d(X,X))),
+	d(_,30),
+	jiti_save_manifest(File),
+	retractall(d(_,_)),
+	forall(between(1,200,X), assertz(d(X,X))),
+	assertion(not_hashed(d(_,_))),
+	jiti_load_manifest(File, [threads(1)]),
+	assertion(has_hashes(d(_,_), [2])).
+test(dict_key, [cleanup(retractall(d(_,_))), V == 50]) :-
+	forall(between(1,100,X),
+	       (   atom_concat(k, X, K),
+		   (   X mod 2 =:= 0
+		   ->  assertz(d(_{name:K, v:X}, X))
+		   ;   assertz(d(_{name:K, w:X, z:1}, X))
+		   )
+	       )),
+	d(_{name:k50, v:V}, _),
+	predicate_property(d(_,_), indexed(Indexed)),
+	assertion(memberchk(dict_key(1,name)-_, Indexed)).
+test(list_head, [cleanup(retractall(d(_,_))), T == [50]]) :-
+	forall(between(1,100,X),
+	       (   atom_concat(k, X, K),
+		   assertz(d([K,X], X))
+	       )),
+	d([k50|T], _),
+	predicate_property(d(_,_), indexed(Indexed)),
+	assertion(memberchk(deep([1,single(1)])-_, Indexed)),
+	predicate_property(d(_,_), list_indexed(Lists)),
+	assertion(memberchk([1,single(1)], Lists)).
+test(range, [cleanup(retractall(d(_,_))), Ys == [new,4,5,6,7,8,9,10,a,b]]) :-
+	forall(between(1,10,X), (Y is X*10, assertz(d(Y,X)))),
+	assertz(d(abc,a)), assertz(d(b,b)), assertz(d(35.0,new)),
+	retract(d(30,_)),
+	findall(Y, jiti_range(d(_,Y), 1, 31, c), Ys).
+test(range, [cleanup(retractall(d(_,_))), Ys == [1,2]]) :-
+	forall(between(1,10,X), assertz(d(X,X))),
+	findall(Y, jiti_range(d(_,Y), 1, _, 2), Ys).
+test(range, [cleanup(retractall(d(_,_))), Ys == [a,nil]]) :-
+	assertz(d([],nil)), assertz(d(a,a)), assertz(d(1,one)),
+	findall(Y, jiti_range(d(_,Y), 1, a, []), Ys).
+test(range, [cleanup(retractall(d(_,_))), Ys == [c]]) :-
+	assertz(d(1,a)), assertz(d(2,b)),
+	findall(Y, jiti_range(d(_,Y), 1, _, _), _),
+	retract(d(2,b)), assertz(d(3,c)),	% same clause count
+	findall(Y, jiti_range(d(_,Y), 1, 3, 3), Ys).
+test(range, [cleanup(retractall(d(_,_))), Ys == [n,a,b]]) :-
+	NaN is nan,
+	assertz(d(2.0,b)), assertz(d(NaN,n)), assertz(d(1.0,a)),
+	findall(Y, jiti_range(d(_,Y), 1, _, _), Ys).
+test(range_incremental, [cleanup(retractall(d(_,_))), Ys == Expected]) :-
+	jiti_range_index(d(_,_), 1),
+	forall(between(1, 100, X),
+	       ( Y is X*2, assertz(d(Y,Y)),
+		 Y2 is 1000-Y, asserta(d(Y2,Y2)),
+		 ignore(jiti_range(d(_,_), 1, 0, 0)) )),
+	retract(d(196,_)),
+	findall(Y, jiti_range(d(_,Y), 1, 190, 810), Ys),
+	findall(Y, ( between(190, 810, Y), Y mod 2 =:= 0,
+		     (Y =< 200 ; Y >= 800), Y =\= 196 ), Expected).
+test(range, [cleanup(retractall(d(_,_))), error(type_error(atomic,f(x)))]) :-
+	assertz(d(1,1)),
+	jiti_range(d(_,_), 1, f(x), _).
+
 rmd(X,Y) :-
 	retract(d(X, Y)),
 	(   Y == 89
@@ -187,3 +263,45 @@ test(depth_exceeded, nondet) :-
 	p2(a(b(c(d(e(f(g(h(2))))))))).
 
 :- end_tests(jit).
+
+:- begin_tests(switch).
+
+sw(red,   1).
+sw(green, 2).
+sw(42,    int).
+sw(3.5,   float).
+sw(f(_),  functor).
+sw("str", string).
+sw(99999999999999999999, big).
+
+test(hit, X == [1,2,int,float,functor,string,big]) :-
+	maplist(sw, [red,green,42,3.5,f(a),"str",99999999999999999999], X).
+test(miss, fail) :-
+	member(K, [blue,7,2.5,g(x),"other"]),
+	sw(K, _).
+test(enum, L =@= [red,green,42,3.5,f(_),"str",99999999999999999999]) :-
+	findall(K, sw(K,_), L).
+test(det) :-
+	sw(42, X),
+	X == int.
+test(case_keys) :-
+	sw(red, _),
+	case_keys(sw(_,_), 0, Keys),
+	memberchk(s_case(red), Keys),
+	memberchk(s_case(42), Keys),
+	memberchk(s_fcase(f/1), Keys),
+	memberchk(s_hcase(_), Keys).
+
+case_keys(Head, PC, Keys) :-
+	'$fetch_vm'(Head, PC, PC1, VMI),
+	!,
+	(   VMI =.. [Op,Key,_],
+	    memberchk(Op, [s_case,s_fcase,s_hcase])
+	->  Case =.. [Op,Key],
+	    Keys = [Case|T]
+	;   Keys = T
+	),
+	case_keys(Head, PC1, T).
+case_keys(_, _, []).
+
+:- end_tests(switch).
@@ -43,7 +43,11 @@ Tests that are hard to classify
 */
 
 test_misc :-
-	run_tests([ misc
+	run_tests([ misc,
+		    optimise_inline,
+		    leaf,
+		    qlf_load_threads,
+		    qlf_lazy_load
 		  ]).
 
 :- begin_tests(misc).
@@ -67,3 +71,127 @@ test(cut_to_cleanup) :-
 	retract(cl).
 
 :- end_tests(misc).
+
+:- begin_tests(optimise_inline,
+	       [ cleanup(set_prolog_flag(optimise_inline, false))
+	       ]).
+
+inline_file(File, Incr) :-
+	setup_call_cleanup(
+	    open(File, write, Out),
+	    format(Out, ':- module(inline_test, [inl/2]).~n\c
+			 inl(X, Y) :- inl_add(X, Y).~n\c
+			 inl_add(X, Y) :- Y is X+~w.~n', [Incr]),
+	    close(Out)),
+	setup_call_cleanup(
+	    set_prolog_flag(optimise_inline, true),
+	    load_files(File, [if(true), silent(true)]),
+	    set_prolog_flag(optimise_inline, false)).
+
+inline_vmi(VMI) :-
+	clause(inline_test:inl(_,_), _, Ref),
+	inline_vmi(Ref, 0, VMI).
+
+inline_vmi(Ref, PC, VMI) :-
+	'$fetch_vm'(Ref, PC, NPC, VMI0),
+	(   VMI0 = VMI
+	->  true
+	;   inline_vmi(Ref, NPC, VMI)
+	).
+
+test(inline, [ setup(tmp_file(inline, File)),
+	       cleanup(delete_file(File)),
+	       Inlined-Body-Y1-Y2 == true-inl_add(A,B)-2-12
+	     ]) :-
+	inline_file(File, 1),
+	(inline_vmi(i_inline(_,_,_)) -> Inlined = true ; Inlined = false),
+	clause(inline_test:inl(A,B), Body),
+	inline_test:inl(1, Y1),
+	inline_file(File, 11),
+	inline_test:inl(1, Y2).
+
+:- end_tests(optimise_inline).
+
+:- begin_tests(leaf).
+
+leaf_succ(X, Y) :-
+	succ(X, Y).
+
+test(error, error(type_error(integer, a), context(system:succ/2, _))) :-
+	leaf_succ(a, _).
+test(fail, fail) :-
+	leaf_succ(_, 0).
+test(wakeup, Woken == 2) :-
+	freeze(X, Woken = X),
+	leaf_succ(1, X).
+
+:- end_tests(leaf).
+
+:- begin_tests(qlf_load_threads,
+	       [ cleanup(set_prolog_flag(qlf_load_threads, 0))
+	       ]).
+
+qlf_file(Base, QlfFile) :-
+	file_name_extension(Base, pl, File),
+	setup_call_cleanup(
+	    open(File, write, Out),
+	    ( format(Out, ':- module(qlf_par_test, [qf/2]).~n', []),
+	      forall(between(1, 2000, I),
+		     format(Out, 'qf(~q, f(~q, ~q, ~q)).~n',
+			    [I, a-I, "s", I/2])),
+	      format(Out, ':- qf(1000, _), assertz(seen).~n', []),
+	      format(Out, 'qf(last, [x]).~n', [])
+	    ),
+	    close(Out)),
+	qcompile(File),
+	delete_file(File),
+	file_name_extension(Base, qlf, QlfFile).
+
+test(load, [ setup(tmp_file(qlf, Base)),
+	     cleanup(delete_file(QlfFile)),
+	     Count-Last-Seen == 2001-[x]-true
+	   ]) :-
+	qlf_file(Base, QlfFile),
+	set_prolog_flag(qlf_load_threads, 2),
+	load_files(QlfFile, [if(true), silent(true)]),
+	aggregate_all(count, qlf_par_test:qf(_,_), Count),
+	qlf_par_test:qf(1500, f(a-1500, "s", 1500/2)),
+	qlf_par_test:qf(last, Last),
+	(qlf_par_test:seen -> Seen = true ; Seen = false).
+
+:- end_tests(qlf_load_threads).
+
+:- begin_tests(qlf_lazy_load,
+	       [ cleanup('$cmd_option_set'(lazy_load, false))
+	       ]).
+
+lazy_qlf_file(Base, QlfFile) :-
+	file_name_extension(Base, pl, File),
+	setup_call_cleanup(
+	    open(File, write, Out),
+	    ( format(Out, ':- module(qlf_lazy_test, [lf/2]).~n', []),
+	      forall(between(1, 100, I),
+		     format(Out, 'lf(~q, f(~q, "s")).~n', [I, a-I])),
+	      format(Out, ':- lf(50, _), assertz(seen).~n', []),
+	      format(Out, 'lf(last, [x]).~n', [])
+	    ),
+	    close(Out)),
+	qcompile(File),
+	delete_file(File),
+	file_name_extension(Base, qlf, QlfFile).
+
+test(load, [ setup(tmp_file(qlf, Base)),
+	     cleanup(delete_file(QlfFile)),
+	     Count-Last-Seen-Reload == 101-[x]-true-101
+	   ]) :-
+	lazy_qlf_file(Base, QlfFile),
+	'$cmd_option_set'(lazy_load, true),
+	load_files(QlfFile, [if(true), silent(true)]),
+	(qlf_lazy_test:seen -> Seen = true ; Seen = false),
+	aggregate_all(count, qlf_lazy_test:lf(_,_), Count),
+	qlf_lazy_test:lf(60, f(a-60, "s")),
+	qlf_lazy_test:lf(last, Last),
+	load_files(QlfFile, [if(true), silent(true)]),
+	aggregate_all(count, qlf_lazy_test:lf(_,_), Reload).
+
+:- end_tests(qlf_lazy_load).
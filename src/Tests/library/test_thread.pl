@@ -36,7 +36,7 @@
 :- module(test_thread, [test_thread/0]).
 
 test_thread :-
-	run_tests(thread).
+	run_tests([thread, tasks]).
 
 :- use_module(library(plunit)).
 :- use_module(library(thread)).
@@ -68,3 +68,58 @@ test(first, true(X==1)) :-
 	first_solution(X, [(repeat,fail), X=1], []).
 
 :- end_tests(thread).
+
+% Make sure concurrent_maplist/2 and friends use the task scheduler, also
+% on single-core hardware.
+
+:- dynamic
+	saved_cpu_count/1.
+
+force_tasks :-
+	current_prolog_flag(cpu_count, N),
+	asserta(saved_cpu_count(N)),
+	set_prolog_flag(cpu_count, 2).
+
+restore_cpu_count :-
+	retract(saved_cpu_count(N)), !,
+	set_prolog_flag(cpu_count, N).
+
+:- begin_tests(tasks, [ condition(current_prolog_flag(threads,true)),
+			setup(force_tasks),
+			cleanup(restore_cpu_count)
+		      ]).
+
+test(maplist, L2 == [2,3,4,5]) :-
+	concurrent_maplist(succ, [1,2,3,4], L2).
+test(maplist, fail) :-
+	concurrent_maplist([X]>>(X < 3), [1,2,3,4]).
+test(maplist, error(type_error(integer, a))) :-
+	concurrent_maplist(succ, [1,a,3], _).
+test(nested, true) :-
+	numlist(1, 20, L),
+	concurrent_maplist(nested_maplist, L).
+test(forall, true) :-
+	concurrent_forall(between(1, 100, X), X > 0).
+test(forall, fail) :-
+	concurrent_forall(between(1, 100, X), X < 50).
+test(first, X == 1) :-
+	first_solution(X, [(repeat,fail), X=1], []).
+test(nested_first, L == [1,1]) :-
+	concurrent_maplist(first_in_task, [a,b], L).
+test(first_continue, X == 2) :-
+	first_solution(X, [fail, X=2], [on_fail(continue)]).
+
+nested_maplist(N) :-
+	numlist(1, N, L),
+	concurrent_maplist(succ, L, L2),
+	sum_list(L, S),
+	sum_list(L2, S2),
+	S2 =:= S+N.
+
+first_in_task(_, X) :-
+	first_solution(X, [X=1, loop], []).
+
+loop :-
+	loop.
+
+:- end_tests(tasks).
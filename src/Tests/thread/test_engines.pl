@@ -67,6 +67,36 @@ test(gc4, [sto(rational_trees)]) :-
 		     assertion(V == 1),
 		     engine_destroy(E)
 		   ), 100).
+test(pool, L == [1,2,3]) :-
+	engine_create(X, member(X, [1,2,3]), E, [pool(true)]),
+	get_answers(E, L),
+	engine_destroy(E).
+test(pool_clean, V-Flag == none-false) :-
+	engine_create(x, ( nb_setval(pool_test, 1),
+			   set_prolog_flag(occurs_check, true)
+			 ), E1, [pool(true)]),
+	engine_next(E1, x),
+	engine_destroy(E1),
+	engine_create(V-Flag,
+		      ( catch(nb_getval(pool_test, V), _, V = none),
+			current_prolog_flag(occurs_check, Flag)
+		      ), E2, [pool(true)]),
+	engine_next(E2, V-Flag),
+	engine_destroy(E2).
+test(pool_stack_limit, TheLimit =:= 1_000_000) :-
+	engine_create(x, (numlist(1, 100000, L), length(L, _)), E1,
+		      [pool(true)]),
+	engine_next(E1, x),
+	engine_destroy(E1),
+	engine_create(Limit, current_prolog_flag(stack_limit, Limit), E2,
+		      [ stack_limit(1_000_000), pool(true) ]),
+	engine_next(E2, TheLimit),
+	engine_destroy(E2).
+test(pool_gc, [sto(rational_trees)]) :-
+	gc_engines(( engine_create(X, between(1,2,X), E, [pool(true)]),
+		     engine_next(E, V),
+		     assertion(V == 1)
+		   ), 100).
 
 :- end_tests(engines).
 
@@ -263,4 +263,90 @@ test(size_prop, true) :-
 	P = size(2), !,
 	message_queue_destroy(Queue).
 
+test(indexed_get, [X,Y,W] == [2,1,4]) :-
+	message_queue_create(Queue, []),
+	forall(member(M, [a(1),b(2),_,a(4)]),
+	       thread_send_message(Queue, M)),
+	thread_get_message(Queue, b(X)),
+	thread_get_message(Queue, a(Y)),
+	thread_get_message(Queue, a(Z)),
+	thread_get_message(Queue, a(W)),
+	var(Z),
+	message_queue_property(Queue, size(0)),
+	message_queue_destroy(Queue).
+
+test(selective_wait, X == 2) :-
+	message_queue_create(Queue, []),
+	thread_self(Me),
+	thread_create(( thread_get_message(Queue, b(B)),
+			thread_send_message(Me, got(B))
+		      ), Id, []),
+	thread_send_message(Queue, a(1)),
+	thread_send_message(Queue, b(2)),
+	thread_get_message(got(X)),
+	thread_join(Id, true),
+	thread_get_message(Queue, a(1)),
+	message_queue_destroy(Queue).
+
+test(batch, [B1,B2,B3] == [[1,2,3],[4,5],[]]) :-
+	message_queue_create(Queue, [max_size(2)]),
+	thread_create(thread_send_messages(Queue, [1,2,3,4,5]), Id, []),
+	collect_messages(Queue, 3, B1),
+	collect_messages(Queue, 2, B2),
+	thread_join(Id, true),
+	(   thread_get_messages(Queue, 10, B3, [timeout(0)])
+	->  true
+	;   B3 = []
+	),
+	message_queue_destroy(Queue).
+
+collect_messages(_, 0, []) :- !.
+collect_messages(Queue, N, Msgs) :-
+	thread_get_messages(Queue, N, Batch),
+	length(Batch, Len),
+	N1 is N - Len,
+	collect_messages(Queue, N1, Rest),
+	append(Batch, Rest, Msgs).
+
+test(timeout_wakeup, Count == 100) :-
+	message_queue_create(Queue),
+	message_queue_create(Out),
+	length(Forwarders, 2),
+	maplist(create_forwarder(Queue, Out), Forwarders),
+	forall(between(1, 100, I),
+	       ( thread_create(timeout_reader(Queue, Out), Id, []),
+		 thread_send_message(Queue, I),
+		 thread_join(Id, true)
+	       )),
+	count_messages(Out, 100, 0, Count),
+	forall(member(_, Forwarders), thread_send_message(Queue, done)),
+	maplist(thread_join, Forwarders),
+	message_queue_destroy(Queue),
+	message_queue_destroy(Out).
+
+create_forwarder(Queue, Out, Id) :-
+	thread_create(forward_messages(Queue, Out), Id, []).
+
+forward_messages(Queue, Out) :-
+	thread_get_message(Queue, Msg),
+	(   Msg == done
+	->  true
+	;   thread_send_message(Out, Msg),
+	    forward_messages(Queue, Out)
+	).
+
+timeout_reader(Queue, Out) :-
+	(   thread_get_message(Queue, Msg, [timeout(0.001)])
+	->  thread_send_message(Out, Msg)
+	;   true
+	).
+
+count_messages(_, Max, Max, Max) :- !.
+count_messages(Out, Max, Count0, Count) :-
+	(   thread_get_message(Out, _, [timeout(2)])
+	->  Count1 is Count0+1,
+	    count_messages(Out, Max, Count1, Count)
+	;   Count = Count0
+	).
+
 :- end_tests(message_queue).
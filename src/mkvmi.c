@@ -53,6 +53,14 @@
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 This program creates pl-codetable.c, pl-jumptable.ic   and pl-vmi.h from
 pl-vmi.c.
+
+It also creates pl-superjumptable.ic and  pl-supervmi.ic that define the
+superinstructions for the instruction  sequences   listed  in  SUPERVMI.
+Each superinstruction is a copy of the bodies of the instructions in the
+sequence, where NEXT_INSTRUCTION of all  but   the  last  instruction is
+replaced by a jump to the next body. Before executing the next body, the
+generated code verifies that the opcode is  the expected one and falls
+back to normal dispatching otherwise. See pl-comp.c.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 const char *program;
@@ -61,18 +69,33 @@ const char *vmi_file    = "pl-vmi.c";
 const char *ctable_file = "pl-codetable.ic";
 const char *jump_table  = "pl-jumptable.ic";
 const char *vmi_hdr	= "pl-vmi.h";
+const char *super_file  = "SUPERVMI";
+const char *super_table = "pl-superjumptable.ic";
+const char *super_code  = "pl-supervmi.ic";
 
 #define MAX_VMI 1000
+#define MAX_SUPER 100
+#define MAX_SUPER_VMI 4			/* must match pl-incl.h */
 
 typedef struct				/* VMI( */
 { char *name;				/* Name */
   char *flags;				/* Flags (VIF_*) */
   char *argc;				/* Argument length (or VM_DYNARGC) */
   char *args;				/* Argument types (max 3) */
+  int   line;				/* Line of the body */
+  char *body;				/* Body text */
 } vmi;					/* ) */
 
+typedef struct
+{ int	length;				/* # instructions */
+  int	vmi[MAX_SUPER_VMI];		/* index into vmi_list */
+} super;
+
 vmi vmi_list[MAX_VMI];
 int vmi_count = 0;
+super super_list[MAX_SUPER];
+int super_count = 0;
+char vmi_path[MAXPATHLEN];
 
 char *synopsis;
 size_t syn_size = 0;
@@ -127,6 +150,24 @@ skip_id(const char *s)
 }
 
 
+static char *
+skip_id_lower(const char *s)
+{ if ( s )
+  { for (; *s; s++)
+    { if ( *s == '_' ||
+	   (*s >= 'a' && *s <= 'z') ||
+	   (*s >= 'A' && *s <= 'Z') ||
+	   (*s >= '0' && *s <= '9') )
+	continue;
+
+      return (char*)s;
+    }
+  }
+
+  return NULL;
+}
+
+
 static char *
 skip_flags(const char *s)
 { if ( s )
@@ -169,6 +210,56 @@ my_strndup(const char *in, size_t len)
 }
 
 
+/* count_braces() updates the brace depth for a line of C code, skipping
+   comments and literals.  Returns TRUE if the line contains a brace.
+*/
+
+static int
+count_braces(const char *s, int *depth, int *in_comment)
+{ int found = 0;
+
+  for(; *s; s++)
+  { if ( *in_comment )
+    { if ( s[0] == '*' && s[1] == '/' )
+      { *in_comment = 0;
+	s++;
+      }
+    } else if ( s[0] == '/' && s[1] == '*' )
+    { *in_comment = 1;
+      s++;
+    } else if ( s[0] == '/' && s[1] == '/' )
+    { break;
+    } else if ( *s == '"' || *s == '\'' )
+    { int q = *s;
+
+      for(s++; *s && *s != q; s++)
+      { if ( *s == '\\' && s[1] )
+	  s++;
+      }
+      if ( !*s )
+	break;
+    } else if ( *s == '{' )
+    { (*depth)++;
+      found = 1;
+    } else if ( *s == '}' )
+    { (*depth)--;
+      found = 1;
+    }
+  }
+
+  return found;
+}
+
+
+static void
+add_body(vmi *v, const char *line)
+{ size_t len = v->body ? strlen(v->body) : 0;
+
+  v->body = realloc(v->body, len+strlen(line)+1);
+  strcpy(&v->body[len], line);
+}
+
+
 static int
 load_vmis(const char *file)
 { FILE *fd = fopen(file, "r");
@@ -176,10 +267,19 @@ load_vmis(const char *file)
   if ( fd )
   { char buf[1024];
     int line = 0;
+    vmi *in_body = NULL;
+    int depth = 0, in_comment = 0;
 
     while(fgets(buf, sizeof(buf), fd))
     { line++;
 
+      if ( in_body )
+      { add_body(in_body, buf);
+	if ( count_braces(buf, &depth, &in_comment) && depth == 0 )
+	  in_body = NULL;
+	continue;
+      }
+
       if ( strncmp(buf, "VMI(", 4) == 0 )
       { const char *s1 = skip_ws(buf+4);
 	const char *e1 = skip_id(s1);
@@ -205,6 +305,10 @@ load_vmis(const char *file)
 	add_synopsis(s3, e3-s3);
 	add_synopsis(s4, e4-s4);
 
+	vmi_list[vmi_count].line  = line+1;
+	vmi_list[vmi_count].body  = NULL;
+	in_body = &vmi_list[vmi_count];
+
 	vmi_count++;
       }
     }
@@ -217,6 +321,111 @@ load_vmis(const char *file)
 }
 
 
+static int
+find_vmi(const char *name, size_t len)
+{ int i;
+
+  for(i=0; i<vmi_count; i++)
+  { if ( strlen(vmi_list[i].name) == len &&
+	 strncmp(vmi_list[i].name, name, len) == 0 )
+      return i;
+  }
+
+  return -1;
+}
+
+
+/* has_label() is true if the body defines a label.  Such bodies cannot
+   be copied into a superinstruction.
+*/
+
+static int
+has_label(const char *body)
+{ const char *s = body;
+
+  while(s && *s)
+  { const char *e;
+
+    s = skip_ws(s);
+    e = skip_ws(skip_id_lower(s));
+    if ( e && e > s && *e == ':' && e[1] != ':' &&
+	 strncmp(s, "default", 7) != 0 )
+      return 1;
+    s = skip_over(s, '\n');
+  }
+
+  return 0;
+}
+
+
+static int
+load_supers(const char *file)
+{ FILE *fd = fopen(file, "r");
+  char buf[1024];
+  int line = 0;
+  int errors = 0;
+
+  if ( !fd )
+    return 0;				/* no superinstructions */
+
+  while(fgets(buf, sizeof(buf), fd))
+  { super *sp = &super_list[super_count];
+    char *s;
+
+    line++;
+    if ( (s=strchr(buf, '#')) )
+      *s = '\0';
+
+    sp->length = 0;
+    for(s=skip_ws(buf); s && *s && *s != '\n'; s=skip_ws(s))
+    { char *e = skip_id(s);
+      int i;
+
+      if ( e == s || (i=find_vmi(s, e-s)) < 0 )
+      { fprintf(stderr, "%s:%d: unknown VMI: %s", file, line, s);
+	errors++;
+	break;
+      }
+      if ( sp->length == MAX_SUPER_VMI )
+      { fprintf(stderr, "%s:%d: sequence too long\n", file, line);
+	errors++;
+	break;
+      }
+      if ( has_label(vmi_list[i].body) )
+      { fprintf(stderr, "%s:%d: %s defines a label\n",
+		file, line, vmi_list[i].name);
+	errors++;
+      }
+      sp->vmi[sp->length++] = i;
+      s = e;
+    }
+
+    if ( sp->length == 1 )
+    { fprintf(stderr, "%s:%d: need at least two VMIs\n", file, line);
+      errors++;
+    } else if ( sp->length > 1 )
+    { int i;
+
+      for(i=0; i<sp->length-1; i++)
+      { if ( !strstr(vmi_list[sp->vmi[i]].body, "NEXT_INSTRUCTION") )
+	{ fprintf(stderr, "%s:%d: %s never continues with the next VMI\n",
+		  file, line, vmi_list[sp->vmi[i]].name);
+	  errors++;
+	}
+      }
+      if ( ++super_count == MAX_SUPER )
+      { fprintf(stderr, "%s:%d: too many superinstructions\n", file, line);
+	errors++;
+	break;
+      }
+    }
+  }
+
+  fclose(fd);
+  return errors ? -1 : 0;
+}
+
+
 static int
 cmp_file(const char *from, const char *to)
 { FILE *f1 = fopen(from, "r");
@@ -304,6 +513,19 @@ emit_code_table(const char *to)
   }
 
   fprintf(out, "  { NULL, 0, 0, 0, {0} }\n");
+  fprintf(out, "};\n\n");
+
+  fprintf(out, "const vmi_super superTable[] = {\n");
+  fprintf(out, "  /* {#codes, {codes}} */\n");
+  for(i=0; i<super_count; i++)
+  { int j;
+
+    fprintf(out, "  {%d, {", super_list[i].length);
+    for(j=0; j<super_list[i].length; j++)
+      fprintf(out, "%s%s", j ? ", " : "", vmi_list[super_list[i].vmi[j]].name);
+    fprintf(out, "}},\n");
+  }
+  fprintf(out, "  { 0, {0} }\n");
   fprintf(out, "};\n");
   fclose(out);
 
@@ -342,6 +564,96 @@ emit_jump_table(const char *to)
 }
 
 
+static int
+emit_super_table(const char *to)
+{ const char *tmp = "vmi.tmp";
+  FILE *out = fopen(tmp, "w");
+  int i;
+
+  fprintf(out, "/*  File: %s\n\n", to);
+  fprintf(out, "    This file provides the GCC-2 jump-labels of the superinstructions.\n");
+  fprintf(out, "\n");
+  fprintf(out, "    Note: this file is generated by %s from %s.  DO NOT EDIT", program, super_file);
+  fprintf(out, "    \n");
+  fprintf(out, "*/\n\n");
+
+  fprintf(out, "static void *super_jmp_table[] =\n");
+  fprintf(out, "{\n");
+
+  for(i=0; i<super_count; i++)
+  { fprintf(out, "  &&SUPER_%d_LBL,\n", i);
+  }
+
+  fprintf(out, "  NULL\n");
+  fprintf(out, "};\n");
+
+  fclose(out);
+
+  return update_file(tmp, to);
+}
+
+
+static void
+emit_next_instruction(FILE *out, const char *how)
+{ fprintf(out, "#undef NEXT_INSTRUCTION\n");
+  fprintf(out, "#define NEXT_INSTRUCTION %s\n", how);
+}
+
+
+static int
+emit_super_code(const char *to)
+{ const char *tmp = "vmi.tmp";
+  FILE *out = fopen(tmp, "w");
+  int i;
+
+  fprintf(out, "/*  File: %s\n\n", to);
+  fprintf(out, "    This file provides the superinstructions.  It is included by\n");
+  fprintf(out, "    pl-wam.c after pl-vmi.c.\n");
+  fprintf(out, "\n");
+  fprintf(out, "    Note: this file is generated by %s from %s and %s.  DO NOT EDIT",
+	  program, super_file, vmi_file);
+  fprintf(out, "    \n");
+  fprintf(out, "*/\n\n");
+
+  for(i=0; i<super_count; i++)
+  { super *sp = &super_list[i];
+    int j;
+
+    fprintf(out, "/* SUPER_%d:", i);
+    for(j=0; j<sp->length; j++)
+      fprintf(out, " %s", vmi_list[sp->vmi[j]].name);
+    fprintf(out, " */\n\n");
+
+    fprintf(out, "#pragma push_macro(\"NEXT_INSTRUCTION\")\n");
+    for(j=0; j<sp->length; j++)
+    { vmi *v = &vmi_list[sp->vmi[j]];
+      char next[100];
+
+      if ( j == 0 )
+      { fprintf(out, "SVMI(SUPER_%d, %s)\n", i, v->name);
+      } else
+      { fprintf(out, "#pragma pop_macro(\"NEXT_INSTRUCTION\")\n");
+	fprintf(out, "#pragma push_macro(\"NEXT_INSTRUCTION\")\n");
+	fprintf(out, "SVMI_STEP(SUPER_%d_%d, %s)\n", i, j, v->name);
+      }
+      if ( j+1 < sp->length )
+      { snprintf(next, sizeof(next), "SVMI_NEXT(SUPER_%d_%d)", i, j+1);
+	emit_next_instruction(out, next);
+      } else
+      { fprintf(out, "#pragma pop_macro(\"NEXT_INSTRUCTION\")\n");
+      }
+      fprintf(out, "#line %d \"%s\"\n", v->line, vmi_path);
+      fputs(v->body, out);
+    }
+    fprintf(out, "\n");
+  }
+
+  fclose(out);
+
+  return update_file(tmp, to);
+}
+
+
 static int
 emit_code_defs(const char *to)
 {  const char *tmp = "vmi.tmp";
@@ -388,17 +700,28 @@ main(int argc, char **argv)
   }
 
   if ( argc == 1 )
-    snprintf(buf, sizeof(buf), "%s/%s", argv[0], vmi_file);
+    snprintf(vmi_path, sizeof(vmi_path), "%s/%s", argv[0], vmi_file);
   else
-    snprintf(buf, sizeof(buf), "%s", vmi_file);
+    snprintf(vmi_path, sizeof(vmi_path), "%s", vmi_file);
 
 
-  load_vmis(buf);
+  load_vmis(vmi_path);
   if ( verbose )
     fprintf(stderr, "Found %d VMs\n", vmi_count);
 
+  if ( argc == 1 )
+    snprintf(buf, sizeof(buf), "%s/%s", argv[0], super_file);
+  else
+    snprintf(buf, sizeof(buf), "%s", super_file);
+  if ( load_supers(buf) < 0 )
+    return 1;
+  if ( verbose )
+    fprintf(stderr, "Found %d superinstructions\n", super_count);
+
   if ( emit_code_table(ctable_file) == 0 &&
        emit_jump_table(jump_table) == 0 &&
+       emit_super_table(super_table) == 0 &&
+       emit_super_code(super_code) == 0 &&
        emit_code_defs(vmi_hdr) == 0 )
     return 0;
   else
@@ -732,6 +732,8 @@ set_prolog_flag_unlocked(term_t key, term_t value, int flags)
 	}
       } else if ( k == ATOM_debugger_show_context )
       { debugstatus.showContext = val;
+      } else if ( k == ATOM_gc_generational )
+      { setGCPolicy(val ? GC_GENERATIONAL_POLICY : GC_FAST_POLICY PASS_LD);
 #ifdef O_PLMT
       } else if ( k == ATOM_threads )
       { if ( val )
@@ -824,6 +826,23 @@ set_prolog_flag_unlocked(term_t key, term_t value, int flags)
       if ( k == ATOM_agc_margin )
 	GD->atoms.margin = (size_t)i;
       else
+#endif
+#ifdef O_PLMT
+      if ( k == ATOM_jiti_background_threshold )
+	GD->thread.index.bg_threshold = i;
+      else
+      if ( k == ATOM_gc_mark_threads )
+	GD->thread.mark.threads = (i > 0 ? (int)i : 0);
+      else
+      if ( k == ATOM_qlf_load_threads )
+	GD->thread.qlf.threads = (i > 0 ? (int)i : 0);
+      else
+      if ( k == ATOM_task_threads )
+	GD->thread.tasks.threads = (i > 0 ? (int)i : 0);
+      else
+      if ( k == ATOM_engine_pool_size )
+	GD->thread.engines.max = (i > 0 ? (int)i : 0);
+      else
 #endif
       if ( k == ATOM_table_space )
 	LD->tabling.node_pool.limit = (size_t)i;
@@ -1316,6 +1335,7 @@ initPrologFlags(void)
   setPrologFlag("pid", FT_INTEGER|FF_READONLY, getpid());
 #endif
   setPrologFlag("optimise", FT_BOOL, GD->cmdline.optimise, PLFLAG_OPTIMISE);
+  setPrologFlag("optimise_inline", FT_BOOL, FALSE, PLFLAG_OPTIMISE_INLINE);
   setPrologFlag("optimise_debug", FT_ATOM, "default", 0);
   setPrologFlag("generate_debug_info", FT_BOOL,
 		truePrologFlag(PLFLAG_DEBUGINFO), PLFLAG_DEBUGINFO);
@@ -1339,6 +1359,7 @@ initPrologFlags(void)
   setPrologFlag("unload_foreign_libraries", FT_BOOL, FALSE, 0);
   setPrologFlag("gc",	  FT_BOOL,	       TRUE,  PLFLAG_GC);
   setPrologFlag("trace_gc",  FT_BOOL,	       FALSE, PLFLAG_TRACE_GC);
+  setPrologFlag("gc_generational", FT_BOOL,    FALSE, PLFLAG_GC_GENERATIONAL);
 #ifdef O_ATOMGC
   setPrologFlag("agc_margin",FT_INTEGER,	       GD->atoms.margin);
 #endif
@@ -1359,6 +1380,16 @@ initPrologFlags(void)
   setPrologFlag("gc_thread",    FT_BOOL,
 		!GD->options.nothreads &&
 		truePrologFlag(PLFLAG_GCTHREAD), PLFLAG_GCTHREAD);
+  setPrologFlag("jiti_background_threshold", FT_INTEGER,
+		(intptr_t)GD->thread.index.bg_threshold);
+  setPrologFlag("gc_mark_threads", FT_INTEGER,
+		(intptr_t)GD->thread.mark.threads);
+  setPrologFlag("qlf_load_threads", FT_INTEGER,
+		(intptr_t)GD->thread.qlf.threads);
+  setPrologFlag("task_threads", FT_INTEGER,
+		(intptr_t)GD->thread.tasks.threads);
+  setPrologFlag("engine_pool_size", FT_INTEGER,
+		(intptr_t)GD->thread.engines.max);
 #else
   setPrologFlag("threads",	FT_BOOL|FF_READONLY, FALSE, 0);
   setPrologFlag("gc_thread",    FT_BOOL|FF_READONLY, FALSE, PLFLAG_GCTHREAD);
@@ -107,7 +107,6 @@ problem.
 #endif
 #endif
 
-static int		ar_minus(Number n1, Number n2, Number r);
 static int		mul64(int64_t x, int64_t y, int64_t *r);
 static int		notLessThanZero(const char *f, int a, Number n);
 static int		mustBePositive(const char *f, int a, Number n);
@@ -231,7 +230,7 @@ PRED_IMPL("between", 3, between, PL_FA_NONDETERMINISTIC)
 }
 
 static
-PRED_IMPL("succ", 2, succ, 0)
+PRED_IMPL("succ", 2, succ, PL_FA_LEAF)
 { GET_LD
   Word p1, p2;
   number i1, i2, one;
@@ -301,7 +300,7 @@ var_or_integer(term_t t, number *n, int which, int *mask ARG_LD)
 
 
 static
-PRED_IMPL("plus", 3, plus, 0)
+PRED_IMPL("plus", 3, plus, PL_FA_LEAF)
 { GET_LD
   number m, n, o;
   int mask = 0;
@@ -466,6 +465,26 @@ ar_compare(Number n1, Number n2, int what)
 }
 
 
+/* arithCompareFunctor() maps a comparison code as used by ar_compare() to
+   the functor of the corresponding predicate.
+*/
+
+functor_t
+arithCompareFunctor(int what)
+{ switch(what)
+  { case LT: return FUNCTOR_smaller2;
+    case GT: return FUNCTOR_larger2;
+    case LE: return FUNCTOR_smaller_equal2;
+    case GE: return FUNCTOR_larger_equal2;
+    case NE: return FUNCTOR_ar_not_equal2;
+    case EQ: return FUNCTOR_ar_equals2;
+    default:
+      assert(0);
+      return 0;
+  }
+}
+
+
 static word
 compareNumbers(term_t n1, term_t n2, int what ARG_LD)
 { AR_CTX
@@ -1222,7 +1241,7 @@ pl_ar_add(Number n1, Number n2, Number r)
 }
 
 
-static int
+int
 ar_minus(Number n1, Number n2, Number r)
 { if ( !same_type_numbers(n1, n2) )
     return FALSE;
@@ -2340,7 +2359,7 @@ ar_rdiv(Number n1, Number n2, Number r)
 #endif /*O_GMP*/
 
 
-static int
+int
 ar_divide(Number n1, Number n2, Number r)
 { GET_LD
 
@@ -3924,8 +3943,8 @@ BeginPredDefs(arith)
   PRED_DEF("=:=",  2, eq,  PL_FA_ISO)
   PRED_DEF("current_arithmetic_function", 1, current_arithmetic_function,
 	   PL_FA_NONDETERMINISTIC)
-  PRED_DEF("succ", 2, succ, 0)
-  PRED_DEF("plus", 3, plus, 0)
+  PRED_DEF("succ", 2, succ, PL_FA_LEAF)
+  PRED_DEF("plus", 3, plus, PL_FA_LEAF)
   PRED_DEF("between", 3, between, PL_FA_NONDETERMINISTIC)
 #ifdef O_GMP
   PRED_DEF("divmod", 4, divmod, 0)
@@ -1011,7 +1011,7 @@ pl_garbage_collect_atoms(void)
 { GET_LD
   int64_t oldcollected;
   int verbose = truePrologFlag(PLFLAG_TRACE_GC) && !LD->in_print_message;
-  double t;
+  double t, wall0;
   sigset_t set;
   size_t reclaimed;
   int rc = TRUE;
@@ -1034,6 +1034,7 @@ pl_garbage_collect_atoms(void)
   PL_LOCK(L_REHASH_ATOMS);
   blockSignals(&set);
   t = CpuTime(CPU_USER);
+  wall0 = WallTime();
   unmarkAtoms();
   markAtomsOnStacks(LD);
 #ifdef O_PLMT
@@ -1047,6 +1048,7 @@ pl_garbage_collect_atoms(void)
   t = CpuTime(CPU_USER) - t;
   GD->atoms.gc_time += t;
   GD->atoms.gc++;
+  record_pause(PL_PAUSE_AGC, WallTime()-wall0 PASS_LD);
   unblockSignals(&set);
   PL_UNLOCK(L_REHASH_ATOMS);
 
@@ -59,6 +59,7 @@
 #define valHandleP(h)		valTermRef(h)
 
 static void	initVMIMerge(void);
+static void	initSuperInstructions(void);
 
 static void
 checkCodeTable(void)
@@ -139,6 +140,16 @@ initWamTable(void)
     if ( wam_table[n] < mincoded )
       mincoded = wam_table[n];
   }
+#if O_SUPERVMI
+  for(n = 0; superTable[n].length; n++)
+  { code c = (code)interpreter_super_jmp_table[n];
+
+    if ( c > maxcoded )
+      maxcoded = c;
+    if ( c < mincoded )
+      mincoded = c;
+  }
+#endif
   dewam_table_offset = mincoded;
 
   assert(wam_table[C_NOT] != wam_table[C_IFTHENELSE]);
@@ -147,10 +158,16 @@ initWamTable(void)
 
   for(n = 0; n < I_HIGHEST; n++)
     dewam_table[wam_table[n]-dewam_table_offset] = (unsigned char) n;
+#if O_SUPERVMI				/* a superinstruction is its 1st VMI */
+  for(n = 0; superTable[n].length; n++)
+    dewam_table[(code)interpreter_super_jmp_table[n]-dewam_table_offset] =
+      (unsigned char) superTable[n].codes[0];
+#endif
 
   checkCodeTable();
   initSupervisors();
   initVMIMerge();
+  initSuperInstructions();
 }
 
 #else /* VMCODE_IS_ADDRESS */
@@ -160,6 +177,7 @@ initWamTable()
 { checkCodeTable();
   initSupervisors();
   initVMIMerge();
+  initSuperInstructions();
 }
 
 #endif /* VMCODE_IS_ADDRESS */
@@ -323,6 +341,8 @@ typedef struct
 typedef struct merge_state
 { const vmi_merge *candidates;		/* Merge candidates */
   size_t	merge_pos;		/* The merge candidate location */
+  const vmi_merge *previous;		/* Candidates of the one before */
+  size_t	previous_pos;		/* Location of the one before */
 } merge_state;
 
 typedef enum target_module_type
@@ -1110,7 +1130,8 @@ forwards int	compileListFF(word arg, compileInfo *ci ARG_LD);
 forwards bool	compileSimpleAddition(Word, compileInfo * ARG_LD);
 #if O_COMPILE_ARITH
 forwards int	compileArith(Word, compileInfo * ARG_LD);
-forwards bool	compileArithArgument(Word, compileInfo * ARG_LD);
+forwards bool	compileArithCompare(Word, int, compileInfo * ARG_LD);
+forwards bool	compileArithArgument(Word, int *, compileInfo * ARG_LD);
 #endif
 #if O_COMPILE_IS
 forwards int	compileBodyUnify(Word arg, compileInfo *ci ARG_LD);
@@ -1124,6 +1145,7 @@ forwards int	compileBodyTypeTest(functor_t functor, Word arg,
 forwards int	compileBodyCallContinuation(Word arg, compileInfo *ci ARG_LD);
 forwards int	compileBodyShift(Word arg, compileInfo *ci ARG_LD);
 
+static int	compileInline(Word body, code call, compileInfo *ci ARG_LD);
 static void	initMerge(CompileInfo ci);
 static int	mergeInstructions(CompileInfo ci, const vmi_merge *m, vmi c);
 static int	try_fast_condition(CompileInfo ci, size_t tc_or);
@@ -1417,8 +1439,8 @@ These  functions  provide  a  small    state-machine   that  merges  new
 instructions with the previous one. The  declarations of which sequences
 to merge are defined in initVMIMerge().
 
-TBD: After reduction, we should try reducing   with the previous one, as
-in: X, Y, Z --> X, YZ --> XYZ.
+After reduction, we try reducing the result   with the instruction before
+the one we merged with, as in: X, Y, Z --> X, YZ --> XYZ.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 static vmi_merge *merge_def[I_HIGHEST];
@@ -1496,6 +1518,7 @@ initVMIMerge(void)
 static void
 initMerge(CompileInfo ci)
 { ci->mstate.candidates = NULL;
+  ci->mstate.previous = NULL;
 }
 
 
@@ -1512,6 +1535,16 @@ mergeInstructions(CompileInfo ci, const vmi_merge *m, vmi c)
 			 codeTable[c].name));
 	  seekBuffer(&ci->codes, ci->mstate.merge_pos, code);
 	  ci->mstate.candidates = NULL;
+	  if ( ci->mstate.previous )	/* X, YZ --> XYZ */
+	  { const vmi_merge *prev = ci->mstate.previous;
+	    size_t pos = ci->mstate.merge_pos;
+
+	    ci->mstate.previous = NULL;
+	    ci->mstate.merge_pos = ci->mstate.previous_pos;
+	    if ( mergeInstructions(ci, prev, m->merge_op) )
+	      return TRUE;
+	    ci->mstate.merge_pos = pos;
+	  }
 	  Output_n(ci, m->merge_op, m->merge_av, m->merge_ac);
 	  return TRUE;
 	}
@@ -1535,15 +1568,18 @@ mergeInstructions(CompileInfo ci, const vmi_merge *m, vmi c)
 static void				/* inline is slower! */
 Output_0(CompileInfo ci, vmi c)
 { const vmi_merge *m;
+  const vmi_merge *prev;
 
-  if ( (m=ci->mstate.candidates) )
-  { if ( mergeInstructions(ci, m, c) )
+  if ( (prev=ci->mstate.candidates) )
+  { if ( mergeInstructions(ci, prev, c) )
       return;
     ci->mstate.candidates = NULL;
   }
 
   if ( (m = merge_def[c]) )
-  { ci->mstate.candidates = m;
+  { ci->mstate.previous = prev;
+    ci->mstate.previous_pos = ci->mstate.merge_pos;
+    ci->mstate.candidates = m;
     ci->mstate.merge_pos = PC(ci);
   }
 
@@ -1551,6 +1587,98 @@ Output_0(CompileInfo ci, vmi c)
 }
 
 
+		 /*******************************
+		 *	SUPERINSTRUCTIONS	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+A superinstruction executes  a  sequence  of   instructions  listed  in
+SUPERVMI without dispatching between them.  mkvmi.c generates its code
+by copying the bodies of the instructions,   where the NEXT_INSTRUCTION
+of all but the last instruction continues  with the next body if the
+next opcode is the expected one and dispatches normally otherwise.
+
+A superinstruction thus behaves exactly as  the first instruction of the
+sequence and decode() maps it  to  this   instruction.  Only  the first
+opcode is replaced; the remainder of  the   sequence  is left intact. This
+makes superinstructions invisible to the  decompiler, clause walkers, the
+breakpoint code and saved states.
+
+superInstructions() is called on the  code   of  a  new clause. It scans
+from left to right, trying the longest sequences first. An instruction
+inside a sequence does not start a new  sequence because its opcode must
+remain the plain one.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#if O_SUPERVMI
+static int *super_def[I_HIGHEST];	/* VMI -> -1 terminated superTable[] */
+
+static void
+initSuperInstructions(void)
+{ int len, n;
+
+  for(len = MAX_SUPER_VMI; len > 1; len--)
+  { for(n = 0; superTable[n].length; n++)
+    { if ( superTable[n].length == len )
+      { vmi c = superTable[n].codes[0];
+	int count = 0;
+
+	if ( super_def[c] )
+	{ while(super_def[c][count] >= 0)
+	    count++;
+	}
+	super_def[c] = realloc(super_def[c], sizeof(int)*(count+2));
+	super_def[c][count] = n;
+	super_def[c][count+1] = -1;
+      }
+    }
+  }
+}
+
+void
+superInstructions(Code PC, size_t size)
+{ Code end = PC+size;
+
+  while( PC < end )
+  { Code next = stepPC(PC);
+    const int *s;
+
+    if ( (s=super_def[fetchop(PC)]) )
+    { for(; *s >= 0; s++)
+      { const vmi_super *si = &superTable[*s];
+	Code pc = next;
+	int i;
+
+	for(i=1; i<si->length && pc < end && fetchop(pc) == si->codes[i]; i++)
+	  pc = stepPC(pc);
+
+	if ( i == si->length )
+	{ *PC = (code)interpreter_super_jmp_table[*s];
+	  next = pc;
+	  break;
+	}
+      }
+    }
+
+    PC = next;
+  }
+}
+
+#else /*O_SUPERVMI*/
+
+static void
+initSuperInstructions(void)
+{
+}
+
+void
+superInstructions(Code PC, size_t size)
+{
+}
+
+#endif /*O_SUPERVMI*/
+
+
 		 /*******************************
 		 *	CODE GENERATION		*
 		 *******************************/
@@ -1735,6 +1863,7 @@ that have an I_CONTEXT because we need to reset the context.
 Finish up the clause.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
   clause.code_size = entriesBuffer(&ci.codes, code);
+  superInstructions(baseBuffer(&ci.codes, code), clause.code_size);
 
   if ( head )
   { size_t size  = sizeofClause(clause.code_size);
@@ -1896,6 +2025,9 @@ right_argument:
   { functor_t fd = functorTerm(*body);
     FunctorDef fdef = valueFunctor(fd);
 
+    if ( fd == FUNCTOR_dinline3 && !ci->islocal )
+      return compileInline(body, call, ci PASS_LD);
+
     if ( true(fdef, CONTROL_F) )
     { if ( fd == FUNCTOR_comma2 )			/* A , B */
       { int rv;
@@ -2086,6 +2218,88 @@ right_argument:
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+compileInline() compiles '$inline'(Goal, Body, Stamp) as created by
+inlineClauseBody().  Goal is a call to a  predicate  of  the  current
+module and Body is the clause of this predicate, unified  against  the
+arguments of Goal.  Stamp  is  the  last_modified  generation  of  the
+callee when Body was created.  The code is
+
+	I_INLINE <proc> <stamp> <jmp1>
+	<Goal>
+	C_VAR*
+	C_JMP <jmp2>
+    jmp1:
+	<Body>
+	C_VAR*
+    jmp2:
+
+As with ;/2, both paths initialise the same set of variables.  Compiler
+warnings are not raised for Body as the user cannot relate these to the
+source.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+compileInline(Word body, code call, compileInfo *ci ARG_LD)
+{ Word g = argTermP(*body, 0);
+  Word e = argTermP(*body, 1);
+  Word s = argTermP(*body, 2);
+  functor_t functor;
+  Procedure proc;
+  VarTable vsave, valtg, valte;
+  size_t tc_inline, tc_jmp;
+  term_t warnings;
+  int rv;
+
+  deRef(g);
+  deRef(s);
+  if ( isTerm(*g) )
+    functor = functorTerm(*g);
+  else if ( isTextAtom(*g) )
+    functor = lookupFunctorDef(*g, 0);
+  else
+    functor = 0;
+
+  if ( !functor || !isInteger(*s) ||
+       ci->colon_context.type != TM_NONE
+#ifdef O_CALL_AT_MODULE
+       || ci->at_context.type != TM_NONE
+#endif
+     )
+    return compileBody(g, call, ci PASS_LD);
+
+  proc  = lookupBodyProcedure(functor, ci->module);
+  vsave = mkCopiedVarTable(ci->used_var);
+  valtg = mkCopiedVarTable(ci->used_var);
+  valte = mkCopiedVarTable(ci->used_var);
+  setVars(g, valtg PASS_LD);
+  setVars(e, valte PASS_LD);
+
+  Output_3(ci, I_INLINE, (code)proc, (code)valInteger(*s), (code)0);
+  tc_inline = PC(ci);
+  if ( (rv=compileBody(g, call, ci PASS_LD)) != TRUE )
+    return rv;
+  balanceVars(valtg, valte, ci);
+  Output_1(ci, C_JMP, (code)0);
+  tc_jmp = PC(ci);
+  OpCode(ci, tc_inline-1) = (code)(PC(ci) - tc_inline);
+  copyVarTable(ci->used_var, vsave);
+  warnings = ci->warning_list;
+  ci->warning_list = 0;
+  rv = compileBody(e, call, ci PASS_LD);
+  ci->warning_list = warnings;
+  if ( rv != TRUE )
+    return rv;
+  balanceVars(valte, valtg, ci);
+  OpCode(ci, tc_jmp-1) = (code)(PC(ci) - tc_jmp);
+
+  orVars(valtg, valte);
+  copyVarTable(ci->used_var, valtg);
+
+  return TRUE;
+}
+
+
 static int
 try_fast_condition(CompileInfo ci, size_t tc_or)
 { Code pc  = &OpCode(ci, tc_or);
@@ -2121,7 +2335,14 @@ try_fast_condition(CompileInfo ci, size_t tc_or)
       case A_FUNC2:
       case A_FUNC:
       case A_ADD:
+      case A_SUB:
       case A_MUL:
+      case A_FADD:
+      case A_FSUB:
+      case A_FMUL:
+      case A_FDIV:
+      case A_CMP_VV:
+      case A_CMP_VC:
       case A_LT:
       case A_LE:
       case A_GT:
@@ -2837,14 +3058,15 @@ Returns one of TRUE or *_OVERFLOW
 static int
 compileArith(Word arg, compileInfo *ci ARG_LD)
 { code a_func;
+  int cmp, isfloat;
   functor_t fdef = functorTerm(*arg);
 
-  if      ( fdef == FUNCTOR_ar_equals2 )	a_func = A_EQ;	/* =:= */
-  else if ( fdef == FUNCTOR_ar_not_equal2 )	a_func = A_NE;	/* =\= */
-  else if ( fdef == FUNCTOR_smaller2 )		a_func = A_LT;	/* < */
-  else if ( fdef == FUNCTOR_larger2 )		a_func = A_GT;	/* > */
-  else if ( fdef == FUNCTOR_smaller_equal2 )	a_func = A_LE;	/* =< */
-  else if ( fdef == FUNCTOR_larger_equal2 )	a_func = A_GE;	/* >= */
+  if      ( fdef == FUNCTOR_ar_equals2 )	a_func = A_EQ, cmp = EQ; /* =:= */
+  else if ( fdef == FUNCTOR_ar_not_equal2 )	a_func = A_NE, cmp = NE; /* =\= */
+  else if ( fdef == FUNCTOR_smaller2 )		a_func = A_LT, cmp = LT; /* < */
+  else if ( fdef == FUNCTOR_larger2 )		a_func = A_GT, cmp = GT; /* > */
+  else if ( fdef == FUNCTOR_smaller_equal2 )	a_func = A_LE, cmp = LE; /* =< */
+  else if ( fdef == FUNCTOR_larger_equal2 )	a_func = A_GE, cmp = GE; /* >= */
   else if ( fdef == FUNCTOR_is2 )				/* is */
   { size_t tc_a1 = PC(ci);
     code isvar;
@@ -2859,7 +3081,7 @@ compileArith(Word arg, compileInfo *ci ARG_LD)
     } else
       isvar = 0;
     Output_0(ci, A_ENTER);
-    rc = compileArithArgument(argTermP(*arg, 1), ci PASS_LD);
+    rc = compileArithArgument(argTermP(*arg, 1), &isfloat, ci PASS_LD);
     if ( rc != TRUE )
       return rc;
     if ( isvar )
@@ -2872,9 +3094,12 @@ compileArith(Word arg, compileInfo *ci ARG_LD)
     fail;
   }
 
+  if ( compileArithCompare(arg, cmp, ci PASS_LD) )
+    return TRUE;
+
   Output_0(ci, A_ENTER);
-  if ( !compileArithArgument(argTermP(*arg, 0), ci PASS_LD) ||
-       !compileArithArgument(argTermP(*arg, 1), ci PASS_LD) )
+  if ( !compileArithArgument(argTermP(*arg, 0), &isfloat, ci PASS_LD) ||
+       !compileArithArgument(argTermP(*arg, 1), &isfloat, ci PASS_LD) )
     fail;
 
   Output_0(ci, a_func);
@@ -2883,11 +3108,78 @@ compileArith(Word arg, compileInfo *ci ARG_LD)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+compileArithCompare() compiles Var1 <cmp> Var2 and Var <cmp> SmallInt to
+the compare-and-branch instructions A_CMP_VV and   A_CMP_VC, where <cmp>
+is one of the comparison codes LT  ...   EQ.  The variables must already
+be bound: first occurrences are left to   the  general case that raises
+the appropriate exception.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static bool
+compileArithCompare(Word arg, int cmp, compileInfo *ci ARG_LD)
+{ Word a1 = argTermP(*arg, 0);
+  Word a2 = a1+1;
+  int i1, i2;
+
+  deRef(a1);
+  deRef(a2);
+
+  if ( (i1=isIndexedVarTerm(*a1 PASS_LD)) >= 0 &&
+       !isFirstVar(ci->used_var, i1) )
+  { if ( (i2=isIndexedVarTerm(*a2 PASS_LD)) >= 0 &&
+	 !isFirstVar(ci->used_var, i2) )
+    { Output_3(ci, A_CMP_VV, cmp, VAROFFSET(i1), VAROFFSET(i2));
+      succeed;
+    }
+    if ( is_portable_smallint(*a2) )
+    { Output_3(ci, A_CMP_VC, cmp, VAROFFSET(i1), valInt(*a2));
+      succeed;
+    }
+  }
+
+  fail;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+floatArithFunction() is true if the  arithmetic   function  fdef always
+returns a float.  Used  to  select  the   A_F*  instructions  for  the
+operators that have an operand of this type.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static bool
+floatArithFunction(functor_t fdef)
+{ return ( fdef == FUNCTOR_float1 ||
+	   fdef == FUNCTOR_sqrt1 ||
+	   fdef == FUNCTOR_sin1 ||
+	   fdef == FUNCTOR_cos1 ||
+	   fdef == FUNCTOR_tan1 ||
+	   fdef == FUNCTOR_asin1 ||
+	   fdef == FUNCTOR_acos1 ||
+	   fdef == FUNCTOR_atan1 ||
+	   fdef == FUNCTOR_atan2 ||
+	   fdef == FUNCTOR_atan22 ||
+	   fdef == FUNCTOR_sinh1 ||
+	   fdef == FUNCTOR_cosh1 ||
+	   fdef == FUNCTOR_tanh1 ||
+	   fdef == FUNCTOR_exp1 ||
+	   fdef == FUNCTOR_log1 ||
+	   fdef == FUNCTOR_pi0 ||
+	   fdef == FUNCTOR_e0 ||
+	   fdef == FUNCTOR_inf0 ||
+	   fdef == FUNCTOR_nan0 ||
+	   fdef == FUNCTOR_epsilon0 ||
+	   fdef == FUNCTOR_random_float0 );
+}
+
+
 static int
-compileArithArgument(Word arg, compileInfo *ci ARG_LD)
+compileArithArgument(Word arg, int *isfloat, compileInfo *ci ARG_LD)
 { int index;
 
   deRef(arg);
+  *isfloat = FALSE;
 
   if ( isInteger(*arg) )
   { if ( storage(*arg) == STG_INLINE )
@@ -2928,6 +3220,7 @@ compileArithArgument(Word arg, compileInfo *ci ARG_LD)
   { Word p = valIndirectP(*arg);
 
     Output_n(ci, A_DOUBLE, p, WORDS_PER_DOUBLE);
+    *isfloat = TRUE;
     succeed;
   }
 					/* variable */
@@ -3003,16 +3296,29 @@ compileArithArgument(Word arg, compileInfo *ci ARG_LD)
     }
 
     for(n=0; n<ar; a++, n++)
-      TRY( compileArithArgument(a, ci PASS_LD) );
+    { int aflt;
+
+      TRY( compileArithArgument(a, &aflt, ci PASS_LD) );
+      *isfloat |= aflt;
+    }
 
     if ( fdef == FUNCTOR_plus2 )
-    { Output_0(ci, A_ADD);
+    { Output_0(ci, *isfloat ? A_FADD : A_ADD);
+      succeed;
+    }
+    if ( fdef == FUNCTOR_minus2 )
+    { Output_0(ci, *isfloat ? A_FSUB : A_SUB);
       succeed;
     }
     if ( fdef == FUNCTOR_star2 )
-    { Output_0(ci, A_MUL);
+    { Output_0(ci, *isfloat ? A_FMUL : A_MUL);
+      succeed;
+    }
+    if ( fdef == FUNCTOR_divide2 && *isfloat )
+    { Output_0(ci, A_FDIV);
       succeed;
     }
+    *isfloat = floatArithFunction(fdef);
 
     switch(ar)
     { case 0:	Output_1(ci, A_FUNC0, index); break;
@@ -3823,6 +4129,199 @@ PRED_IMPL("asserta", 2, asserta2, PL_FA_TRANSPARENT)
 }
 
 
+		 /*******************************
+		 *	    BULK ASSERT		*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+assertz_terms() adds the clauses from  source   to  the end of their
+predicates. Source is either a list of  clauses   or  a stream from which
+clauses are read upto end_of_file. This is   used by assertz_all/1 and
+PL_assertz_terms() to load large amounts of facts:
+
+  - All clauses are compiled before any of them is added.  If some
+    clause cannot be compiled or refers to a static predicate, none of
+    the clauses is added.
+  - Undefined predicates are made dynamic after all clauses have been
+    compiled.
+  - Clauses are linked using assertProcedureList(), which locks each
+    predicate once for each run of clauses for the same predicate and
+    updates the clause indexes once for the run.  The clauses are linked
+    invisible.
+  - publishClauses() makes all clauses visible in a single generation.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+bulk_compile(term_t term, Module module,
+	     tmp_buffer *procs, tmp_buffer *clauses ARG_LD)
+{ Clause clause;
+  Procedure proc;
+  Definition def;
+  Module mhead;
+  term_t tmp  = PL_new_term_refs(3);
+  term_t head = tmp+1;
+  term_t body = tmp+2;
+  Word h, b;
+  functor_t fdef;
+
+  if ( !PL_strip_module_ex(term, &module, tmp) )
+    return FALSE;
+  mhead = module;
+  if ( !get_head_and_body_clause(tmp, head, body, &mhead PASS_LD) )
+    return FALSE;
+  if ( !get_head_functor(head, &fdef, 0 PASS_LD) )
+    return FALSE;
+  if ( !(proc = isCurrentProcedure(fdef, mhead)) )
+  { if ( checkModifySystemProc(fdef) )
+      proc = lookupProcedure(fdef, mhead);
+    if ( !proc )
+      return FALSE;
+  }
+
+  h = valTermRef(head);
+  b = valTermRef(body);
+  deRef(h);
+  deRef(b);
+  if ( compileClause(&clause, h, b, proc, module, 0 PASS_LD) != TRUE )
+    return FALSE;
+  def = getProcDefinition(proc);
+
+  if ( false(def, P_DYNAMIC) && isDefinedProcedure(proc) )
+  { PL_error(NULL, 0, NULL, ERR_MODIFY_STATIC_PROC, proc);
+    freeClause(clause);
+    return FALSE;
+  }
+
+  addBuffer(procs, proc, Procedure);
+  addBuffer(clauses, clause, Clause);
+  return TRUE;
+}
+
+
+static int
+bulk_compile_source(term_t source, Module module,
+		    tmp_buffer *procs, tmp_buffer *clauses ARG_LD)
+{ fid_t fid, rfid;
+  term_t t, tail;
+  int rc = TRUE;
+
+  if ( !(fid = PL_open_foreign_frame()) )
+    return FALSE;
+  t    = PL_new_term_ref();
+  tail = PL_copy_term_ref(source);
+  if ( !(rfid = PL_open_foreign_frame()) )
+  { PL_close_foreign_frame(fid);
+    return FALSE;
+  }
+
+  if ( PL_is_pair(source) || PL_get_nil(source) )
+  { while( rc && PL_get_list(tail, t, tail) )
+    { rc = bulk_compile(t, module, procs, clauses PASS_LD);
+      PL_rewind_foreign_frame(rfid);
+    }
+    if ( rc && !PL_get_nil(tail) )
+      rc = PL_type_error("list", tail);
+  } else
+  { atom_t a;
+
+    for(;;)
+    { if ( !pl_read2(source, t) )
+      { rc = FALSE;
+	break;
+      }
+      if ( PL_get_atom(t, &a) && a == ATOM_end_of_file )
+	break;
+      if ( !(rc = bulk_compile(t, module, procs, clauses PASS_LD)) )
+	break;
+      PL_rewind_foreign_frame(rfid);
+    }
+  }
+
+  PL_close_foreign_frame(rfid);
+  PL_close_foreign_frame(fid);
+  return rc;
+}
+
+
+static int
+bulk_make_dynamic(Procedure *pp, size_t count)
+{ size_t i;
+
+  for(i=0; i<count; i++)
+  { if ( i == 0 || pp[i] != pp[i-1] )
+    { Definition def = pp[i]->definition;
+
+      if ( false(def, P_DYNAMIC) && !setDynamicDefinition(def, TRUE) )
+	return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+
+int
+assertz_terms(term_t source, Module module ARG_LD)
+{ tmp_buffer procs;
+  tmp_buffer clauses;
+  Procedure *pp;
+  Clause *cp;
+  size_t i, count;
+  int rc;
+
+  initBuffer(&procs);
+  initBuffer(&clauses);
+
+  rc = bulk_compile_source(source, module, &procs, &clauses PASS_LD);
+  pp = baseBuffer(&procs, Procedure);
+  cp = baseBuffer(&clauses, Clause);
+  count = entriesBuffer(&clauses, Clause);
+
+  if ( rc )
+    rc = bulk_make_dynamic(pp, count);
+
+  if ( rc )
+  { for(i=0; i<count; )
+    { size_t end;
+
+      for(end=i+1; end < count && pp[end] == pp[i]; end++)
+	;
+      assertProcedureList(pp[i], &cp[i], end-i PASS_LD);
+      i = end;
+    }
+
+    publishClauses(pp, cp, count PASS_LD);
+  } else
+  { for(i=0; i<count; i++)
+      freeClause(cp[i]);
+  }
+
+  discardBuffer(&procs);
+  discardBuffer(&clauses);
+
+  return rc;
+}
+
+
+/** assertz_all(:Source)
+
+Add all clauses from Source to  the  end   of  their  predicates.  See
+assertz_terms().
+*/
+
+static
+PRED_IMPL("assertz_all", 1, assertz_all, PL_FA_TRANSPARENT)
+{ PRED_LD
+  Module m = NULL;
+  term_t source = PL_new_term_ref();
+
+  if ( !PL_strip_module_ex(A1, &m, source) )
+    return FALSE;
+
+  return assertz_terms(source, m PASS_LD);
+}
+
+
 /** '$record_clause'(+Term, +Owner, +Source)
     '$record_clause'(+Term, +Owner, +Source, -Ref)
 
@@ -4010,6 +4509,599 @@ PRED_IMPL("compile_predicates",  1, compile_predicates, PL_FA_TRANSPARENT)
 }
 
 
+		 /*******************************
+		 *	    RECOMPILATION	*
+		 *******************************/
+
+static int	inlineClauseBody(term_t body, Module m, Definition caller ARG_LD);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+optimisedClause() decompiles clause and compiles it again, where the flag
+optimise is set to `optimise'.  If optimise_inline is true, calls are
+inlined as described with inlineClauseBody().  Returns NULL if the new
+code is the same as the old.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static Clause
+optimisedClause(Clause clause, Procedure proc, int optimise ARG_LD)
+{ Definition def = proc->definition;
+  Clause ncl = NULL;
+  fid_t fid;
+  term_t term, head, body;
+  int rc;
+
+  if ( !(fid = PL_open_foreign_frame()) )
+    return NULL;
+  term = PL_new_term_refs(3);
+  head = term+1;
+  body = term+2;
+
+  acquire_def(def);
+  rc = ( decompile(clause, term, 0) &&
+	 PL_get_arg(1, term, head) &&
+	 PL_get_arg(2, term, body) );
+  release_def(def);
+
+  if ( rc )
+  { int was_optimised = truePrologFlag(PLFLAG_OPTIMISE);
+    Word h, b;
+
+    if ( truePrologFlag(PLFLAG_OPTIMISE_INLINE) )
+      inlineClauseBody(body, def->module, def PASS_LD);
+
+    h = valTermRef(head);
+    b = valTermRef(body);
+    deRef(h);
+    deRef(b);
+    if ( optimise )
+      setPrologFlagMask(PLFLAG_OPTIMISE);
+    else
+      clearPrologFlagMask(PLFLAG_OPTIMISE);
+    rc = compileClause(&ncl, h, b, proc, def->module, 0 PASS_LD);
+    if ( was_optimised )
+      setPrologFlagMask(PLFLAG_OPTIMISE);
+    else
+      clearPrologFlagMask(PLFLAG_OPTIMISE);
+
+    if ( rc != TRUE )
+    { ncl = NULL;
+    } else
+    { int same;
+
+      acquire_def(def);
+      same = ( ncl->code_size == clause->code_size &&
+	       memcmp(ncl->codes, clause->codes,
+		      clause->code_size*sizeof(code)) == 0 );
+      release_def(def);
+
+      if ( same )
+      { ATOMIC_SUB(&def->module->code_size,
+		   sizeofClause(ncl->code_size) + SIZEOF_CREF_CLAUSE);
+	freeClause(ncl);
+	ncl = NULL;
+      } else
+      { ncl->line_no   = clause->line_no;
+	ncl->source_no = clause->source_no;
+	ncl->owner_no  = clause->owner_no;
+      }
+    }
+  }
+
+  PL_discard_foreign_frame(fid);
+  if ( exception_term )
+    PL_clear_exception();
+
+  return ncl;
+}
+
+
+static int	inlineCandidateClause(Clause cl, Definition def ARG_LD);
+static int	optimisedCode(Clause cl);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+recompileDefinition() recompiles the rules of def that inline a predicate
+that has been modified or that call a predicate that can be inlined,
+preserving whether or not the rule was compiled optimised.  The old and
+new clauses are swapped in a single generation by
+replaceClausesDefinition(), so running frames complete using the old
+code.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+recompileDefinition(Definition def ARG_LD)
+{ Procedure proc;
+  ClauseRef cref;
+  tmp_buffer cbuf, obuf, nbuf;
+  gen_t generation;
+  size_t i, count;
+
+  if ( true(def, P_FOREIGN|P_DYNAMIC|P_THREAD_LOCAL) )
+    return;
+  if ( !(proc = isCurrentProcedure(def->functor->functor, def->module)) ||
+       proc->definition != def )
+    return;
+
+  initBuffer(&cbuf);
+  initBuffer(&obuf);
+  initBuffer(&nbuf);
+  generation = global_generation();
+  acquire_def(def);
+  for(cref = def->impl.clauses.first_clause; cref; cref = cref->next)
+  { Clause cl = cref->value.clause;
+
+    if ( true(cl, UNIT_CLAUSE|HAS_BREAKPOINTS|CL_BODY_CONTEXT) ||
+	 !visibleClause(cl, generation) )
+      continue;
+
+    if ( inlineCandidateClause(cl, def PASS_LD) )
+      addBuffer(&cbuf, cl, Clause);
+  }
+  release_def(def);
+
+  count = entriesBuffer(&cbuf, Clause);
+  for(i=0; i<count; i++)
+  { Clause cl = baseBuffer(&cbuf, Clause)[i];
+    Clause ncl;
+
+    if ( (ncl = optimisedClause(cl, proc, optimisedCode(cl) PASS_LD)) )
+    { addBuffer(&obuf, cl, Clause);
+      addBuffer(&nbuf, ncl, Clause);
+    }
+  }
+
+  if ( entriesBuffer(&nbuf, Clause) > 0 )
+  { DEBUG(MSG_JIT_INLINE,
+	  Sdprintf("Recompiled %zd clauses of %s\n",
+		   entriesBuffer(&nbuf, Clause), predicateName(def)));
+    replaceClausesDefinition(def,
+			     baseBuffer(&obuf, Clause),
+			     baseBuffer(&nbuf, Clause),
+			     entriesBuffer(&nbuf, Clause) PASS_LD);
+  }
+
+  discardBuffer(&cbuf);
+  discardBuffer(&obuf);
+  discardBuffer(&nbuf);
+}
+
+
+		 /*******************************
+		 *	      INLINING		*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+If the Prolog flag optimise_inline is true, a call  to a small static
+predicate of the same module that has a single clause is replaced by the
+body of this clause.  inlineClauseBody() does this at the term level,
+turning a goal into '$inline'(Goal, Body, Stamp), where Body is the
+clause of the callee with its head unified to Goal and Stamp is the
+callee's last_modified generation.  compileInline() compiles this into
+I_INLINE <proc> <stamp> followed by the call and the inlined body.  The
+decompiler only shows Goal.
+
+The callee may not be dynamic, multifile, transparent, a meta-predicate
+or system predicate and its body may not contain a cut.  We only inline
+clauses that do not inline other predicates themselves, which makes
+sure that recompilation stops for (mutually) recursive predicates.
+
+Callers are recorded in Definition->inlined_by   of the callee by module
+and functor.  If the callee is modified, setLastModifiedPredicate() calls
+inlinedPredicateModified(), which queues the callers and raises
+SIG_INLINE, after which reinlinePredicates() recompiles the rules of the
+callers.  Until then, I_INLINE finds the stamp outdated and makes the
+normal call.  Clauses are compiled normally while loading a file (the
+inlined body would upset the singleton analysis) and the callers are
+recompiled by inlineSourceFile() after the file is loaded, which also
+handles calls to predicates defined later in the file.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define INLINE_MAX_CODE	48		/* Max code size of inlined clause */
+
+static int
+inlineableDefinition(Definition def, Definition caller)
+{ return ( def != caller &&
+	   def->module == caller->module &&
+	   false(def, P_FOREIGN|P_DYNAMIC|P_THREAD_LOCAL|P_MULTIFILE|
+		      P_TRANSPARENT|P_META|P_LOCKED|SPY_ME) &&
+	   def->impl.clauses.number_of_clauses == 1 );
+}
+
+
+static Code
+skipInline(Code PC)			/* PC points at I_INLINE */
+{ Code body = PC+4+PC[3];
+
+  return body + body[-1];
+}
+
+
+static int
+staleInline(Code PC)
+{ Definition def = ((Procedure)PC[1])->definition;
+
+  return (code)def->last_modified != PC[2];
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+True if cl inlines a predicate that  has   been  modified since or calls a
+predicate that can (probably) be inlined.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+inlineCandidateClause(Clause cl, Definition def ARG_LD)
+{ int inlining = ( truePrologFlag(PLFLAG_OPTIMISE_INLINE) &&
+		   false(def, P_TRANSPARENT) );
+  Code PC = cl->codes;
+  Code ep = PC + cl->code_size;
+
+  while( PC < ep )
+  { switch( fetchop(PC) )
+    { case I_INLINE:
+	if ( staleInline(PC) )
+	  return TRUE;
+	PC = skipInline(PC);
+	continue;
+      case I_CALL:
+      case I_DEPART:
+	if ( inlining &&
+	     inlineableDefinition(((Procedure)PC[1])->definition, def) )
+	  return TRUE;
+	break;
+    }
+    PC = stepPC(PC);
+  }
+
+  return FALSE;
+}
+
+
+static int
+optimisedCode(Clause cl)
+{ Code PC = cl->codes;
+  Code ep = PC + cl->code_size;
+
+  for( ; PC < ep; PC = stepPC(PC) )
+  { switch( fetchop(PC) )
+    { case A_ENTER:
+      case A_CMP_VV:
+      case A_CMP_VC:
+	return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+
+static int
+inlineableClause(Clause cl)
+{ Code PC, ep;
+
+  if ( true(cl, HAS_BREAKPOINTS|CL_BODY_CONTEXT) ||
+       cl->code_size > INLINE_MAX_CODE )
+    return FALSE;
+
+  for(PC = cl->codes, ep = PC + cl->code_size; PC < ep; PC = stepPC(PC))
+  { if ( fetchop(PC) == I_INLINE )
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The body of the callee may not contain a cut that cuts the clause.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+inlineableBody(Word body ARG_LD)
+{ for(;;)
+  { deRef(body);
+
+    if ( isVar(*body) )
+      return FALSE;
+    if ( *body == ATOM_cut )
+      return FALSE;
+    if ( isTerm(*body) )
+    { functor_t f = functorTerm(*body);
+
+      if ( f == FUNCTOR_comma2 || f == FUNCTOR_semicolon2 ||
+	   f == FUNCTOR_bar2 || f == FUNCTOR_ifthen2 ||
+	   f == FUNCTOR_softcut2 )
+      { if ( !inlineableBody(argTermP(*body, 0) PASS_LD) )
+	  return FALSE;
+	body = argTermP(*body, 1);
+	continue;
+      }
+      if ( f == FUNCTOR_colon2 )
+      { body = argTermP(*body, 1);
+	continue;
+      }
+    }
+
+    return TRUE;
+  }
+}
+
+
+static void
+addInlineDependency(Definition def, Definition caller)
+{ atom_t name = caller->module->name;
+  functor_t functor = caller->functor->functor;
+  InlineRef r;
+
+  PL_LOCK(L_MISC);
+  for(r = def->inlined_by; r; r = r->next)
+  { if ( r->module == name && r->functor == functor )
+      break;
+  }
+  if ( !r && (r = allocHeap(sizeof(*r))) )
+  { PL_register_atom(name);
+    r->module  = name;
+    r->functor = functor;
+    r->next    = def->inlined_by;
+    def->inlined_by = r;
+  }
+  PL_UNLOCK(L_MISC);
+}
+
+
+void
+freeInlineRefs(InlineRef r)
+{ while( r )
+  { InlineRef next = r->next;
+
+    PL_unregister_atom(r->module);
+    freeHeap(r, sizeof(*r));
+    r = next;
+  }
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+inlineGoal() inlines goal if it calls a predicate  that can be inlined.
+If so, into is '$inline'(Goal, Body, Stamp). Head arguments of the
+callee that are fresh variables are unified with the argument of goal.
+Other arguments are unified using =/2 in Body.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+inlineGoal(term_t goal, term_t into, Module m, Definition caller ARG_LD)
+{ functor_t fd;
+  Procedure proc;
+  Definition def;
+  ClauseRef cref;
+  Clause cl = NULL;
+  gen_t generation, stamp;
+  fid_t fid;
+  term_t t, head, body, ga, ha, unify;
+  size_t arity, i, nunify = 0;
+  int rc;
+
+  if ( !PL_get_functor(goal, &fd) ||
+       !(proc = isCurrentProcedure(fd, m)) )
+    return FALSE;
+  def = proc->definition;
+  if ( !inlineableDefinition(def, caller) )
+    return FALSE;
+
+  if ( !(fid = PL_open_foreign_frame()) )
+    return FALSE;
+  arity = arityFunctor(fd);
+  if ( !(t = PL_new_term_refs(5)) ||
+       !(unify = PL_new_term_refs((int)arity+1)) )
+    goto failed;
+  head = t+1;
+  body = t+2;
+  ga   = t+3;
+  ha   = t+4;
+
+  stamp = def->last_modified;		/* before finding the clause */
+  generation = global_generation();
+  acquire_def(def);
+  for(cref = def->impl.clauses.first_clause; cref; cref = cref->next)
+  { if ( visibleClause(cref->value.clause, generation) )
+    { if ( cl )
+      { cl = NULL;
+	break;
+      }
+      cl = cref->value.clause;
+    }
+  }
+  rc = ( cl && inlineableClause(cl) && decompile(cl, t, 0) );
+  release_def(def);
+  if ( !rc )
+    goto failed;
+
+  if ( PL_is_functor(t, FUNCTOR_prove2) )
+  { _PL_get_arg(1, t, head);
+    _PL_get_arg(2, t, body);
+  } else
+  { PL_put_term(head, t);
+    PL_put_atom(body, ATOM_true);
+  }
+  if ( !inlineableBody(valTermRef(body) PASS_LD) )
+    goto failed;
+
+  for(i=1; i<=arity; i++)
+  { _PL_get_arg(i, goal, ga);
+    _PL_get_arg(i, head, ha);
+
+    if ( PL_is_variable(ha) && !PL_var_occurs_in(ha, goal) )
+    { if ( !PL_unify(ha, ga) )
+	goto failed;
+    } else
+    { if ( !PL_cons_functor(unify+nunify, FUNCTOR_equals2, ga, ha) )
+	goto failed;
+      nunify++;
+    }
+  }
+
+  PL_put_term(unify+nunify, body);
+  while( nunify-- > 0 )
+  { if ( !PL_cons_functor(unify+nunify, FUNCTOR_comma2,
+			  unify+nunify, unify+nunify+1) )
+      goto failed;
+  }
+  if ( !PL_put_int64(t, stamp) ||
+       !PL_cons_functor(into, FUNCTOR_dinline3, goal, unify, t) )
+    goto failed;
+
+  PL_close_foreign_frame(fid);
+  addInlineDependency(def, caller);
+  DEBUG(MSG_JIT_INLINE,
+	Sdprintf("Inlined %s into %s\n",
+		 predicateName(def), predicateName(caller)));
+
+  return TRUE;
+
+failed:
+  PL_discard_foreign_frame(fid);
+  return FALSE;
+}
+
+
+static int
+inlineBody(term_t body, term_t into, Module m, Definition caller ARG_LD)
+{ functor_t fd;
+
+  if ( !PL_get_functor(body, &fd) )
+    return FALSE;
+
+  if ( fd == FUNCTOR_comma2 || fd == FUNCTOR_semicolon2 ||
+       fd == FUNCTOR_bar2 || fd == FUNCTOR_ifthen2 ||
+       fd == FUNCTOR_softcut2 || fd == FUNCTOR_not_provable1 )
+  { size_t i, arity = arityFunctor(fd);
+    term_t av = PL_new_term_refs(4);
+    int changed = FALSE;
+
+    if ( !av )
+      return FALSE;
+    for(i=0; i<arity; i++)
+    { _PL_get_arg(i+1, body, av+i);
+      if ( inlineBody(av+i, av+2+i, m, caller PASS_LD) )
+      { PL_put_term(av+i, av+2+i);
+	changed = TRUE;
+      }
+    }
+
+    return ( changed &&
+	     ( arity == 1 ? PL_cons_functor(into, fd, av)
+			  : PL_cons_functor(into, fd, av, av+1) ) );
+  }
+  if ( fd == FUNCTOR_colon2 || fd == FUNCTOR_dinline3 )
+    return FALSE;
+
+  return inlineGoal(body, into, m, caller PASS_LD);
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+inlineClauseBody() replaces body by  its  inlined   version  if  any goal
+could be inlined. m is the module in which body is executed.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+inlineClauseBody(term_t body, Module m, Definition caller ARG_LD)
+{ term_t into;
+  int rc = FALSE;
+
+  if ( m != caller->module ||
+       true(caller, P_FOREIGN|P_DYNAMIC|P_THREAD_LOCAL|P_TRANSPARENT) )
+    return FALSE;
+
+  if ( (into = PL_new_term_ref()) )
+  { if ( (rc = inlineBody(body, into, m, caller PASS_LD)) )
+      PL_put_term(body, into);
+    PL_reset_term_refs(into);
+  }
+  if ( exception_term )
+    PL_clear_exception();
+
+  return rc;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+inlinedPredicateModified() is called if def has been modified while it
+is inlined into other predicates.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+inlinedPredicateModified(Definition def)
+{ GET_LD
+  InlineRef r, last;
+
+  PL_LOCK(L_MISC);
+  r = def->inlined_by;
+  def->inlined_by = NULL;
+  PL_UNLOCK(L_MISC);
+
+  if ( !r )
+    return;
+  if ( !HAS_LD )
+  { freeInlineRefs(r);
+    return;
+  }
+
+  for(last = r; last->next; last = last->next)
+    ;
+  last->next = LD->comp.inline_pending;
+  LD->comp.inline_pending = r;
+  PL_raise(SIG_INLINE);
+}
+
+
+void
+reinlinePredicates(ARG1_LD)
+{ InlineRef r;
+
+  while( (r = LD->comp.inline_pending) )
+  { Module m;
+    Procedure proc;
+    InlineRef *rp;
+
+    LD->comp.inline_pending = r->next;
+    r->next = NULL;
+    for(rp = &LD->comp.inline_pending; *rp; )	/* delete duplicates */
+    { InlineRef r2 = *rp;
+
+      if ( r2->module == r->module && r2->functor == r->functor )
+      { *rp = r2->next;
+	r2->next = NULL;
+	freeInlineRefs(r2);
+      } else
+	rp = &r2->next;
+    }
+
+    if ( (m = isCurrentModule(r->module)) &&
+	 (proc = isCurrentProcedure(r->functor, m)) &&
+	 proc->definition->module == m )
+    { SourceFile sf = NULL;
+
+      if ( proc->source_no )
+	sf = indexToSourceFile(proc->source_no);
+      if ( !sf || !sf->reload )		/* see inlineSourceFile() */
+	recompileDefinition(proc->definition PASS_LD);
+    }
+    freeInlineRefs(r);
+  }
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+inlineDefinition() is called by inlineSourceFile() for the predicates
+of a file that has just been loaded.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+inlineDefinition(Definition def ARG_LD)
+{ recompileDefinition(def PASS_LD);
+}
+
+
 
 
 		/********************************
@@ -5064,11 +6156,38 @@ decompileBody(decompileInfo *di, code end, Code until ARG_LD)
 #endif
 #if O_COMPILE_ARITH
       case A_ADD:
+      case A_FADD:
 			    BUILD_TERM(FUNCTOR_plus2);
 			    continue;
+      case A_SUB:
+      case A_FSUB:
+			    BUILD_TERM(FUNCTOR_minus2);
+			    continue;
       case A_MUL:
+      case A_FMUL:
 			    BUILD_TERM(FUNCTOR_star2);
 			    continue;
+      case A_FDIV:
+			    BUILD_TERM(FUNCTOR_divide2);
+			    continue;
+      case A_CMP_VV:
+      { functor_t f = arithCompareFunctor((int)*PC++);
+
+	*ARGP++ = makeVarRef((int)*PC++);
+	*ARGP++ = makeVarRef((int)*PC++);
+	BUILD_TERM(f);
+	pushed++;
+	continue;
+      }
+      case A_CMP_VC:
+      { functor_t f = arithCompareFunctor((int)*PC++);
+
+	*ARGP++ = makeVarRef((int)*PC++);
+	*ARGP++ = consInt((intptr_t)*PC++);
+	BUILD_TERM(f);
+	pushed++;
+	continue;
+      }
       case A_FUNC0:
       case A_FUNC1:
       case A_FUNC2:
@@ -5234,6 +6353,15 @@ decompileBody(decompileInfo *di, code end, Code until ARG_LD)
       case I_USERCALL0:	    BUILD_TERM(FUNCTOR_call1);
 			    pushed++;
 			    continue;
+      case I_INLINE:			/* see compileInline() */
+			  { Code body = PC+3+PC[2];
+
+			    PC += 3;
+			    TRY_DECOMPILE(di, (code)-1, body-2); /* Goal */
+			    PC = body + body[-1];
+			    pushed++;
+			    continue;
+			  }
 #if O_COMPILE_OR
 #define DECOMPILETOJUMP { int to_jump = (int) *PC++; \
 			  TRY_DECOMPILE(di, (code)-1, PC+to_jump); \
@@ -6575,6 +7703,12 @@ find_if_then_end(Code PC, Code base)
       case C_NOT:
 	PC = nextpc + PC[2];
         break;
+      case I_INLINE:
+      { Code body = nextpc + PC[3];
+
+	PC = body + body[-1];
+	break;
+      }
       case C_SOFTIF:
       case C_IFTHENELSE:
       case C_FASTCOND:
@@ -6846,6 +7980,19 @@ PRED_IMPL("$clause_term_position", 3, clause_term_position, 0)
 	goto after_construct;
       }
       }					/* closes the special constructs */
+      case I_INLINE:		/* I_INLINE <proc> <stamp> <jmp1> <Goal> */
+      { Code body = nextpc + PC[3];	/* C_JMP <jmp2> <Body> */
+	Code endloc = body + body[-1];
+
+	if ( loc <= endloc )		/* the inlined body is the goal */
+	{ add_1_if_not_at_end(endloc, end, tail PASS_LD);
+
+	  return PL_unify_nil(tail);
+	}
+	add_node(tail, 2 PASS_LD);
+	PC = endloc;
+	continue;
+      }
       case I_CONTEXT:			/* used to compile m:head :- body */
 	PC = nextpc;
 	add_node(tail, 2 PASS_LD);
@@ -7228,6 +8375,7 @@ BeginPredDefs(comp)
   PRED_DEF("assert",  2, assertz2, META)
   PRED_DEF("assertz", 2, assertz2, META)
   PRED_DEF("asserta", 2, asserta2, META)
+  PRED_DEF("assertz_all", 1, assertz_all, META)
   PRED_DEF("redefine_system_predicate", 1, redefine_system_predicate, META)
   PRED_DEF("compile_predicates",  1, compile_predicates, META)
   PRED_DEF("$predefine_foreign",  1, predefine_foreign, PL_FA_TRANSPARENT)
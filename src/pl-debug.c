@@ -163,6 +163,7 @@ const debug_topic debug_topics[] =
   DEBUG_TOPIC(MSG_JIT),
   DEBUG_TOPIC(MSG_JIT_DELINDEX),
   DEBUG_TOPIC(MSG_JIT_POOR),
+  DEBUG_TOPIC(MSG_JIT_INLINE),
 
   DEBUG_TOPIC(MSG_RECONSULT),
   DEBUG_TOPIC(MSG_RECONSULT_PRED),
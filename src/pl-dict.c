@@ -1100,7 +1100,7 @@ True if Term is a dict that belongs to Tag.
 */
 
 static
-PRED_IMPL("is_dict", 1, is_dict, 0)
+PRED_IMPL("is_dict", 1, is_dict, PL_FA_LEAF)
 { PRED_LD
   Word p = valTermRef(A1);
 
@@ -1120,7 +1120,7 @@ PRED_IMPL("is_dict", 1, is_dict, 0)
 
 
 static
-PRED_IMPL("is_dict", 2, is_dict, 0)
+PRED_IMPL("is_dict", 2, is_dict, PL_FA_LEAF)
 { PRED_LD
   Word p = valTermRef(A1);
 
@@ -1663,8 +1663,8 @@ retry:
 		 *******************************/
 
 BeginPredDefs(dict)
-  PRED_DEF("is_dict",	   1, is_dict,	    0)
-  PRED_DEF("is_dict",	   2, is_dict,	    0)
+  PRED_DEF("is_dict",	   1, is_dict,	    PL_FA_LEAF)
+  PRED_DEF("is_dict",	   2, is_dict,	    PL_FA_LEAF)
   PRED_DEF("dict_create",  3, dict_create,  0)
   PRED_DEF("dict_pairs",   3, dict_pairs,   0)
   PRED_DEF("put_dict",	   3, put_dict,	    0)
@@ -326,6 +326,8 @@ registerBuiltins(const PL_extension *f)
       if ( f->flags & PL_FA_VARARGS )	       set(def, P_VARARG);
       if ( f->flags & PL_FA_CREF )	       set(def, P_FOREIGN_CREF);
       if ( f->flags & PL_FA_ISO )	       set(def, P_ISO);
+      if ( (f->flags & (PL_FA_LEAF|PL_FA_NONDETERMINISTIC|PL_FA_TRANSPARENT))
+	   == PL_FA_LEAF )		       set(def, P_LEAF);
 
       def->impl.foreign.function = f->function;
       createForeignSupervisor(def, f->function);
@@ -501,6 +503,7 @@ initBuildIns(void)
   PL_meta_predicate(PL_predicate("assert",           2, "system"), ":-");
   PL_meta_predicate(PL_predicate("asserta",          2, "system"), ":-");
   PL_meta_predicate(PL_predicate("assertz",          2, "system"), ":-");
+  PL_meta_predicate(PL_predicate("assertz_all",      1, "system"), ":");
   PL_meta_predicate(PL_predicate("retract",          1, "system"), ":");
   PL_meta_predicate(PL_predicate("retractall",       1, "system"), ":");
   PL_meta_predicate(PL_predicate("clause",           2, "system"), ":?");
@@ -4404,7 +4404,8 @@ bindForeign(Module m, const char *name, int arity, Func f, int flags)
   if ( def->impl.any.defined )
     PL_linger(def->impl.any.defined);	/* Dubious: what if a clause list? */
   def->impl.foreign.function = f;
-  def->flags &= ~(P_DYNAMIC|P_THREAD_LOCAL|P_TRANSPARENT|P_NONDET|P_VARARG);
+  def->flags &= ~(P_DYNAMIC|P_THREAD_LOCAL|P_TRANSPARENT|P_NONDET|P_VARARG|
+		  P_LEAF);
   def->flags |= (P_FOREIGN|TRACE_ME);
 
   if ( m == MODULE_system || SYSTEM_MODE )
@@ -4414,6 +4415,9 @@ bindForeign(Module m, const char *name, int arity, Func f, int flags)
   if ( (flags & PL_FA_TRANSPARENT) )	  set(def, P_TRANSPARENT);
   if ( (flags & PL_FA_NONDETERMINISTIC) ) set(def, P_NONDET);
   if ( (flags & PL_FA_VARARGS) )	  set(def, P_VARARG);
+  if ( (flags & (PL_FA_LEAF|PL_FA_NONDETERMINISTIC|
+		 PL_FA_TRANSPARENT|PL_FA_META)) == PL_FA_LEAF )
+    set(def, P_LEAF);
 
   createForeignSupervisor(def, f);
   notify_registered_foreign(fdef, m);
@@ -4917,6 +4921,24 @@ PL_dispatch(int fd, int wait)
 }
 
 
+		 /*******************************
+		 *	  CLAUSE DATABASE	*
+		 *******************************/
+
+/* PL_assertz_terms() adds all clauses from source, which is either a
+   list of clauses or a stream, to the end of their predicates.  Clauses
+   that are not module qualified are added to m or, if m is NULL, to the
+   context module.  See assertz_terms() in pl-comp.c.
+*/
+
+int
+PL_assertz_terms(term_t source, module_t m)
+{ GET_LD
+
+  return assertz_terms(source, m PASS_LD);
+}
+
+
 		 /*******************************
 		 *	RECORDED DATABASE	*
 		 *******************************/
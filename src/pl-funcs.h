@@ -116,8 +116,11 @@ COMMON(void)		_PL_debug_unregister_atom(atom_t a,
 
 COMMON(int)		ar_compare(Number n1, Number n2, int what);
 COMMON(int)		ar_compare_eq(Number n1, Number n2);
+COMMON(functor_t)	arithCompareFunctor(int what);
 COMMON(int)		pl_ar_add(Number n1, Number n2, Number r);
+COMMON(int)		ar_minus(Number n1, Number n2, Number r);
 COMMON(int)		ar_mul(Number n1, Number n2, Number r);
+COMMON(int)		ar_divide(Number n1, Number n2, Number r);
 COMMON(word)		pl_current_arithmetic_function(term_t f, control_t h);
 COMMON(void)		initArith(void);
 COMMON(void)		cleanupArith(void);
@@ -151,8 +154,14 @@ COMMON(int)		compileClause(Clause *cp, Word head, Word body,
 				      term_t warnings ARG_LD);
 COMMON(Clause)		assert_term(term_t term, ClauseRef where, atom_t owner,
 				    SourceLoc loc ARG_LD);
+COMMON(int)		assertz_terms(term_t source, Module module ARG_LD);
 COMMON(void)		forAtomsInClause(Clause clause, void (func)(atom_t a));
 COMMON(Code)		stepDynPC(Code PC, const code_info *ci);
+COMMON(void)		superInstructions(Code PC, size_t size);
+COMMON(void)		inlinedPredicateModified(Definition def);
+COMMON(void)		reinlinePredicates(ARG1_LD);
+COMMON(void)		inlineDefinition(Definition def ARG_LD);
+COMMON(void)		freeInlineRefs(InlineRef r);
 COMMON(bool)		decompileHead(Clause clause, term_t head);
 COMMON(Code)		skipArgs(Code PC, int skip);
 COMMON(int)		argKey(Code PC, int skip, word *key);
@@ -189,17 +198,24 @@ COMMON(ClauseRef)	nextClause__LD(ClauseChoice chp, Word argv, LocalFrame fr,
 				       Definition def ARG_LD);
 COMMON(int)		addClauseToIndexes(Definition def, Clause cl,
 					   ClauseRef where);
+COMMON(void)		addClausesToIndexes(Definition def, ClauseRef cref,
+					    size_t count);
 COMMON(void)		delClauseFromIndex(Definition def, Clause cl);
 COMMON(void)		cleanClauseIndexes(Definition def, ClauseList cl,
 					   gen_t active);
 COMMON(void)		clearTriedIndexes(Definition def);
+COMMON(void)		reconsiderIndexes(Definition def);
 COMMON(void)		unallocClauseIndexTable(ClauseIndex ci);
 COMMON(void)		deleteActiveClauseFromIndexes(Definition def, Clause cl);
-COMMON(bool)		unify_index_pattern(Procedure proc, term_t value);
+COMMON(bool)		unify_index_pattern(Procedure proc, term_t value,
+					    int lists);
 COMMON(void)		deleteIndexes(ClauseList cl, int isnew);
 COMMON(int)		checkClauseIndexSizes(Definition def, int nindexable);
 COMMON(void)		checkClauseIndexes(Definition def);
 COMMON(void)		listIndexGenerations(Definition def, gen_t gen);
+COMMON(void)		forgetIndexJobs(Definition def);
+COMMON(void)		buildQueuedIndexes(ARG1_LD);
+COMMON(void)		deleteRangeIndexes(Definition def);
 
 /* pl-dwim.c */
 COMMON(word)		pl_dwim_match(term_t a1, term_t a2, term_t mm);
@@ -317,6 +333,10 @@ COMMON(void)		call_tune_gc_hook(void);
 COMMON(int)		garbageCollect(gc_reason_t reason);
 COMMON(word)		pl_garbage_collect(term_t d);
 COMMON(gc_stat *)	last_gc_stats(gc_stats *stats);
+COMMON(int)		gc_pause_kind(gc_reason_t reason);
+COMMON(void)		record_pause(int kind, double seconds ARG_LD);
+COMMON(int)		unify_pause_histograms(term_t t,
+					       PL_local_data_t *ld ARG_LD);
 COMMON(Word)		findGRef(int n);
 COMMON(size_t)		nextStackSizeAbove(size_t n);
 COMMON(int)		shiftTightStacks(void);
@@ -423,6 +443,7 @@ COMMON(void)		unify_vp(Word vp, Word val ARG_LD);
 COMMON(bool)		can_unify(Word t1, Word t2, term_t ex);
 COMMON(int)		compareStandard(Word t1, Word t2, int eq ARG_LD);
 COMMON(int)		compareAtoms(atom_t a1, atom_t a2);
+COMMON(int)		compareFloats(double f1, double f2);
 COMMON(intptr_t)	skip_list(Word l, Word *tailp ARG_LD);
 COMMON(intptr_t)	lengthList(term_t list, int errors);
 COMMON(int)		is_acyclic(Word p ARG_LD);
@@ -502,8 +523,13 @@ COMMON(foreign_t)	pl_current_predicate1(term_t spec, control_t ctx);
 COMMON(void)		clear_meta_declaration(Definition def);
 COMMON(void)		setMetapredicateMask(Definition def, arg_info *args);
 COMMON(int)		isTransparentMetamask(Definition def, arg_info *args);
+COMMON(void)		waitUnlockedWriters(Definition def);
 COMMON(ClauseRef)	assertProcedure(Procedure proc, Clause clause,
 					ClauseRef where ARG_LD);
+COMMON(void)		assertProcedureList(Procedure proc, Clause *clauses,
+					    size_t count ARG_LD);
+COMMON(void)		publishClauses(Procedure *procs, Clause *clauses,
+				       size_t count ARG_LD);
 COMMON(bool)		abolishProcedure(Procedure proc, Module module);
 COMMON(bool)		retractClauseDefinition(Definition def, Clause clause);
 COMMON(void)		unallocClause(Clause c);
@@ -514,6 +540,9 @@ COMMON(size_t)		removeClausesPredicate(Definition def,
 					       int sfindex, int fromfile);
 COMMON(void)		reconsultFinalizePredicate(sf_reload *rl, Definition def,
 						   p_reload *r ARG_LD);
+COMMON(void)		replaceClausesDefinition(Definition def,
+						 Clause *old, Clause *new,
+						 size_t count ARG_LD);
 COMMON(void)		destroyDefinition(Definition def);
 COMMON(Procedure)	resolveProcedure__LD(functor_t f, Module module ARG_LD);
 COMMON(Definition)	trapUndefined(Definition undef ARG_LD);
@@ -623,6 +652,7 @@ COMMON(void)		initPrologLocalData(ARG1_LD);
 COMMON(void)		deallocateStacks(void);
 COMMON(bool)		restoreStack(Stack s);
 COMMON(void)		trimStacks(int resize ARG_LD);
+COMMON(void)		setGCPolicy(int policy ARG_LD);
 COMMON(void)		emptyStacks(void);
 COMMON(void)		freeStacks(ARG1_LD);
 COMMON(void)		freePrologLocalData(PL_local_data_t *ld);
@@ -686,6 +716,8 @@ COMMON(const char *)	string_summary(word name, unsigned int maxlen);
 COMMON(bool)		loadWicFromStream(const char *rcpath, IOSTREAM *fd);
 COMMON(bool)		compileFileList(IOSTREAM *out, int argc, char **argv);
 COMMON(void)		qlfCleanup(void);
+COMMON(void)		loadLazyDefinition(Definition def);
+COMMON(void)		discardLazyDefinition(Definition def);
 
 COMMON(void)		wicPutStringW(const pl_wchar_t *w, size_t len,
 				      IOSTREAM *fd);
@@ -220,6 +220,9 @@ typedef struct vm_state
 		 *******************************/
 
 forwards void		mark_variable(Word ARG_LD);
+#ifdef O_PLMT
+static void		mark_root_deferred(Word start ARG_LD);
+#endif
 static void		mark_local_variable(Word p ARG_LD);
 forwards void		sweep_foreign(void);
 static void		sweep_global_mark(Word *m ARG_LD);
@@ -262,6 +265,8 @@ static int		check_marked(const char *s);
 #define local_frames	   (LD->gc._local_frames)
 #define choice_count	   (LD->gc._choice_count)
 #define start_map	   (LD->gc._start_map)
+#define young_bar	   (LD->gc._young_bar)
+#define gc_marker	   (LD->gc._mark_worker)
 #if O_DEBUG
 #define trailtops_marked   (LD->gc._trailtops_marked)
 #define mark_base	   (LD->gc._mark_base)
@@ -537,7 +542,7 @@ gc_stat_aggregate(gc_stats *stats)
 }
 
 static void
-gc_stat_start(gc_stats *stats, unsigned int reason ARG_LD)
+gc_stat_start(gc_stats *stats, gc_reason_t reason ARG_LD)
 { gc_stat *this = &stats->last[stats->last_index];
   double cpu = ThreadCPUTime(LD, CPU_USER);
 
@@ -611,7 +616,7 @@ unify_gc_reason(term_t t, gc_stat *stat ARG_LD)
   int to = (stat->reason>>16)&0xff;
   int tr = (stat->reason>>24)&0xff;
   int ex = (stat->reason>>32)&0xff;
-  int ur = (stat->reason>>36)&0xff;
+  int ur = (stat->reason>>40)&0xff;
 
   return PL_unify_term(t, PL_FUNCTOR, FUNCTOR_gc6,
 		            PL_INT, go,
@@ -674,6 +679,159 @@ PRED_IMPL("$gc_statistics", 5, gc_statistics, 0)
 }
 
 
+		 /*******************************
+		 *	  PAUSE HISTOGRAMS	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Each thread keeps a histogram of  the   wall  time  it was paused for by
+stack GC (one per gc_reason_t),  atom  GC,   clause  GC  and stack shifts.
+Pauses are recorded in microseconds in   log-linear buckets: values below
+4 have their own bucket and each following power of two is split into 4
+buckets, so the relative error of a  bucket is at most 25%. Pauses that
+do not fit (> 71 minutes) are counted in the last bucket.
+
+AGC and CGC are recorded by the thread   that  performs them, which is the
+`gc` thread if the flag `gc_thread` is enabled.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static const atom_t pause_kind_names[PL_PAUSE_KINDS] =
+{ ATOM_user,
+  ATOM_exception,
+  ATOM_global_overflow,
+  ATOM_trail_overflow,
+  ATOM_global_request,
+  ATOM_trail_request,
+  ATOM_agc,
+  ATOM_cgc,
+  ATOM_shift
+};
+
+static int
+pause_bucket(int64_t usec)
+{ int o, b;
+
+  if ( usec < 4 )
+    return usec < 0 ? 0 : (int)usec;
+
+  o = MSB64(usec);
+  b = (o-1)*4 + (int)((usec>>(o-2))&0x3);
+
+  return b < PL_PAUSE_BUCKETS ? b : PL_PAUSE_BUCKETS-1;
+}
+
+static int64_t
+pause_bucket_base(int b)
+{ if ( b < 4 )
+    return b;
+  return (int64_t)(4 + b%4) << (b/4 - 1);
+}
+
+int
+gc_pause_kind(gc_reason_t reason)
+{ if ( (reason & GC_USER) )
+    return PL_PAUSE_GC_USER;
+  if ( (reason & GC_EXCEPTION) )
+    return PL_PAUSE_GC_EXCEPTION;
+  if ( (reason & GC_GLOBAL_OVERFLOW) )
+    return PL_PAUSE_GC_GLOBAL_OVERFLOW;
+  if ( (reason & GC_TRAIL_OVERFLOW) )
+    return PL_PAUSE_GC_TRAIL_OVERFLOW;
+  if ( (reason & GC_TRAIL_REQUEST) )
+    return PL_PAUSE_GC_TRAIL_REQUEST;
+
+  return PL_PAUSE_GC_GLOBAL_REQUEST;
+}
+
+void
+record_pause(int kind, double seconds ARG_LD)
+{ pl_pause_histogram_t *h = &LD->statistics.pauses[kind];
+  int64_t usec = (int64_t)(seconds*1000000.0);
+
+  if ( usec < 0 )
+    usec = 0;
+
+  h->count++;
+  h->total += usec;
+  if ( usec > h->max )
+    h->max = usec;
+  h->buckets[pause_bucket(usec)]++;
+}
+
+int
+PL_pause_histogram(int kind, pl_pause_histogram_t *h)
+{ GET_LD
+
+  if ( !LD || kind < 0 || kind >= PL_PAUSE_KINDS )
+    return FALSE;
+
+  *h = LD->statistics.pauses[kind];
+  return TRUE;
+}
+
+int64_t
+PL_pause_bucket_limit(int b)
+{ if ( b < 0 || b >= PL_PAUSE_BUCKETS )
+    return -1;
+
+  return pause_bucket_base(b+1);
+}
+
+/* unify_pause_histograms() implements statistics(gc_pauses, List) for
+   the thread owning ld.  List holds a term
+
+	pause(Kind, Count, TotalUs, MaxUs, Buckets)
+
+   for each kind for which at least one pause was recorded.  Buckets is
+   a list Limit-Count for the non-empty buckets, where Limit is the
+   exclusive upper bound of the bucket in microseconds.
+*/
+
+int
+unify_pause_histograms(term_t t, PL_local_data_t *ld ARG_LD)
+{ term_t tail  = PL_copy_term_ref(t);
+  term_t head  = PL_new_term_ref();
+  term_t btail = PL_new_term_ref();
+  term_t bhead = PL_new_term_ref();
+  term_t bl    = PL_new_term_ref();
+  int k;
+
+  for(k=0; k<PL_PAUSE_KINDS; k++)
+  { pl_pause_histogram_t h = ld->statistics.pauses[k];
+    int b;
+
+    if ( h.count == 0 )
+      continue;
+
+    PL_put_variable(bl);
+    PL_put_term(btail, bl);
+    for(b=0; b<PL_PAUSE_BUCKETS; b++)
+    { if ( h.buckets[b] )
+      { if ( !PL_unify_list(btail, bhead, btail) ||
+	     !PL_unify_term(bhead,
+			    PL_FUNCTOR, FUNCTOR_minus2,
+			      PL_INT64, PL_pause_bucket_limit(b),
+			      PL_INT64, h.buckets[b]) )
+	  return FALSE;
+      }
+    }
+
+    if ( !PL_unify_nil(btail) ||
+	 !PL_unify_list(tail, head, tail) ||
+	 !PL_unify_term(head,
+			PL_FUNCTOR, FUNCTOR_pause5,
+			  PL_ATOM,  pause_kind_names[k],
+			  PL_INT64, h.count,
+			  PL_INT64, h.total,
+			  PL_INT64, h.max,
+			  PL_TERM,  bl) )
+      return FALSE;
+  }
+
+  return PL_unify_nil(tail);
+}
+
+
 		/********************************
 		*          UTILITIES            *
 		*********************************/
@@ -834,9 +992,18 @@ mark_variable(Word start ARG_LD)
   if ( is_marked(start) )
     sysError("Attempt to mark twice");
 
+#ifdef O_PLMT
+  if ( gc_marker )
+  { mark_root_deferred(start PASS_LD);
+    return;
+  }
+#endif
+
   if ( onStackArea(local, start) )
   { markLocal(start);
     total_marked--;			/* do not count local stack cell */
+  } else if ( start < young_bar )
+  { total_marked--;			/* old cell: see mark_old_roots() */
   }
   current = start;
   mark_first(current);
@@ -853,6 +1020,8 @@ forward:				/* Go into the tree */
     { next = unRef(val);		/* address pointing to */
       DEBUG(CHK_SECURE, assert(onStack(global, next)));
       needsRelocation(current);
+      if ( next < young_bar )		/* old generation is not collected */
+	BACKWARD;
       if ( is_first(next) )		/* ref to choice point. we will */
         BACKWARD;			/* get there some day anyway */
       val  = get_value(next);		/* invariant */
@@ -868,7 +1037,7 @@ forward:				/* Go into the tree */
       next = valPtr2(val, STG_GLOBAL);
       DEBUG(CHK_SECURE, assert(onStack(global, next)));
       needsRelocation(current);
-      if ( is_marked(next) )
+      if ( is_marked(next) || next < young_bar )
 	BACKWARD;			/* term has already been marked */
       val  = get_value(next);		/* invariant */
 					/* backwards pointer */
@@ -886,7 +1055,7 @@ forward:				/* Go into the tree */
       next = valPtr2(val, STG_GLOBAL);
       DEBUG(CHK_SECURE, assert(onStack(global, next)));
       needsRelocation(current);
-      if ( is_marked(next) )
+      if ( is_marked(next) || next < young_bar )
 	BACKWARD;			/* term has already been marked */
       args = arityFunctor(((Functor)next)->definition);
       DEBUG(MSG_GC_MARK_VAR_WALK,
@@ -917,8 +1086,8 @@ forward:				/* Go into the tree */
       DEBUG(CHK_SECURE, assert(storage(val) == STG_GLOBAL));
       DEBUG(CHK_SECURE, assert(onStack(global, next)));
       needsRelocation(current);
-      if ( is_marked(next) )		/* can be referenced from multiple */
-        BACKWARD;			/* places */
+      if ( is_marked(next) || next < young_bar ) /* can be referenced from */
+        BACKWARD;			/* multiple places */
       domark(next);
       DEBUG(MSG_GC_MARK_VAR_WALK,
 	    Sdprintf("Marked indirect data type, size = %ld\n",
@@ -970,6 +1139,382 @@ backward:				/* reversing backwards */
 }
 
 
+		 /*******************************
+		 *	 PARALLEL MARKING	*
+		 *******************************/
+
+#ifdef O_PLMT
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+If the Prolog flag gc_mark_threads is  non-zero and the region to collect
+is large, mark_phase() marks  the  global  stack  using helper threads.
+Pointer reversal cannot be shared between threads.  Instead,
+mark_variable() only marks the root cell and pushes the cells it refers
+to on an explicit mark stack of  the  GC'ing  thread (mark_root_deferred()).
+This stack is processed by drain_marks()  before the marks are used,
+i.e., before early_reset_vars() and at the end of mark_phase().
+
+Each marker has a private stack of chunks.  If the GC'ing thread has more
+than one chunk of work it starts a session, waking the helpers, and puts
+its surplus chunks in the shared pool GD->thread.mark.  Markers that run
+out of work steal chunks from the pool, and markers that have surplus
+work while others are waiting add chunks to it.  The session is complete
+if all markers are waiting and the pool is empty.
+
+Cells are claimed by atomically setting their mark bit.  The markers only
+read the value part of the cells, so no other synchronization is needed.
+Counting is the same as for mark_variable(): each marked global cell adds
+to total_marked (the header of an indirect adds the size of the indirect)
+and each marked cell that holds a global pointer adds to needs_relocation.
+Markers count privately and the counts are added at the end.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define MARK_CHUNK_CELLS	510	/* 4K chunks on 64-bit hardware */
+#define PARALLEL_MARK_MIN	(1024*1024) /* Min bytes to mark in parallel */
+
+typedef struct mark_chunk
+{ struct mark_chunk *next;		/* next (older) chunk */
+  size_t	count;			/* # cells in use */
+  Word		cells[MARK_CHUNK_CELLS];
+} mark_chunk;
+
+typedef struct mark_worker
+{ mark_chunk   *stack;			/* private mark stack */
+  mark_chunk   *free;			/* recycled chunks */
+  Word		bottom;			/* bottom of the collected region */
+  intptr_t	marked;			/* # marked global cells */
+  intptr_t	relocations;		/* # cells that need relocation */
+  int		may_share;		/* we may start a session */
+  int		in_session;		/* we are in a session */
+} mark_worker;
+
+#define MPOOL (&GD->thread.mark)
+
+static mark_chunk *
+new_mark_chunk(mark_worker *w)
+{ mark_chunk *c;
+
+  if ( (c=w->free) )
+  { w->free = c->next;
+  } else if ( !(c = malloc(sizeof(*c))) )
+  { outOfCore();
+  }
+  c->count = 0;
+
+  return c;
+}
+
+
+static void
+free_mark_chunks(mark_worker *w)
+{ mark_chunk *c, *next;
+
+  for(c=w->free; c; c=next)
+  { next = c->next;
+    free(c);
+  }
+  w->free = NULL;
+}
+
+
+static void
+start_mark_session(mark_worker *w)
+{ pthread_mutex_lock(&MPOOL->mutex);
+  MPOOL->done        = FALSE;
+  MPOOL->active      = 1;		/* the GC'ing thread */
+  MPOOL->marked      = 0;
+  MPOOL->relocations = 0;
+  MPOOL->session++;
+  pthread_cond_broadcast(&MPOOL->cond);
+  pthread_mutex_unlock(&MPOOL->mutex);
+  w->in_session = TRUE;
+}
+
+
+/* Move all chunks below the top chunk to the shared pool */
+
+static void
+share_mark_chunks(mark_worker *w)
+{ mark_chunk *c;
+
+  if ( !w->in_session )
+  { if ( !w->may_share )
+      return;
+    start_mark_session(w);
+  }
+
+  pthread_mutex_lock(&MPOOL->mutex);
+  while( (c=w->stack->next) )
+  { w->stack->next = c->next;
+    c->next = MPOOL->chunks;
+    MPOOL->chunks = c;
+  }
+  pthread_cond_broadcast(&MPOOL->cond);
+  pthread_mutex_unlock(&MPOOL->mutex);
+}
+
+
+static inline void
+push_mark(mark_worker *w, Word p)
+{ mark_chunk *c = w->stack;
+
+  if ( !c || c->count == MARK_CHUNK_CELLS )
+  { c = new_mark_chunk(w);
+    c->next = w->stack;
+    w->stack = c;
+    if ( c->next &&
+	 ((w->in_session && MPOOL->waiting > 0) ||
+	  (!w->in_session && w->may_share)) )
+      share_mark_chunks(w);
+  }
+  c->cells[c->count++] = p;
+}
+
+
+static inline int
+pop_mark(mark_worker *w, Word *p)
+{ mark_chunk *c;
+
+  while( (c=w->stack) && c->count == 0 )
+  { w->stack = c->next;
+    c->next = w->free;
+    w->free = c;
+  }
+  if ( c )
+  { *p = c->cells[--c->count];
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+
+static inline int
+claim_cell(Word p)
+{ return !(ATOMIC_OR(p, MARK_MASK) & MARK_MASK);
+}
+
+
+/* Process the value of a marked cell, i.e., push the cells it refers to */
+
+static void
+mark_value(mark_worker *w, word val ARG_LD)
+{ Word next;
+
+  switch(tag(val))
+  { case TAG_REFERENCE:
+    case TAG_ATTVAR:
+      next = valPtr2(val, STG_GLOBAL);
+      w->relocations++;
+      if ( next >= w->bottom && !is_marked(next) )
+	push_mark(w, next);
+      break;
+    case TAG_COMPOUND:
+    { size_t arity;
+
+      next = valPtr2(val, STG_GLOBAL);
+      w->relocations++;
+      if ( next < w->bottom || !claim_cell(next) )
+	break;
+      w->marked++;
+      arity = arityFunctor(((Functor)next)->definition);
+      for(next++; arity > 0; arity--, next++) /* last (list tail) on top */
+      { if ( !is_marked(next) )
+	  push_mark(w, next);
+      }
+      break;
+    }
+    case TAG_INTEGER:
+      if ( storage(val) == STG_INLINE )
+	break;
+      /*FALLTHROUGH*/
+    case TAG_STRING:
+    case TAG_FLOAT:
+      next = valPtr2(val, STG_GLOBAL);
+      w->relocations++;
+      if ( next >= w->bottom && claim_cell(next) )
+	w->marked += offset_cell(next) + 1;
+      break;
+  }
+}
+
+
+static void
+run_marker(mark_worker *w ARG_LD)
+{ Word p;
+
+  while( pop_mark(w, &p) )
+  { if ( claim_cell(p) )
+    { w->marked++;
+      mark_value(w, get_value(p) PASS_LD);
+    }
+  }
+}
+
+
+/* Get work from the pool.  Returns FALSE if the session is completed */
+
+static int
+steal_mark_chunk(mark_worker *w, int was_active)
+{ pthread_mutex_lock(&MPOOL->mutex);
+  if ( was_active )
+    MPOOL->active--;
+  for(;;)
+  { mark_chunk *c;
+
+    if ( (c=MPOOL->chunks) )
+    { MPOOL->chunks = c->next;
+      c->next = w->stack;
+      w->stack = c;
+      MPOOL->active++;
+      pthread_mutex_unlock(&MPOOL->mutex);
+      return TRUE;
+    }
+    if ( MPOOL->active == 0 || MPOOL->done )
+    { MPOOL->done = TRUE;
+      pthread_cond_broadcast(&MPOOL->cond);
+      pthread_mutex_unlock(&MPOOL->mutex);
+      return FALSE;
+    }
+    MPOOL->waiting++;
+    pthread_cond_wait(&MPOOL->cond, &MPOOL->mutex);
+    MPOOL->waiting--;
+  }
+}
+
+
+static void *
+mark_helper(void *closure)
+{ int id = (int)(intptr_t)closure;
+  int seen;
+#ifdef HAVE_SIGPROCMASK
+  sigset_t set;
+  allSignalMask(&set);
+  pthread_sigmask(SIG_BLOCK, &set, NULL);
+#endif
+
+  pthread_mutex_lock(&MPOOL->mutex);
+  seen = MPOOL->session;
+  for(;;)
+  { PL_local_data_t *__PL_ld;
+    mark_worker w;
+    int active = FALSE;
+
+    while( MPOOL->session == seen )
+      pthread_cond_wait(&MPOOL->cond, &MPOOL->mutex);
+    seen = MPOOL->session;
+    if ( MPOOL->done || id >= MPOOL->threads )
+      continue;
+
+    memset(&w, 0, sizeof(w));
+    w.bottom     = MPOOL->bottom;
+    w.in_session = TRUE;
+    __PL_ld = MPOOL->ld;
+    MPOOL->joined++;
+    pthread_mutex_unlock(&MPOOL->mutex);
+
+    while( steal_mark_chunk(&w, active) )
+    { run_marker(&w PASS_LD);
+      active = TRUE;
+    }
+    free_mark_chunks(&w);
+
+    pthread_mutex_lock(&MPOOL->mutex);
+    MPOOL->marked      += w.marked;
+    MPOOL->relocations += w.relocations;
+    MPOOL->joined--;
+    pthread_cond_broadcast(&MPOOL->cond);
+  }
+
+  return NULL;
+}
+
+
+/* Claim the helper pool and make sure we have enough helpers */
+
+static int
+acquire_mark_helpers(ARG1_LD)
+{ int threads = MPOOL->threads;
+
+  if ( threads <= 0 || !COMPARE_AND_SWAP(&MPOOL->owned, FALSE, TRUE) )
+    return FALSE;
+
+  while( MPOOL->running < threads )
+  { pthread_attr_t attr;
+    pthread_t thr;
+    int rc;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    rc = pthread_create(&thr, &attr, mark_helper,
+			(void*)(intptr_t)MPOOL->running);
+    pthread_attr_destroy(&attr);
+    if ( rc != 0 )
+      break;
+    MPOOL->running++;
+  }
+
+  MPOOL->ld        = LD;
+  MPOOL->bottom    = young_bar;
+
+  return MPOOL->running > 0 ? TRUE : (MPOOL->owned = FALSE);
+}
+
+
+static void
+release_mark_helpers(ARG1_LD)
+{ MPOOL->ld = NULL;
+  MPOOL->owned = FALSE;
+}
+
+
+static void
+mark_root_deferred(Word start ARG_LD)
+{ mark_worker *w = gc_marker;
+
+  if ( onStackArea(local, start) )
+  { markLocal(start);
+  } else if ( start >= young_bar )
+  { w->marked++;
+    recordMark(start);
+  }
+  ldomark(start);
+  mark_value(w, get_value(start) PASS_LD);
+}
+
+
+static void
+drain_marks(ARG1_LD)
+{ mark_worker *w = gc_marker;
+
+  if ( w )
+  { if ( w->stack && w->stack->next )
+      share_mark_chunks(w);
+    run_marker(w PASS_LD);
+    if ( w->in_session )
+    { while( steal_mark_chunk(w, TRUE) )
+	run_marker(w PASS_LD);
+      pthread_mutex_lock(&MPOOL->mutex);
+      while( MPOOL->joined > 0 )
+	pthread_cond_wait(&MPOOL->cond, &MPOOL->mutex);
+      w->marked      += MPOOL->marked;
+      w->relocations += MPOOL->relocations;
+      pthread_mutex_unlock(&MPOOL->mutex);
+      w->in_session = FALSE;
+    }
+
+    total_marked     += w->marked;
+    needs_relocation += w->relocations;
+    w->marked = w->relocations = 0;
+  }
+}
+
+#else /*O_PLMT*/
+
+#define drain_marks(ld) (void)0
+
+#endif /*O_PLMT*/
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 References from foreign code.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
@@ -1305,6 +1850,7 @@ clearUninitialisedVarsFrame(LocalFrame fr, Code PC)
 	case I_FREDO:
 	case S_TRUSTME:
 	case S_LIST:
+	case S_SWITCH:
 	  return;
 
 	case C_JMP:			/* jumps */
@@ -1427,6 +1973,12 @@ mergeTrailedAssignments(GCTrailEntry top, GCTrailEntry mark,
   for(te=mark; te <= top; te++)
   { Word p = val_ptr(te->address);
 
+    if ( p < young_bar )		/* see mark_old_roots() */
+    { if ( ttag(te[1].address) == TAG_TRAILVAL )
+	te++;
+      continue;
+    }
+
     if ( ttag(te[1].address) == TAG_TRAILVAL )
     { assignments--;
       if ( is_first(p) )
@@ -1485,13 +2037,16 @@ early_reset_vars(mark *m, Word top, GCTrailEntry te ARG_LD)
   int assignments = 0;
   Word gKeep = (LD->frozen_bar > m->globaltop ? LD->frozen_bar : m->globaltop);
 
+  drain_marks(PASS_LD1);		/* complete deferred marking */
   for( ; te >= tm; te-- )		/* early reset of vars */
   {
 #if O_DESTRUCTIVE_ASSIGNMENT
     if ( isTrailVal(te->address) )
     { Word tard = val_ptr(te[-1].address);
 
-      if ( tard >= top || (tard >= gKeep && tard < gMax) )
+      if ( tard < young_bar )		/* see mark_old_roots() */
+      { te--;
+      } else if ( tard >= top || (tard >= gKeep && tard < gMax) )
       { te->address = 0;
 	te--;
 	te->address = 0;
@@ -1510,6 +2065,7 @@ early_reset_vars(mark *m, Word top, GCTrailEntry te ARG_LD)
 			 print_val(*tard, b3)));
 
 	  mark_variable(gp PASS_LD);
+	  drain_marks(PASS_LD1);
 	  assert(is_marked(gp));
 	}
 
@@ -1538,7 +2094,9 @@ early_reset_vars(mark *m, Word top, GCTrailEntry te ARG_LD)
 #endif
     { Word tard = val_ptr(te->address);
 
-      if ( tard >= top )		/* above local stack */
+      if ( tard < young_bar )		/* see mark_old_roots() */
+      { continue;
+      } else if ( tard >= top )		/* above local stack */
       { DEBUG(CHK_SECURE, assert(ttag(te[1].address) != TAG_TRAILVAL));
 	te->address = 0;
 	trailcells_deleted++;
@@ -1857,6 +2415,7 @@ walk_and_mark(walk_state *state, Code PC, code end ARG_LD)
       case I_FEXITNDET:
       case S_TRUSTME:			/* Consider supervisor handling! */
       case S_LIST:
+      case S_SWITCH:
 	return PC-1;
       case S_NEXTCLAUSE:
 	mark_alt_clauses(state->frame, state->frame->clause->next PASS_LD);
@@ -1971,6 +2530,13 @@ walk_and_mark(walk_state *state, Code PC, code end ARG_LD)
 	mark_frame_var(state, PC[0] PASS_LD);
         mark_frame_var(state, PC[1] PASS_LD);
 	break;
+      case A_CMP_VV:
+	mark_frame_var(state, PC[1] PASS_LD);
+	mark_frame_var(state, PC[2] PASS_LD);
+	break;
+      case A_CMP_VC:
+	mark_frame_var(state, PC[1] PASS_LD);
+	break;
       case I_VAR:
       case I_NONVAR:
       case I_INTEGER:
@@ -2411,14 +2977,79 @@ cmp_address(const void *vp1, const void *vp2)
 #endif
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Generational collection (see "GENERATIONAL GC" below) only marks and
+compacts the global stack above young_bar.  Cells below it are old and
+are neither marked nor moved, except for one case: an old cell that got
+bound or assigned after the old generation was created.  LD->mark_bar is
+never below the old generation, so each such write has been trailed.  The trailed old cells are therefore
+the complete set of old-to-young references and we use them as roots.
+They are marked without being counted in total_marked and are unmarked
+again by sweep_trail().  The value cells of trailed assignments to old
+cells are roots as well.  Trail entries for old cells are never reset or
+merged early, which keeps them available to sweep_trail().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+mark_old_roots(ARG1_LD)
+{ GCTrailEntry te = (GCTrailEntry)tTop - 1;
+
+  for( ; te >= (GCTrailEntry)tBase; te-- )
+  { Word p;
+
+#ifdef O_DESTRUCTIVE_ASSIGNMENT
+    if ( ttag(te->address) == TAG_TRAILVAL )
+    { Word tard = val_ptr(te[-1].address);
+
+      if ( tard < young_bar )
+      { p = val_ptr(te->address);
+	if ( !is_marked(p) )
+	  mark_variable(p PASS_LD);
+      }
+      continue;
+    }
+#endif
+    if ( storage(te->address) == STG_GLOBAL &&
+	 (p = val_ptr(te->address)) < young_bar &&
+	 !is_marked(p) )
+      mark_variable(p PASS_LD);
+  }
+}
+
+
 static void
 mark_phase(vm_state *state)
 { GET_LD
+#ifdef O_PLMT
+  mark_worker w;
+  int secure = FALSE;
+#endif
   total_marked = 0;
 
   DEBUG(CHK_SECURE, check_marked("Before mark_term_refs()"));
+#ifdef O_PLMT
+  DEBUG(CHK_SECURE, secure = TRUE);
+  if ( MPOOL->threads > 0 && !secure &&
+       (char*)gTop - (char*)young_bar >= PARALLEL_MARK_MIN &&
+       acquire_mark_helpers(PASS_LD1) )
+  { memset(&w, 0, sizeof(w));
+    w.bottom    = young_bar;
+    w.may_share = TRUE;
+    gc_marker = &w;
+  }
+#endif
+  if ( young_bar > gBase )
+    mark_old_roots(PASS_LD1);
   mark_term_refs();
   mark_stacks(state);
+  drain_marks(PASS_LD1);
+#ifdef O_PLMT
+  if ( gc_marker )
+  { gc_marker = NULL;
+    free_mark_chunks(&w);
+    release_mark_helpers(PASS_LD1);
+  }
+#endif
 
   DEBUG(CHK_SECURE,
 	{ if ( !scan_global(TRUE) )
@@ -2503,6 +3134,10 @@ into_relocation_chain(Word current, int stg ARG_LD)
   word val = get_value(current);
 
   head = valPtr(val);			/* FIRST/MASK already gone */
+  if ( head < young_bar && head >= gBase )
+  { needs_relocation--;			/* old generation does not move */
+    return;
+  }
   set_value(current, get_value(head));
   set_value(head, consPtr(current, stg|tag(val)));
 
@@ -2736,6 +3371,9 @@ data.
 Note that initPrologStacks writes a dummy   marked cell below the global
 stack, so this routine needs not to check   for the bottom of the global
 stack. This almost doubles the performance of this critical routine.
+When collecting the young  generation  the  marked   bar  cell  below
+young_bar plays the same role and marks in the old generation are left
+untouched.
 
 (*) This function does a check for  the first non-garbage cell, which is
 a linear scan. If the are many   marks (choice-points and foreign marks)
@@ -2754,7 +3392,7 @@ sweep_global_mark(Word *m ARG_LD)
 
   DEBUG(CHK_SECURE, assert(onStack(local, m)));
   gm = *m;
-  if ( is_marked_or_first(gm-1) )
+  if ( gm <= young_bar || is_marked_or_first(gm-1) )
     goto done;				/* quit common easy case */
 
   for(;;)
@@ -2896,6 +3534,18 @@ Sweeping the local and trail stack to insert necessary pointers  in  the
 relocation chains.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+static void
+sweep_old_root(Word p ARG_LD)
+{ if ( p < young_bar && is_marked(p) )
+  { unmark(p);
+    if ( isGlobalRef(get_value(p)) )
+    { check_relocation(p);
+      into_relocation_chain(p, STG_GLOBAL PASS_LD);
+    }
+  }
+}
+
+
 static void
 sweep_trail(void)
 { GET_LD
@@ -2906,13 +3556,15 @@ sweep_trail(void)
     {
 #ifdef O_DESTRUCTIVE_ASSIGNMENT
       if ( ttag(te->address) == TAG_TRAILVAL )
-      { needsRelocation(&te->address);
+      { sweep_old_root(val_ptr(te->address) PASS_LD);
+	needsRelocation(&te->address);
 	check_relocation(&te->address);
 	into_relocation_chain(&te->address, STG_TRAIL PASS_LD);
       } else
 #endif
       if ( storage(te->address) == STG_GLOBAL )
-      { needsRelocation(&te->address);
+      { sweep_old_root(val_ptr(te->address) PASS_LD);
+	needsRelocation(&te->address);
 	check_relocation(&te->address);
 	into_relocation_chain(&te->address, STG_TRAIL PASS_LD);
       }
@@ -3141,7 +3793,7 @@ check_marked(const char *s)
   Word current;
   intptr_t cells = 0;
 
-  for( current = gBase; current < gTop; current += (offset_cell(current)+1) )
+  for( current = young_bar; current < gTop; current += (offset_cell(current)+1) )
   { cells++;
     if ( is_marked(current) )
     { m += (offset_cell(current)+1);
@@ -3216,7 +3868,7 @@ static void
 compact_global(void)
 { GET_LD
   Word dest, current;
-  Word base = gBase, top;
+  Word base = young_bar, top;
 #if O_DEBUG
   Word *v = mark_top;
 #endif
@@ -3265,7 +3917,9 @@ compact_global(void)
   }
 
   DEBUG(CHK_SECURE,
-	{ if ( v != mark_base )
+	{ while( v > mark_base && v[-1] < base )	/* old roots */
+	    v--;
+	  if ( v != mark_base )
 	  { for( v--; v >= mark_base; v-- )
 	    { Sdprintf("Expected marked cell at %p, (*= 0x%lx)\n", *v, **v);
 	    }
@@ -3274,8 +3928,8 @@ compact_global(void)
 	});
 
   if ( dest != base )
-    sysError("Mismatch in down phase: dest = %p, gBase = %p\n",
-	     dest, gBase);
+    sysError("Mismatch in down phase: dest = %p, base = %p\n",
+	     dest, base);
   if ( relocation_cells != relocated_cells )
   { DEBUG(CHK_SECURE, printNotRelocated());
     sysError("After down phase: relocation_cells = %ld; relocated_cells = %ld",
@@ -3288,7 +3942,7 @@ compact_global(void)
 
   dest = base;
   top = gTop;
-  for(current = gBase; current < top; )
+  for(current = base; current < top; )
   { if ( is_marked(current) )
     { intptr_t l, n;
 
@@ -3327,9 +3981,9 @@ compact_global(void)
     }
   }
 
-  if ( dest != gBase + total_marked )
-    sysError("Mismatch in up phase: dest = %p, gBase+total_marked = %p\n",
-	     dest, gBase + total_marked );
+  if ( dest != base + total_marked )
+    sysError("Mismatch in up phase: dest = %p, base+total_marked = %p\n",
+	     dest, base + total_marked );
 
   DEBUG(CHK_SECURE,
 	{ Word p = dest;		/* clear top of stack */
@@ -4152,6 +4806,105 @@ gcEnsureSpace(vm_state *state ARG_LD)
 }
 
 
+		 /*******************************
+		 *	  GENERATIONAL GC	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+If the global stack uses GC_GENERATIONAL_POLICY (see setGCPolicy()), the
+data that survived a collection is promoted to  the old generation.  The
+next collections only mark and compact  the  young region above it, such
+that large long-lived terms are not marked and moved over and over again.
+
+The old generation ends at gBase+LD->gc.young_offset.  This boundary is
+independent from LD->frozen_bar: backtracking  may  reset  gTop below it
+and Undo() then drops the old  generation (sets young_offset to 0).  As
+long as the old generation exists,  DiscardMark()   keeps  LD->mark_bar
+above it, so all bindings and  assignments   of  old cells are trailed.
+mark_old_roots() uses these trail entries as roots.  Below the young
+generation we keep one dummy cell (the `bar cell') that is marked during
+a young collection and stops the  downward scans of sweep_global_mark()
+and compact_global() the same way as the dummy cell below the global
+stack.
+
+This relies on all C code trailing writes to existing global cells, i.e.,
+using bindConst(), TrailAssignment() and  friends rather than assigning
+cells directly.  Foreign code that  writes   old  cells without trailing
+creates old-to-young references that are  not found by a young collection.
+The known untrailed writers are handled as follows:
+
+  - freezeGlobal() (nb_setval/2, nb_setarg/3, etc.) drops the old
+    generation, so the next collection is a full one.
+  - the VM in write mode, see building_term() below.
+
+We also fall back to a full collection if
+
+  - there is no old generation (see above)
+  - GC was explicitly requested (GC_USER)
+  - the old generation grew more than  `factor' times the size of the
+    global stack after the last full collection.
+
+We do not promote if the collection was  triggered while the VM is in
+the middle of building a term (in write mode).  The VM fills the
+remaining arguments of such a term  without  trailing, which would
+create untracked old-to-young references.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static Word
+young_generation(gc_reason_t reason ARG_LD)
+{ Stack s = (Stack)&LD->stacks.global;
+  size_t old;
+
+  if ( !(s->policy & GC_GENERATIONAL_POLICY) ||
+       !LD->gc.young_offset ||
+       (reason & GC_USER) )
+    return gBase;
+
+  old = LD->gc.young_offset * sizeof(word);
+  if ( old > s->factor*LD->gc.full_size + s->small )
+    return gBase;
+
+  return gBase + LD->gc.young_offset;
+}
+
+
+static int
+building_term(vm_state *state ARG_LD)
+{ if ( state->save_argp )
+  { Word *ap;
+
+    if ( onGlobal(LD->query->registers.argp) )
+      return TRUE;
+    for(ap=aBase; ap<aTop; ap++)
+    { if ( onGlobal(*ap) )
+	return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+
+static void
+promote_young_generation(vm_state *state, int full ARG_LD)
+{ if ( building_term(state PASS_LD) )
+  { if ( full )				/* see above */
+      LD->gc.young_offset = 0;
+  } else if ( (LD->stacks.global.policy & GC_GENERATIONAL_POLICY) &&
+	      gTop+2 < gMax )
+  { setVar(*gTop);			/* the bar cell */
+    gTop++;
+    if ( LD->mark_bar != NO_MARK_BAR && LD->mark_bar < gTop )
+      LD->mark_bar = gTop;
+    LD->gc.young_offset = gTop - gBase;
+    if ( full )
+      LD->gc.full_size = usedStack(global);
+  } else
+  { LD->gc.young_offset = 0;
+  }
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 garbageCollect() returns one of TRUE (ok),   FALSE (blocked or exception
 in printMessage()) or *_OVERFLOW if the   local  stack cannot accomodate
@@ -4192,6 +4945,7 @@ garbageCollect(gc_reason_t reason)
   struct call_node *prof_node = NULL;
 #endif
   gc_stat *stats;
+  double wall0;
 
   END_PROF();
   START_PROF(P_GC, "P_GC");
@@ -4200,6 +4954,7 @@ garbageCollect(gc_reason_t reason)
     return FALSE;
 
   gc_stat_start(&LD->gc.stats, reason PASS_LD);
+  wall0 = WallTime();
 
   assert(LD->fast_condition == NULL);
 
@@ -4269,6 +5024,12 @@ garbageCollect(gc_reason_t reason)
   setVar(*gTop);	/* always one space; see initPrologStacks() */
   tTop->address = 0;	/* gMax-- and tMax-- */
 
+  young_bar = young_generation(reason PASS_LD);
+  if ( young_bar > gBase )
+    ldomark(young_bar-1);		/* the bar cell */
+  if ( verbose && young_bar > gBase )
+    Sdprintf("(young) ");
+
   attvars = link_attvars(PASS_LD1);
   astack = argument_stack_to_term_refs(&state);
   gvars = gvars_to_term_refs(&saved_bar_at);
@@ -4288,6 +5049,15 @@ garbageCollect(gc_reason_t reason)
   term_refs_to_argument_stack(&state, astack);
   restore_attvars(attvars PASS_LD);
 
+  if ( young_bar > gBase )
+  { unmark(young_bar-1);
+    LD->gc.stats.totals.young_collections++;
+    promote_young_generation(&state, FALSE PASS_LD);
+  } else
+  { promote_young_generation(&state, TRUE PASS_LD);
+  }
+  young_bar = gBase;
+
   assert(LD->mark_bar <= gTop);
 
   DEBUG(CHK_SECURE,
@@ -4329,6 +5099,7 @@ garbageCollect(gc_reason_t reason)
   leaveGC(PASS_LD1);
 
   stats = gc_stat_end(&LD->gc.stats PASS_LD);
+  record_pause(gc_pause_kind(stats->reason), WallTime()-wall0 PASS_LD);
 
   if ( verbose )
     Sdprintf("gained (g+t) %zd+%zd in %.3f sec; used %zd+%zd; free %zd+%zd\n",
@@ -5111,6 +5882,7 @@ grow_stacks(size_t l, size_t g, size_t t ARG_LD)
     Word gb = gBase;
     LocalFrame lb = lBase;
     double time, time0 = ThreadCPUTime(LD, CPU_USER);
+    double wall0 = WallTime();
     int verbose = truePrologFlag(PLFLAG_TRACE_GC);
 
     DEBUG(MSG_SHIFT, verbose = TRUE);
@@ -5225,6 +5997,7 @@ grow_stacks(size_t l, size_t g, size_t t ARG_LD)
 
     time = ThreadCPUTime(LD, CPU_USER) - time0;
     LD->shift_status.time += time;
+    record_pause(PL_PAUSE_SHIFT, WallTime()-wall0 PASS_LD);
     DEBUG(CHK_SECURE,
 	  { gBase++;
 	    if ( checkStacks(&state) != key )
@@ -5528,30 +6301,104 @@ is_pointer_like(void *ptr)
 behind the official top of the stack   as frames are never written above
 lTop. If anything is added, it will  be   at  a  newer generation, so we
 don't care.
+
+Scanning the local stacks of  all  threads   is  the  dominant cost of
+clause GC if there are many threads.   Most  of these threads are often
+blocked, waiting for a message  or   I/O.  Therefore,  each thread keeps
+the result of the last scan of its stack in ld->clauses.cgc_cache as the
+oldest generation for each dirty predicate   that  was found. The cache
+remains valid as long as
+
+  - the thread did not create any frame after the scan started.  This
+    is tracked by ld->clauses.generation_frames, which is incremented
+    by setGenerationFrame().  Frames that are discarded only make the
+    cache more conservative.
+  - no predicate was added to the dirty predicates.  This is tracked by
+    GD->clauses.dirty_epoch.
+  - the thread did not reference more than CGC_CACHED_MARKS dirty
+    predicates.
+
+If the cache is valid we replay it   rather  than scanning the stack. The
+references pushed by  pushPredicateAccess()  are   always  marked as they
+are cheap to find.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+static void
+cacheMarkedPredicate(PL_local_data_t *ld, int *countp,
+		     Definition def, gen_t gen)
+{ definition_ref *m = ld->clauses.cgc_cache.marks;
+  int i, count = *countp;
+
+  if ( count < 0 )
+    return;
+
+  for(i=0; i<count; i++)
+  { if ( m[i].predicate == def )
+    { if ( gen < m[i].generation )
+	m[i].generation = gen;
+      return;
+    }
+  }
+
+  if ( count < CGC_CACHED_MARKS )
+  { m[count].predicate  = def;
+    m[count].generation = gen;
+    *countp = count+1;
+  } else
+  { *countp = -1;
+  }
+}
+
+
+static int
+validCGCCache(PL_local_data_t *ld, int64_t frames, size_t epoch)
+{ return ( ld->clauses.cgc_cache.count >= 0 &&
+	   ld->clauses.cgc_cache.generation_frames == frames &&
+	   ld->clauses.cgc_cache.dirty_epoch == epoch );
+}
+
+
 void
 markPredicatesInEnvironments(PL_local_data_t *ld)
 { GET_LD
   Word lbase, lend, current;
+  int64_t frames = ld->clauses.generation_frames;
+  size_t  epoch  = GD->clauses.dirty_epoch;
 
-  lbase = (Word)ld->stacks.local.base;
-  lend  = (Word)ld->stacks.local.top;		/* see (*) */
-  for(current = lbase; current < lend; current++ )
-  { LocalFrame fr = (LocalFrame)current;
+  if ( validCGCCache(ld, frames, epoch) )
+  { definition_ref *m = ld->clauses.cgc_cache.marks;
+    int i;
 
-    if ( isFrame(fr) )
-    { DirtyDefInfo ddi;
-      Definition def = fr->predicate;
+    for(i=0; i<ld->clauses.cgc_cache.count; i++)
+      cgcActivatePredicate__LD(m[i].predicate, m[i].generation PASS_LD);
+    GD->clauses.cgc_scans_skipped++;
+  } else
+  { int count = 0;
 
-      if ( is_pointer_like(def) &&
-	   (ddi=lookupHTable(GD->procedures.dirty, def)) )
-      { gen_t gen = generationFrame(fr);
+    lbase = (Word)ld->stacks.local.base;
+    lend  = (Word)ld->stacks.local.top;		/* see (*) */
+    for(current = lbase; current < lend; current++ )
+    { LocalFrame fr = (LocalFrame)current;
 
-	if ( gen < ddi->oldest_generation )
-	  set_min_generation(ddi, gen);
+      if ( isFrame(fr) )
+      { DirtyDefInfo ddi;
+	Definition def = fr->predicate;
+
+	if ( is_pointer_like(def) &&
+	     (ddi=lookupHTable(GD->procedures.dirty, def)) )
+	{ gen_t gen = generationFrame(fr);
+
+	  if ( gen < ddi->oldest_generation )
+	    set_min_generation(ddi, gen);
+	  cacheMarkedPredicate(ld, &count, def, gen);
+	}
       }
     }
+
+    ld->clauses.cgc_cache.count             = count;
+    ld->clauses.cgc_cache.generation_frames = frames;
+    ld->clauses.cgc_cache.dirty_epoch       = epoch;
+    GD->clauses.cgc_scans++;
   }
 
   ld->clauses.erased_skipped = 0;
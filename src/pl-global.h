@@ -58,6 +58,7 @@ typedef struct
 #if VMCODE_IS_ADDRESS
   unsigned char   *_dewam_table;	/* decoding table */
   intptr_t	  _dewam_table_offset;	/* offset of 1st */
+  void  **_interpreter_super_jmp_table; /* superinstructions (O_SUPERVMI) */
   void  **_interpreter_jmp_table;	/* interpreters table */
 					/* must be last! (why?) */
   code    _wam_table[I_HIGHEST];	/* code --> address */
@@ -311,6 +312,9 @@ struct PL_global_data
     int		cgc_active;		/* CGC is running */
     int64_t	cgc_count;		/* # clause GC calls */
     int64_t	cgc_reclaimed;		/* # clauses reclaimed */
+    int64_t	cgc_scans;		/* # thread stacks scanned */
+    int64_t	cgc_scans_skipped;	/* # scans replaced by cached marks */
+    size_t	dirty_epoch;		/* # registered dirty predicates */
     double	cgc_time;		/* Total time spent in CGC */
     size_t	erased;			/* # erased pending clauses */
     size_t	erased_size;		/* memory used by them */
@@ -359,7 +363,52 @@ struct PL_global_data
     struct
     { pthread_mutex_t	mutex;
       pthread_cond_t	cond;
+      pthread_cond_t	builder_cond;	/* Signals the index builder */
+      struct index_job *jobs;		/* Indexes to build in the background */
+      int64_t		bg_threshold;	/* Min #clauses for background build */
     } index;
+    struct
+    { pthread_mutex_t	mutex;
+      pthread_cond_t	cond;
+      struct mark_chunk *chunks;	/* Shared work for parallel marking */
+      struct PL_local_data *ld;		/* Engine being collected */
+      Word		bottom;		/* Bottom of the collected region */
+      int		threads;	/* Max helpers (gc_mark_threads flag) */
+      int		running;	/* # started helper threads */
+      int		owned;		/* A GC is using the helpers */
+      int		session;	/* Id of the current session */
+      int		done;		/* Current session is completed */
+      int		active;		/* # markers that have work */
+      int		waiting;	/* # markers waiting for work */
+      int		joined;		/* # helpers in current session */
+      intptr_t		marked;		/* # cells marked by helpers */
+      intptr_t		relocations;	/* # relocations found by helpers */
+    } mark;
+    struct
+    { pthread_mutex_t	mutex;
+      pthread_cond_t	cond;
+      struct qlf_section *queue;	/* QLF sections to decode */
+      struct qlf_section *queue_tail;	/* Last of queue */
+      int		threads;	/* Max helpers (qlf_load_threads flag) */
+      int		running;	/* # started helper threads */
+    } qlf;
+    struct
+    { pthread_mutex_t	mutex;
+      pthread_cond_t	cond;
+      struct task_worker **workers;	/* Task scheduler workers */
+      int		count;		/* # workers in the pool */
+      int		threads;	/* Pool size (task_threads flag) */
+      unsigned int	next;		/* Round-robin for outside submits */
+      int		idle;		/* # threads waiting for tasks */
+      int		queued;		/* # tasks in the deques */
+      struct task_worker *solvers;	/* Workers for first_solution/3 */
+      int		solver_count;	/* # created solver workers */
+    } tasks;
+    struct
+    { struct PL_local_data *free;	/* Recycled engines (engine pool) */
+      int		count;		/* # engines in the pool */
+      int		max;		/* Max size (engine_pool_size flag) */
+    } engines;
   } thread;
 #endif /*O_PLMT*/
 
@@ -483,6 +532,7 @@ struct PL_local_data
     double	last_walltime;		/* Last Wall time (m-secs since start) */
     double	user_cputime;		/* User saved CPU time */
     double	system_cputime;		/* Kernel saved CPU time */
+    pl_pause_histogram_t pauses[PL_PAUSE_KINDS]; /* Pause time histograms */
   } statistics;
 
 #ifdef O_GMP
@@ -526,6 +576,7 @@ struct PL_local_data
   { VarDef *	vardefs;		/* compiler variable analysis */
     int		nvardefs;
     int		filledVars;
+    InlineRef	inline_pending;		/* See inlinedPredicateModified() */
   } comp;
 
   struct
@@ -646,6 +697,7 @@ struct PL_local_data
     struct _at_exit_goal *exit_goals;	/* thread_at_exit/1 goals */
     DefinitionChain local_definitions;	/* P_THREAD_LOCAL predicates */
     simpleMutex scan_lock;		/* Hold for asynchronous scans */
+    struct task_worker *task_worker;	/* We are a task scheduler worker */
   } thread;
 #endif
 
@@ -658,6 +710,13 @@ struct PL_local_data
   struct
   { size_t	erased_skipped;		/* # erased clauses skipped */
     int64_t	cgc_inferences;		/* Inferences at last cgc consider */
+    int64_t	generation_frames;	/* # frames that got a generation */
+    struct
+    { int64_t	generation_frames;	/* generation_frames at last scan */
+      size_t	dirty_epoch;		/* GD dirty_epoch at last scan */
+      int	count;			/* # valid marks */
+      definition_ref marks[CGC_CACHED_MARKS]; /* Oldest gen per predicate */
+    } cgc_cache;			/* See markPredicatesInEnvironments() */
   } clauses;
 
   struct
@@ -682,6 +741,10 @@ struct PL_local_data
 #endif
     int active;				/* GC is running in this thread */
     gc_stats stats;			/* GC performance history */
+    Word _young_bar;			/* Bottom of region being collected */
+    size_t young_offset;		/* Young generation start (words) or 0 */
+    size_t full_size;			/* Global stack after last full GC */
+    struct mark_worker *_mark_worker;	/* Parallel marking (see pl-gc.c) */
 
 					/* These must be at the end to be */
 					/* able to define O_DEBUG in only */
@@ -740,6 +803,7 @@ GLOBAL PL_local_data_t *PL_current_engine_ptr;
 #define dewam_table_offset	(CD->_dewam_table_offset)
 #define wam_table		(CD->_wam_table)
 #define interpreter_jmp_table	(CD->_interpreter_jmp_table)
+#define interpreter_super_jmp_table (CD->_interpreter_super_jmp_table)
 #endif /*VMCODE_IS_ADDRESS*/
 
 #endif /*PL_GLOBAL_H_INCLUDED*/
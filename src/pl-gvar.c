@@ -45,6 +45,7 @@
 void
 freezeGlobal(ARG1_LD)
 { LD->frozen_bar = LD->mark_bar = gTop;
+  LD->gc.young_offset = 0;		/* see young_generation() */
   DEBUG(2, Sdprintf("*** frozen bar to %p at freezeGlobal()\n",
 		    LD->frozen_bar));
 }
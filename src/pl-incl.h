@@ -123,6 +123,10 @@ handy for it someone wants to add a data type to the system.
       compiled Prolog  code  rather than the  virtual-machine numbers.
       This speeds-up  the vm  instruction dispatching in  interpret().
       See also pl-comp.c
+  O_SUPERVMI
+      Can only be set when VMCODE_IS_ADDRESS is set.  Executes the
+      instruction sequences listed in SUPERVMI without dispatching
+      between the instructions.  See mkvmi.c and pl-comp.c.
   O_LOGICAL_UPDATE
       Use `logical' update-view for dynamic predicates rather then the
       `immediate' update-view of older Prolog systems.
@@ -222,6 +226,10 @@ The ia64 says setjmp()/longjmp() buffer must be aligned at 128 bits
 #define VMCODE_IS_ADDRESS	1
 #endif
 
+#if VMCODE_IS_ADDRESS && !COUNTING && !defined(O_SUPERVMI)
+#define O_SUPERVMI		1
+#endif
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Runtime version.  Uses somewhat less memory and has no tracer.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
@@ -674,10 +682,12 @@ typedef struct functorDef *	FunctorDef;	/* name/arity pair */
 typedef struct procedure *	Procedure;	/* predicate */
 typedef struct definition *	Definition;	/* predicate definition */
 typedef struct definition_chain *DefinitionChain; /* linked list of defs */
+typedef struct inline_ref *	InlineRef;	/* see inlineProcedure() */
 typedef struct clause *		Clause;		/* compiled clause */
 typedef struct clause_ref *	ClauseRef;      /* reference to a clause */
 typedef struct clause_index *	ClauseIndex;    /* Clause indexing table */
 typedef struct clause_bucket *	ClauseBucket;   /* Bucked in clause-index table */
+typedef struct range_index *	RangeIndex;	/* Sorted index on an argument */
 typedef struct operator *	Operator;	/* see pl-op.c, pl-read.c */
 typedef struct record *		Record;		/* recorda/3, etc. */
 typedef struct recordRef *	RecordRef;      /* reference to a record */
@@ -836,6 +846,7 @@ with one operation, it turns out to be faster as well.
 
 /* Flags on predicates (packed in unsigned int */
 
+#define P_LEAF			(0x00000001) /* Foreign: called from I_CALL */
 #define P_CLAUSABLE		(0x00000002) /* Clause/2 always works */
 #define P_QUASI_QUOTATION_SYNTAX (0x00000004) /* {|Type||Quasi Quote|} */
 #define P_NON_TERMINAL		(0x00000008) /* Grammar rule (Name//Arity) */
@@ -1017,6 +1028,7 @@ typedef struct ggen_t
 #else /*O_LOGICAL_UPDATE*/
 #define global_generation()	 (0)
 #define next_global_generation() (0)
+#define next_global_generation_unlocked() (0)
 #endif /*O_LOGICAL_UPDATE*/
 
 #define setGenerationFrame(fr) setGenerationFrame__LD((fr) PASS_LD)
@@ -1261,6 +1273,10 @@ typedef struct arg_info
   unsigned	ln_buckets : 5;		/* lg2(bucket count) */
   unsigned	assessed   : 1;		/* Value was assessed */
   unsigned	meta	   : 4;		/* Meta-argument info */
+  unsigned	dict_assessed : 1;	/* Dict keys were assessed */
+  unsigned	dict_ln_buckets : 5;	/* lg2(bucket count) for dict_key */
+  float		dict_speedup;		/* Speedup indexing on dict_key */
+  word		dict_key;		/* Best key for dict arguments */
 } arg_info;
 
 typedef struct impl_any
@@ -1337,6 +1353,7 @@ typedef struct gc_stats
   gc_reason_t	request;		/* Requesting stack */
   struct
   { int64_t	collections;
+    int64_t	young_collections;	/* collections of the young region */
     int64_t	global_gained;		/* global stack bytes collected */
     int64_t	trail_gained;		/* trail stack bytes collected */
     double	time;			/* time spent in collections */
@@ -1386,6 +1403,13 @@ typedef struct
   char		argtype[4];	/* Argument type(s) code takes */
 } code_info;
 
+#define MAX_SUPER_VMI 4		/* Max length of a superinstruction */
+
+typedef struct
+{ int		length;		/* # instructions */
+  vmi		codes[MAX_SUPER_VMI]; /* The sequence */
+} vmi_super;
+
 struct mark
 { TrailEntry	trailtop;	/* top of the trail stack */
   Word		globaltop;	/* top of the global stack */
@@ -1420,6 +1444,7 @@ struct clause_index
   unsigned	 incomplete : 1;	/* Index is incomplete */
   iarg_t	 args[MAX_MULTI_INDEX];	/* Indexed arguments */
   iarg_t	 position[MAXINDEXDEPTH+1]; /* Deep index position */
+  word		 dict_key;		/* Index on value of this dict key */
   float		 speedup;		/* Estimated speedup */
   ClauseBucket	 entries;		/* chains holding the clauses */
 };
@@ -1445,6 +1470,10 @@ struct definition
   unsigned int  shared;			/* #procedures sharing this def */
   struct linger_list  *lingering;	/* Assocated lingering objects */
   gen_t		last_modified;		/* Generation I was last modified */
+  RangeIndex	range_indexes;		/* Sorted indexes (pl-index.c) */
+  int		unlocked_writers;	/* # unlocked assertz/retract (<0: blocked) */
+  InlineRef	inlined_by;		/* Predicates that inlined me */
+  struct qlf_lazy *lazy;		/* Clauses not yet loaded (pl-wic.c) */
 #ifdef O_PROF_PENTIUM
   int		prof_index;		/* index in profiling */
   char	       *prof_name;		/* name in profiling */
@@ -1456,6 +1485,12 @@ struct definition_chain
   DefinitionChain	next;		/* next in chain */
 };
 
+struct inline_ref
+{ atom_t		module;		/* Module of the caller */
+  functor_t		functor;	/* Name/arity of the caller */
+  InlineRef		next;		/* next in chain */
+};
+
 struct dirty_def_info
 { gen_t		oldest_generation;	/* Oldest generation seen */
 };
@@ -1465,6 +1500,8 @@ typedef struct definition_ref
   gen_t	     generation;		/* at generation */
 } definition_ref;
 
+#define CGC_CACHED_MARKS 16		/* See markPredicatesInEnvironments() */
+
 typedef struct definition_refs
 { definition_ref *blocks[MAX_BLOCKS];
   definition_ref preallocated[7];
@@ -1820,6 +1857,9 @@ struct gc_trail_entry
 			     tTop = tt; \
 			     gTop = (LD->frozen_bar > (b).globaltop ? \
 			             LD->frozen_bar : (b).globaltop); \
+			     if ( LD->gc.young_offset && \
+				  gTop < gBase + LD->gc.young_offset ) \
+			       LD->gc.young_offset = 0; \
 			    } while(0)
 #endif /*O_DESTRUCTIVE_ASSIGNMENT*/
 
@@ -1837,6 +1877,9 @@ struct gc_trail_entry
 			   } while(0)
 #define DiscardMark(b)	do { LD->mark_bar = (LD->frozen_bar > (b).saved_bar ? \
 					     LD->frozen_bar : (b).saved_bar); \
+			     if ( LD->gc.young_offset && \
+				  LD->mark_bar < gBase + LD->gc.young_offset ) \
+			       LD->mark_bar = gBase + LD->gc.young_offset; \
 			     DEBUG(CHK_SECURE, \
 				   assert(LD->mark_bar == NO_MARK_BAR || \
 					  (LD->mark_bar >= gBase && \
@@ -1958,6 +2001,10 @@ typedef struct
 #define SIG_CLAUSE_GC	  (SIG_PROLOG_OFFSET+3)
 #define SIG_PLABORT	  (SIG_PROLOG_OFFSET+4)
 #define SIG_TUNE_GC	  (SIG_PROLOG_OFFSET+5)
+#define SIG_INLINE	  (SIG_PROLOG_OFFSET+6)
+#ifdef O_PLMT
+#define SIG_TASK_CANCEL	  (SIG_PROLOG_OFFSET+7)
+#endif
 
 
 		 /*******************************
@@ -2007,6 +2054,7 @@ this to enlarge the runtime stacks.  Otherwise use the stack-shifter.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 #define GC_FAST_POLICY 0x1		/* not really used yet */
+#define GC_GENERATIONAL_POLICY 0x2	/* Mostly collect the young region */
 
 #define STACK(type) \
 	{ type		base;		/* base address of the stack */     \
@@ -2269,6 +2317,7 @@ typedef struct
 #define PROCEDURE_tune_gc3		(GD->procedures.tune_gc3)
 
 extern const code_info codeTable[]; /* Instruction info (read-only) */
+extern const vmi_super superTable[]; /* Superinstructions (read-only) */
 
 		 /*******************************
 		 *	  TEXT PROCESSING	*
@@ -2381,6 +2430,8 @@ typedef struct debuginfo
 #define PLFLAG_ERROR_AMBIGUOUS_STREAM_PAIR 0x04000000
 #define PLFLAG_GCTHREAD		    0x08000000 /* Do atom/clause GC in a thread */
 #define PLFLAG_MITIGATE_SPECTRE	    0x10000000 /* Mitigate spectre attacks */
+#define PLFLAG_GC_GENERATIONAL	    0x20000000 /* Generational stack GC */
+#define PLFLAG_OPTIMISE_INLINE	    0x40000000 /* Inline small predicates */
 
 typedef struct
 { unsigned int flags;		/* Fast access to some boolean Prolog flags */
@@ -35,6 +35,7 @@
 
 #include "pl-incl.h"
 #include "pl-rsort.h"
+#include "pl-dict.h"
 #include <math.h>
 
 		 /*******************************
@@ -52,11 +53,15 @@
   - MAX_VAR_FRAC
     Do not create an index if the fraction of clauses with a variable
     in the target position exceeds this threshold.
+  - MAX_DICT_ASSESS
+    Maximum number of keys of a dict argument we assess for creating
+    an index on the value of a dict key.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 #define MAX_LOOKAHEAD  100
 #define MIN_SPEEDUP    1.5
 #define MAX_VAR_FRAC   0.1
+#define MAX_DICT_ASSESS 8
 
 
 		 /*******************************
@@ -71,6 +76,7 @@ typedef struct hash_hints
   float		speedup;		/* Expected speedup */
   unsigned int	ln_buckets;		/* Lg2 of #buckets to use */
   unsigned	list : 1;		/* Use a list per key */
+  word		dict_key;		/* Index on value of this dict key */
 } hash_hints;
 
 typedef struct index_context
@@ -85,6 +91,8 @@ static int	bestHash(Word av, size_t ac, ClauseList clist, float min_speedup,
 			 hash_hints *hints, IndexContext ctx ARG_LD);
 static ClauseIndex hashDefinition(ClauseList clist, hash_hints *h,
 				  IndexContext ctx);
+static ClauseIndex buildIndex(ClauseList clist, hash_hints *h,
+			      IndexContext ctx);
 static void	replaceIndex(Definition def, ClauseList cl,
 			     ClauseIndex *cip, ClauseIndex ci);
 static void	deleteIndexP(Definition def, ClauseList cl, ClauseIndex *cip);
@@ -104,6 +112,9 @@ static Code	skipToTerm(Clause clause, const iarg_t *position);
 static void	unalloc_index_array(void *p);
 static void	wait_for_index(const ClauseIndex ci);
 static void	completed_index(ClauseIndex ci);
+static void	addClauseToRangeIndexes(Definition def, Clause cl,
+					ClauseRef where);
+static void	cleanRangeIndexes(Definition def, gen_t active);
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Compute the index in the hash-array from   a machine word and the number
@@ -352,9 +363,38 @@ murmur_key(void *ptr, size_t n)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Dict key indexes index  the  value  of  a   named  key  of  a  dict
+argument. As dicts with a different key set have a different functor,
+the normal (deep) indexes cannot  deal   with  them.  Clauses for which
+the argument is a dict without the key   or  some other nonvar term can
+never unify with a dict that has the key.  These use DICT_NOKEY, which
+only causes a useless unification attempt if the value is the atom
+`dict`.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define DICT_NOKEY ATOM_dict
+
+static word
+dictIndexKeyFromArgv(ClauseIndex ci, Word argv ARG_LD)
+{ Word p = argv+ci->args[0]-1;
+  Word vp;
+
+  deRef(p);
+  if ( isTerm(*p) && termIsDict(*p) &&
+       (vp=dict_lookup_ptr(*p, ci->dict_key PASS_LD)) )
+    return indexOfWord(*vp PASS_LD);
+
+  return 0;
+}
+
+
 static inline word
 indexKeyFromArgv(ClauseIndex ci, Word argv ARG_LD)
-{ if ( likely(ci->args[1] == 0) )
+{ if ( unlikely(ci->dict_key != 0) )
+    return dictIndexKeyFromArgv(ci, argv PASS_LD);
+
+  if ( likely(ci->args[1] == 0) )
   { return indexOfWord(argv[ci->args[0]-1] PASS_LD);
   } else
   { word key[MAX_MULTI_INDEX];
@@ -399,6 +439,12 @@ iargsName(const iarg_t args[MAX_MULTI_INDEX], char *buf)
 firstClause() finds the first applicable   clause  and leave information
 for finding the next clause in chp.
 
+Indexes that are still being built  (`incomplete`)   are  ignored. If no
+other index applies we  use  the   first  argument  or a linear scan.
+This avoids blocking all threads that call   a  large predicate while an
+index is being created, either by another   thread or in the background
+by the index builder thread (see buildIndex()).
+
 TBD:
   - non-indexable predicates must use a different supervisor
   - Predicates needing reindexing should use a different supervisor
@@ -421,7 +467,6 @@ first_clause_guarded(Word argv, size_t argc, ClauseList clist,
   if ( unlikely(argc > MAXINDEXARG) )
     argc = MAXINDEXARG;
 
-retry:
   if ( (cip=clist->clause_indexes) )
   { ClauseIndex best_index = NULL;
 
@@ -429,7 +474,7 @@ retry:
     { ClauseIndex ci = *cip;
       word k;
 
-      if ( ISDEADCI(ci) )
+      if ( ISDEADCI(ci) || ci->incomplete )
 	continue;
 
       if ( (k=indexKeyFromArgv(ci, argv PASS_LD)) )
@@ -458,7 +503,7 @@ retry:
 				  PL_thread_self(),
 				  iargsName(hints.args, NULL)));
 
-	  if ( (ci=hashDefinition(clist, &hints, ctx)) )
+	  if ( (ci=buildIndex(clist, &hints, ctx)) && !ci->incomplete )
 	  { chp->key = indexKeyFromArgv(ci, argv PASS_LD);
 	    assert(chp->key);
 	    best_index = ci;
@@ -466,11 +511,6 @@ retry:
 	}
       }
 
-      if ( best_index->incomplete )
-      { wait_for_index(best_index);
-	goto retry;
-      }
-
       hi = hashIndex(chp->key, best_index->buckets);
       chp->cref = best_index->entries[hi].head;
       return nextClauseFromBucket(best_index, argv, ctx PASS_LD);
@@ -497,12 +537,9 @@ retry:
        bestHash(argv, argc, clist, 0.0, &hints, ctx PASS_LD) )
   { ClauseIndex ci;
 
-    if ( (ci=hashDefinition(clist, &hints, ctx)) )
+    if ( (ci=buildIndex(clist, &hints, ctx)) && !ci->incomplete )
     { int hi;
 
-      while ( ci->incomplete )
-	wait_for_index(ci);
-
       chp->key = indexKeyFromArgv(ci, argv PASS_LD);
       assert(chp->key);
       hi = hashIndex(chp->key, ci->buckets);
@@ -624,6 +661,13 @@ copytpos(iarg_t *to, const iarg_t *from)
 }
 
 
+static inline int
+sameIndex(ClauseIndex ci, const iarg_t *args, word dict_key)
+{ return ( memcmp(ci->args, args, sizeof(ci->args)) == 0 &&
+	   ci->dict_key == dict_key );
+}
+
+
 static ClauseIndex
 newClauseIndexTable(iarg_t *hap, hash_hints *hints, IndexContext ctx)
 { ClauseIndex ci = allocHeapOrHalt(sizeof(struct clause_index));
@@ -639,6 +683,7 @@ newClauseIndexTable(iarg_t *hap, hash_hints *hints, IndexContext ctx)
   ci->is_list	 = hints->list;
   ci->incomplete = TRUE;
   ci->speedup	 = hints->speedup;
+  ci->dict_key	 = hints->dict_key;
   ci->entries	 = allocHeapOrHalt(bytes);
   copytpos(ci->position, ctx->position);
 
@@ -1172,6 +1217,9 @@ cleanClauseIndexes(Definition def, ClauseList cl, gen_t active)
       cleanClauseIndex(def, cl, ci, active);
     }
   }
+
+  if ( def->range_indexes && cl == &def->impl.clauses )
+    cleanRangeIndexes(def, active);
 }
 
 
@@ -1184,6 +1232,7 @@ clearTriedIndexes(Definition def)
   { arg_info *ainfo = &def->impl.clauses.args[i];
 
     ainfo->assessed = FALSE;
+    ainfo->dict_assessed = FALSE;
   }
 
   def->impl.clauses.jiti_tried = 0;
@@ -1221,6 +1270,18 @@ reconsider_index(Definition def)
 }
 
 
+/* reconsiderIndexes() is called after an unlocked assertz/1 that made
+   the number of clauses a power of two.  See assertProcedure().
+*/
+
+void
+reconsiderIndexes(Definition def)
+{ LOCKDEF(def);
+  reconsider_index(def);
+  UNLOCKDEF(def);
+}
+
+
 static void
 shrunkpow2(Definition def)
 { if ( true(def, P_DYNAMIC) )
@@ -1285,10 +1346,63 @@ deleteActiveClauseFromBucket(ClauseBucket cb, word key)
 }
 
 
+/* dictIndexKeyFromCode() finds the key for the value of `name` in
+   the head code for a dict at PC.  Returns 0 if the value is a variable.
+   The tag and values may be compiled into H_VOID_N.
+*/
+
+static word
+dictIndexKeyFromCode(Code PC, word name)
+{ word key;
+  Code vpc = NULL;
+  size_t an, arity;
+
+  if ( !argKey(PC, 0, &key) )
+    return 0;
+  if ( !isFunctor(key) ||
+       nameFunctor(key) != ATOM_dict || arityFunctor(key)%2 != 1 )
+    return DICT_NOKEY;
+
+  arity = arityFunctor(key);
+  for(PC = stepPC(PC), an = 0; an < arity; )
+  { if ( decode(*PC) == H_VOID_N )
+    { an += (size_t)PC[1];
+      vpc = NULL;
+      PC = stepPC(PC);
+      continue;
+    }
+
+    if ( an%2 == 1 )			/* value */
+    { vpc = PC;
+    } else if ( an > 0 )		/* key */
+    { word k;
+
+      if ( argKey(PC, 0, &k) && k == name )
+	return vpc && argKey(vpc, 0, &key) ? key : 0;
+    }
+
+    PC = skipArgs(PC, 1);
+    an++;
+  }
+
+  return DICT_NOKEY;
+}
+
+
 static inline word
 indexKeyFromClause(ClauseIndex ci, Clause cl, Code *end)
 { Code PC = skipToTerm(cl, ci->position);
 
+  if ( unlikely(ci->dict_key != 0) )
+  { int arg = ci->args[0] - 1;
+
+    if ( arg > 0 )
+      PC = skipArgs(PC, arg);
+    if ( end )
+      *end = PC;
+    return dictIndexKeyFromCode(PC, ci->dict_key);
+  }
+
   if ( likely(ci->args[1] == 0) )
   { int arg = ci->args[0] - 1;
     word key;
@@ -1485,6 +1599,8 @@ the definition locked.
 int
 addClauseToIndexes(Definition def, Clause clause, ClauseRef where)
 { addClauseToListIndexes(def, &def->impl.clauses, clause, where);
+  if ( def->range_indexes )
+    addClauseToRangeIndexes(def, clause, where);
   reconsider_index(def);
 
   DEBUG(CHK_SECURE, checkDefinition(def));
@@ -1492,6 +1608,62 @@ addClauseToIndexes(Definition def, Clause clause, ClauseRef where)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+addClausesToIndexes() is called by assertProcedureList()  after linking
+count clauses starting at cref to  the   end  of  the clause list. Index
+tables that would grow beyond  their   resize  limit  are deleted rather
+than extended clause-by-clause. They are recreated  with the right size
+by the JIT indexer on the next call.  As   the  number of clauses may have
+crossed one or more powers of two,  we   re-evaluate  the  tried indexes
+if the highest bit of the clause count changed.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+addClausesToIndexes(Definition def, ClauseRef cref, size_t count)
+{ ClauseList cl = &def->impl.clauses;
+  ClauseIndex *cip;
+  unsigned int nc = cl->number_of_clauses;
+
+  if ( (cip=cl->clause_indexes) )
+  { for(; *cip; cip++)
+    { ClauseIndex ci = *cip;
+      ClauseRef cr;
+      size_t n;
+
+      if ( ISDEADCI(ci) )
+	continue;
+
+      while ( ci->incomplete )
+	wait_for_index(ci);
+
+      if ( ci->size + count >= ci->resize_above )
+      { deleteIndexP(def, cl, cip);
+	continue;
+      }
+
+      for(cr=cref, n=count; n > 0; cr=cr->next, n--)
+	addClauseToIndex(ci, cr->value.clause, CL_END);
+    }
+  }
+
+  if ( def->range_indexes )
+  { ClauseRef cr;
+    size_t n;
+
+    for(cr=cref, n=count; n > 0; cr=cr->next, n--)
+      addClauseToRangeIndexes(def, cr->value.clause, CL_END);
+  }
+
+  if ( true(def, P_DYNAMIC) && count > 0 &&
+       (nc == count || MSB(nc) != MSB(nc-(unsigned int)count)) )
+  { clear(def, P_SHRUNKPOW2);
+    clearTriedIndexes(def);
+  }
+
+  DEBUG(CHK_SECURE, checkDefinition(def));
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Called from unlinkClause(), which is called for retracting a clause from
 a dynamic predicate which is not  referenced   and  has  few clauses. In
@@ -1594,7 +1766,7 @@ hashDefinition(ClauseList clist, hash_hints *hints, IndexContext ctx)
       if ( ISDEADCI(cio) )
 	continue;
 
-      if ( memcmp(cio->args, hints->args, sizeof(cio->args)) == 0 )
+      if ( sameIndex(cio, hints->args, hints->dict_key) )
       { UNLOCKDEF(ctx->predicate);
 	DEBUG(MSG_JIT, Sdprintf("[%d] already created\n", PL_thread_self()));
 	return cio;
@@ -1604,6 +1776,8 @@ hashDefinition(ClauseList clist, hash_hints *hints, IndexContext ctx)
   ci = newClauseIndexTable(hints->args, hints, ctx);
   insertIndex(ctx->predicate, clist, ci);
   UNLOCKDEF(ctx->predicate);
+  if ( clist == &ctx->predicate->impl.clauses )
+    waitUnlockedWriters(ctx->predicate);	/* see pl-proc.c */
 
   for(cref = clist->first_clause; cref; cref = cref->next)
   { if ( false(cref->value.clause, CL_ERASED) )
@@ -1619,6 +1793,214 @@ hashDefinition(ClauseList clist, hash_hints *hints, IndexContext ctx)
 }
 
 
+		 /*******************************
+		 *     BACKGROUND INDEXING	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Building an index for a predicate with many clauses takes long. Instead
+of building it in the thread that needs  it, we queue a job for the
+`__index_builder` thread if the predicate has at least the number of
+clauses specified by the Prolog flag `jiti_background_threshold`. This
+thread is created on first use  by signalIndexBuilder() and only builds
+indexes, such that a long build   never  delays atom or clause garbage
+collection in the gc thread.  The calling thread and
+all other threads use the predicate unindexed   or using an index that
+is already available until the new index is completed.
+
+Jobs are only queued for the  clause  list   of  the  predicate  itself.
+Clause lists used for deep  indexing   can  be  deleted asynchronously.
+Thread-local instances of a predicate are never indexed in the
+background: they are destroyed with their  thread and other threads do
+not compete for them anyway.  Other predicate  definitions are only
+deleted when their module is destroyed. Pending jobs for such predicates
+are removed using forgetIndexJobs().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static ClauseIndex
+existingIndex(ClauseList clist, const iarg_t *args, word dict_key)
+{ ClauseIndex *cip;
+
+  if ( (cip=clist->clause_indexes) )
+  { for(; *cip; cip++)
+    { ClauseIndex ci = *cip;
+
+      if ( !ISDEADCI(ci) && sameIndex(ci, args, dict_key) )
+	return ci;
+    }
+  }
+
+  return NULL;
+}
+
+
+#ifdef O_PLMT
+
+typedef struct index_job
+{ struct index_job *next;		/* next job */
+  Definition	predicate;		/* predicate to index */
+  hash_hints	hints;			/* how to index */
+} index_job, *IndexJob;
+
+static int
+requestIndex(ClauseList clist, hash_hints *hints, IndexContext ctx)
+{ Definition def = ctx->predicate;
+  IndexJob job, *jp;
+  int rc = TRUE;
+
+  canonicalHap(hints->args);
+  if ( existingIndex(clist, hints->args, hints->dict_key) )
+    return TRUE;			/* index is being created */
+
+  pthread_mutex_lock(&GD->thread.index.mutex);
+  for(jp = &GD->thread.index.jobs; *jp; jp = &(*jp)->next)
+  { job = *jp;
+
+    if ( job->predicate == def &&
+	 memcmp(job->hints.args, hints->args, sizeof(hints->args)) == 0 &&
+	 job->hints.dict_key == hints->dict_key )
+    { pthread_mutex_unlock(&GD->thread.index.mutex);
+      return TRUE;			/* already queued */
+    }
+  }
+  job = allocHeapOrHalt(sizeof(*job));
+  job->next      = NULL;
+  job->predicate = def;
+  job->hints     = *hints;
+  *jp = job;
+  pthread_mutex_unlock(&GD->thread.index.mutex);
+
+  DEBUG(MSG_JIT, Sdprintf("[%d] Queued index %s for %s\n",
+			  PL_thread_self(),
+			  iargsName(hints->args, NULL),
+			  predicateName(def)));
+
+  if ( !signalIndexBuilder() )
+  { pthread_mutex_lock(&GD->thread.index.mutex);
+    for(jp = &GD->thread.index.jobs; *jp; jp = &(*jp)->next)
+    { if ( *jp == job )
+      { *jp = job->next;
+	freeHeap(job, sizeof(*job));
+	rc = FALSE;			/* we must build ourselves */
+	break;
+      }
+    }
+    pthread_mutex_unlock(&GD->thread.index.mutex);
+  }
+
+  return rc;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+nextIndexJob() pops the next job and  marks its predicate as accessed by
+the calling thread.  This must happen  while   we  hold the mutex: once
+the job is off the queue, forgetIndexJobs() cannot  see it and the only
+thing that stops clause-GC from freeing the   predicate is our access
+mark.  The caller must call release_def() when done.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static IndexJob
+nextIndexJob(ARG1_LD)
+{ IndexJob job;
+
+  pthread_mutex_lock(&GD->thread.index.mutex);
+  if ( (job=GD->thread.index.jobs) )
+  { GD->thread.index.jobs = job->next;
+    acquire_def(job->predicate);
+  }
+  pthread_mutex_unlock(&GD->thread.index.mutex);
+
+  return job;
+}
+
+
+void
+forgetIndexJobs(Definition def)
+{ IndexJob *jp;
+
+  if ( !GD->thread.index.jobs )
+    return;
+
+  pthread_mutex_lock(&GD->thread.index.mutex);
+  for(jp = &GD->thread.index.jobs; *jp; )
+  { IndexJob job = *jp;
+
+    if ( job->predicate == def )
+    { *jp = job->next;
+      freeHeap(job, sizeof(*job));
+    } else
+    { jp = &job->next;
+    }
+  }
+  pthread_mutex_unlock(&GD->thread.index.mutex);
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+buildQueuedIndexes() builds all queued  indexes.   It  is called by the
+index builder thread and returns early   if this thread is requested to
+exit.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+buildQueuedIndexes(ARG1_LD)
+{ IndexJob job;
+
+  while( !LD->exit_requested && (job=nextIndexJob(PASS_LD1)) )
+  { Definition def = job->predicate;
+    index_context ctx;
+
+    ctx.generation  = global_generation();
+    ctx.predicate   = def;
+    ctx.chp         = NULL;
+    ctx.depth       = 0;
+    ctx.position[0] = END_INDEX_POS;
+
+    if ( def->impl.clauses.number_of_clauses > 0 )
+      hashDefinition(&def->impl.clauses, &job->hints, &ctx);
+    release_def(def);			/* acquired by nextIndexJob() */
+    freeHeap(job, sizeof(*job));
+  }
+}
+
+#endif /*O_PLMT*/
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+buildIndex() creates the index described by `hints`.  It returns NULL if
+the index is built in the background. The   returned  index may also be
+incomplete if it is being built by another thread.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+isLocalisedDefinition(Definition def)
+{ GET_LD
+  Procedure proc;
+
+  return ( !(proc=isCurrentProcedure(def->functor->functor, def->module)) ||
+	   proc->definition != def );
+}
+
+
+static ClauseIndex
+buildIndex(ClauseList clist, hash_hints *hints, IndexContext ctx)
+{
+#ifdef O_PLMT
+  int64_t threshold = GD->thread.index.bg_threshold;
+
+  if ( threshold > 0 &&
+       clist->number_of_clauses >= threshold &&
+       ctx->depth == 0 &&
+       !isLocalisedDefinition(ctx->predicate) &&
+       requestIndex(clist, hints, ctx) )
+    return NULL;
+#endif
+
+  return hashDefinition(clist, hints, ctx);
+}
+
+
 static ClauseIndex *
 copyIndex(ClauseIndex *org, int extra)
 { ClauseIndex *ncip;
@@ -2395,6 +2777,91 @@ assess_scan_clauses(ClauseList clist, size_t arity,
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+assess_dict_keys() assesses indexing on the value   of the keys of `dict`,
+which appears as argument `arg` of the call.  We can only assess keys we
+know about and thus  use  the  keys  of  the  dict  in  the  call.  The
+result is stored in  the  arg_info  of   the  argument  and  is  reset
+together with the other assessments by clearTriedIndexes().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+assess_scan_dict_clauses(ClauseList clist, int arg, const word *names,
+			 hash_assessment *assessments, int count,
+			 IndexContext ctx)
+{ ClauseRef cref;
+
+  for(cref=clist->first_clause; cref; cref=cref->next)
+  { Clause cl = cref->value.clause;
+    Code pc;
+    int n;
+
+    if ( true(cl, CL_ERASED) )
+      continue;
+
+    pc = skipToTerm(cl, ctx->position);
+    if ( arg > 0 )
+      pc = skipArgs(pc, arg);
+
+    for(n=0; n<count; n++)
+    { word key = dictIndexKeyFromCode(pc, names[n]);
+
+      if ( key )
+	assessAddKey(&assessments[n], key, FALSE);
+      else
+	assessments[n].var_count++;
+    }
+  }
+}
+
+
+static void
+assess_dict_keys(ClauseList clist, int arg, word dict,
+		 arg_info *ainfo, IndexContext ctx ARG_LD)
+{ Functor f = valueTerm(dict);
+  size_t i, pairs = arityFunctor(f->definition)/2;
+  hash_assessment assessments[MAX_DICT_ASSESS];
+  word names[MAX_DICT_ASSESS];
+  int count = 0;
+
+  ainfo->dict_assessed = TRUE;
+  ainfo->dict_key      = 0;
+  ainfo->dict_speedup  = 0.0;
+
+  for(i=0; i<pairs && count < MAX_DICT_ASSESS; i++)
+  { Word vp, np;
+
+    deRef2(&f->arguments[i*2+1], vp);
+    deRef2(&f->arguments[i*2+2], np);
+    if ( canIndex(*vp PASS_LD) )
+    { memset(&assessments[count], 0, sizeof(assessments[count]));
+      names[count++] = *np;
+    }
+  }
+
+  if ( count > 0 )
+    assess_scan_dict_clauses(clist, arg, names, assessments, count, ctx);
+
+  for(i=0; i<(size_t)count; i++)
+  { hash_assessment *a = &assessments[i];
+
+    if ( assess_remove_duplicates(a, clist->number_of_clauses) &&
+	 a->speedup > ainfo->dict_speedup )
+    { DEBUG(MSG_JIT, Sdprintf("Assess dict key %s of arg %d of %s: "
+			      "speedup %f\n",
+			      stringAtom(names[i]), arg+1,
+			      predicateName(ctx->predicate), a->speedup));
+
+      ainfo->dict_key        = names[i];
+      ainfo->dict_speedup    = a->speedup;
+      ainfo->dict_ln_buckets = MSB(a->size);
+    }
+    if ( a->keys )
+      free(a->keys);
+  }
+}
+
+
 static hash_assessment *
 best_assessment(hash_assessment *assessments, int count, size_t clause_count)
 { int i;
@@ -2518,6 +2985,34 @@ bestHash(Word av, size_t ac, ClauseList clist, float min_speedup,
     }
   }
 
+					/* Step 5: dict key of a dict arg */
+  for(i=0; i<ninstantiated; i++)
+  { int arg = instantiated[i];
+    arg_info *ainfo = &clist->args[arg];
+    Word p = av+arg;
+    Word vp;
+
+    deRef(p);
+    if ( !isTerm(*p) || !termIsDict(*p) )
+      continue;
+    if ( !ainfo->dict_assessed )
+      assess_dict_keys(clist, arg, *p, ainfo, ctx PASS_LD);
+
+    if ( ainfo->dict_key &&
+	 ainfo->dict_speedup > best_speedup &&
+	 ainfo->dict_speedup > min_speedup &&
+	 (vp=dict_lookup_ptr(*p, ainfo->dict_key PASS_LD)) &&
+	 canIndex(*vp PASS_LD) )
+    { memset(hints, 0, sizeof(*hints));
+      hints->args[0]    = arg+1;
+      hints->dict_key   = ainfo->dict_key;
+      hints->ln_buckets = ainfo->dict_ln_buckets;
+      hints->speedup    = ainfo->dict_speedup;
+
+      return TRUE;
+    }
+  }
+
   if ( best >= 0 &&
        (float)clist->number_of_clauses/best_speedup > 3 )
   { int ok, m, n;
@@ -2596,7 +3091,13 @@ Where is one of
 
   - Simple index		single(ArgN)
   - Multi-argument index	multi([Arg1,Arg2,...])
+  - Dict key index		dict_key(ArgN, Key)
   - Deep index		        deep([Arg1,Arg2,...])
+  - Deep index in list cell	list([Arg1,Arg2,...])
+
+The last element of the  list  for  deep   indexes  is  a  single, multi
+or dict_key index. A list(Path) index is  a deep index where the innermost
+term is a list cell, i.e., it indexes the head or tail of a list.
 
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -2620,14 +3121,17 @@ sizeofClauseIndex(ClauseIndex ci)
 }
 
 
+/* put_index_spec() puts the ArgSpec of ci, as used by
+   predicate_property/2 for indexed(List), in `where`, but without the
+   deep/1 wrapper around the position of a deep index.
+*/
+
 static int
-unify_clause_index(term_t t, ClauseIndex ci)
+put_index_spec(term_t where, ClauseIndex ci)
 { GET_LD
-  term_t where = PL_new_term_ref();
-  term_t tmp  = PL_new_term_ref();
+  term_t tmp;
 
-  if ( !(where=PL_new_term_ref()) ||
-       !(tmp =PL_new_term_ref()) )
+  if ( !(tmp=PL_new_term_ref()) )
     return FALSE;
 
   if ( ci->args[1] )
@@ -2644,6 +3148,15 @@ unify_clause_index(term_t t, ClauseIndex ci)
 
     if ( !PL_cons_functor(where, FUNCTOR_multi1, where) )
       return FALSE;
+  } else if ( ci->dict_key )
+  { term_t key;
+
+    if ( !(key=PL_new_term_ref()) ||
+	 !PL_put_integer(tmp, ci->args[0]) )
+      return FALSE;
+    _PL_put_atomic(key, ci->dict_key);
+    if ( !PL_cons_functor(where, FUNCTOR_dict_key2, tmp, key) )
+      return FALSE;
   } else
   { if ( !PL_put_integer(where, ci->args[0]) ||
 	 !PL_cons_functor(where, FUNCTOR_single1, where) )
@@ -2666,10 +3179,24 @@ unify_clause_index(term_t t, ClauseIndex ci)
 	   !PL_cons_list(where, tmp, where) )
 	return FALSE;
     }
-    if ( !PL_cons_functor(where, FUNCTOR_deep1, where) )
-      return FALSE;
   }
 
+  return TRUE;
+}
+
+
+static int
+unify_clause_index(term_t t, ClauseIndex ci)
+{ GET_LD
+  term_t where;
+
+  if ( !(where=PL_new_term_ref()) ||
+       !put_index_spec(where, ci) )
+    return FALSE;
+  if ( ci->position[0] != END_INDEX_POS &&
+       !PL_cons_functor(where, FUNCTOR_deep1, where) )
+    return FALSE;
+
   return PL_unify_term(t,
 		       PL_FUNCTOR, FUNCTOR_minus2,
 			 PL_TERM, where,
@@ -2681,8 +3208,14 @@ unify_clause_index(term_t t, ClauseIndex ci)
 }
 
 
+/* Add the deep indexes below the list index ci.  If `lists` is TRUE, we
+   only add the positions of the deep indexes into list cells, which
+   are reported as list_indexed(Positions).
+*/
+
 static int
-add_deep_indexes(ClauseIndex ci, term_t head, term_t tail ARG_LD)
+add_deep_indexes(ClauseIndex ci, term_t head, term_t tail, int lists,
+		 int *found ARG_LD)
 { size_t i;
 
   for(i=0; i<ci->buckets; i++)
@@ -2700,11 +3233,23 @@ add_deep_indexes(ClauseIndex ci, term_t head, term_t tail ARG_LD)
 	    if ( ISDEADCI(ci) )
 	      continue;
 
-	    if ( !PL_unify_list(tail, head, tail) ||
-		 !unify_clause_index(head, ci) )
-	      return FALSE;
+	    if ( !lists )
+	    { if ( !PL_unify_list(tail, head, tail) ||
+		   !unify_clause_index(head, ci) )
+		return FALSE;
+	      (*found)++;
+	    } else if ( cref->d.key == FUNCTOR_dot2 )
+	    { term_t path;
+
+	      if ( !(path=PL_new_term_ref()) ||
+		   !put_index_spec(path, ci) ||
+		   !PL_unify_list(tail, head, tail) ||
+		   !PL_unify(head, path) )
+		return FALSE;
+	      (*found)++;
+	    }
 	    if ( ci->is_list &&
-		 !add_deep_indexes(ci, head, tail PASS_LD) )
+		 !add_deep_indexes(ci, head, tail, lists, found PASS_LD) )
 	      return FALSE;
 	  }
 	}
@@ -2716,8 +3261,13 @@ add_deep_indexes(ClauseIndex ci, term_t head, term_t tail ARG_LD)
 }
 
 
+/* unify_index_pattern() implements predicate_property/2 for indexed(List)
+   and, if `lists` is TRUE, list_indexed(Positions).  Fails if there are
+   no such indexes.
+*/
+
 bool
-unify_index_pattern(Procedure proc, term_t value)
+unify_index_pattern(Procedure proc, term_t value, int lists)
 { GET_LD
   Definition def = getProcDefinition__LD(proc->definition PASS_LD);
   ClauseIndex *cip;
@@ -2735,12 +3285,14 @@ unify_index_pattern(Procedure proc, term_t value)
       if ( ISDEADCI(ci) )
 	continue;
 
-      found++;
-      if ( !PL_unify_list(tail, head, tail) ||
-	   !unify_clause_index(head, ci) )
-	goto out;
+      if ( !lists )
+      { if ( !PL_unify_list(tail, head, tail) ||
+	     !unify_clause_index(head, ci) )
+	  goto out;
+	found++;
+      }
       if ( ci->is_list )
-      { if ( !add_deep_indexes(ci, head, tail PASS_LD) )
+      { if ( !add_deep_indexes(ci, head, tail, lists, &found PASS_LD) )
 	  goto out;
       }
     }
@@ -2755,8 +3307,907 @@ out:
 
 
 		 /*******************************
-		 *      PUBLISH PREDICATES	*
+		 *	   RANGE INDEXES	*
 		 *******************************/
 
-BeginPredDefs(index)
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+A range index keeps the clauses of a predicate sorted on the value of an
+argument that is an integer, float or atom in the clause head. It allows
+enumerating the clauses for which this   argument  is in a given range
+(using the standard order of terms)   in  ascending order. Clauses where
+the argument is of another type, e.g., a variable, compound or string,
+are not part of the index.
+
+Range indexes are selected per predicate and argument, either explicitly
+using '$jiti_range_index'/2 or by the first   range  query on the
+argument.  After that they are maintained incrementally:
+
+  - The entries are an array.  The first `size` entries are sorted and
+    are followed by `pending` entries in the order in which the clauses
+    were added.  A query searches the sorted part and scans the pending
+    part.  If the pending part gets too large (see RANGE_MERGE()), the
+    query sorts it and merges it with the sorted part.
+  - Each entry has an `order` that reflects the position of the clause
+    in the clause list and keeps entries with the same key in clause
+    order.  assertz/1 and asserta/1 extend the range at either end.
+    Inserting a clause elsewhere (reconsult) marks the index `dirty`,
+    after which the next query rebuilds it.
+  - Retracted clauses remain in the index and are filtered using the
+    normal visibility test.  cleanRangeIndexes() removes them along with
+    the other indexes of the predicate.
+
+The index is created, updated and queried while holding the predicate
+lock, so concurrent queries cannot create duplicates or see a partially
+updated array.  Its entries hold their own clause references, which are
+released using lingerClauseRef().  Unlocked writers (see pl-proc.c) do
+not update indexes and therefore use the locked path if the predicate
+has a range index.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define RK_INTEGER 0
+#define RK_FLOAT   1
+#define RK_ATOM	   2
+
+#define SCALAR_TO_CMP(a,b) ((a) < (b) ? CMP_LESS : (a) == (b) ? CMP_EQUAL : CMP_GREATER)
+#define RANGE_MERGE(ri) ((ri)->pending > 16 && \
+			 (ri)->pending*(ri)->pending > (ri)->size)
+
+typedef struct range_key
+{ int		type;			/* RK_* */
+  union
+  { int64_t	i;
+    double	f;
+    atom_t	a;
+  } value;
+} range_key;
+
+typedef struct range_entry
+{ range_key	key;			/* Sort key */
+  int64_t	order;			/* Position in the clause list */
+  ClauseRef	cref;			/* Reference to the clause */
+} range_entry;
+
+struct range_index
+{ struct range_index *next;		/* Next index of the predicate */
+  iarg_t	arg;			/* Indexed argument (1-based) */
+  int		dirty;			/* Must be rebuilt */
+  size_t	size;			/* # sorted entries */
+  size_t	pending;		/* # unsorted entries after them */
+  size_t	allocated;		/* Allocated entries */
+  int64_t	first_order;		/* Order of the first clause */
+  int64_t	last_order;		/* Order of the last clause */
+  range_entry  *entries;		/* Sorted entries + pending entries */
+};
+
+
+static int
+rangeKeyFromClause(Clause cl, int an, range_key *key)
+{ Code pc = cl->codes;
+
+  if ( an > 0 )
+    pc = skipArgs(pc, an);
+
+  for(;;)
+  { code c = decode(*pc++);
+
+#if O_DEBUGGER
+  again:
+#endif
+    switch(c)
+    { case H_ATOM:
+	key->type    = RK_ATOM;
+	key->value.a = (atom_t)*pc;
+	return TRUE;
+      case H_NIL:
+	key->type    = RK_ATOM;
+	key->value.a = ATOM_nil;
+	return TRUE;
+      case H_SMALLINT:
+	key->type    = RK_INTEGER;
+	key->value.i = valInt((word)*pc);
+	return TRUE;
+      case H_INTEGER:
+	key->type    = RK_INTEGER;
+	key->value.i = (int64_t)(intptr_t)*pc;
+	return TRUE;
+#if SIZEOF_VOIDP == 4
+      case H_INT64:
+	key->type    = RK_INTEGER;
+	memcpy(&key->value.i, pc, sizeof(int64_t));
+	return TRUE;
+#endif
+      case H_FLOAT:
+	key->type    = RK_FLOAT;
+	memcpy(&key->value.f, pc, sizeof(double));
+	return TRUE;
+      case I_NOP:
+	continue;
+#ifdef O_DEBUGGER
+      case D_BREAK:
+	c = decode(replacedBreak(pc-1));
+	goto again;
+#endif
+      default:
+	return FALSE;
+    }
+  }
+}
+
+
+/* compare_range_keys() follows compare_primitives() in pl-prims.c: numbers
+   before atoms, integers and floats using cmpNumbers() and if equal,
+   Float < Int.  Floats are compared using compareFloats().
+*/
+
+static int
+compare_range_keys(const range_key *k1, const range_key *k2)
+{ if ( k1->type == RK_ATOM || k2->type == RK_ATOM )
+  { if ( k1->type == k2->type )
+      return compareAtoms(k1->value.a, k2->value.a);
+    return k1->type == RK_ATOM ? CMP_GREATER : CMP_LESS;
+  }
+
+  if ( k1->type == k2->type )
+  { if ( k1->type == RK_INTEGER )
+      return SCALAR_TO_CMP(k1->value.i, k2->value.i);
+    return compareFloats(k1->value.f, k2->value.f);
+  } else
+  { number n1, n2;
+    int rc;
+
+    if ( k1->type == RK_INTEGER )
+    { n1.type = V_INTEGER; n1.value.i = k1->value.i;
+      n2.type = V_FLOAT;   n2.value.f = k2->value.f;
+    } else
+    { n1.type = V_FLOAT;   n1.value.f = k1->value.f;
+      n2.type = V_INTEGER; n2.value.i = k2->value.i;
+    }
+
+    if ( (rc=cmpNumbers(&n1, &n2)) == CMP_EQUAL )
+      rc = k1->type == RK_FLOAT ? CMP_LESS : CMP_GREATER;
+    return rc;
+  }
+}
+
+
+static int
+compare_range_entries(const void *p1, const void *p2)
+{ const range_entry *e1 = p1;
+  const range_entry *e2 = p2;
+  int rc = compare_range_keys(&e1->key, &e2->key);
+
+  if ( rc == CMP_EQUAL )		/* stable: keep clause order */
+    rc = SCALAR_TO_CMP(e1->order, e2->order);
+
+  return rc;
+}
+
+
+static void
+clearRangeIndex(RangeIndex ri)
+{ size_t i, n = ri->size+ri->pending;
+
+  for(i=0; i<n; i++)
+    lingerClauseRef(ri->entries[i].cref);
+  ri->size    = 0;
+  ri->pending = 0;
+}
+
+
+static void
+freeRangeIndex(RangeIndex ri)
+{ clearRangeIndex(ri);
+  if ( ri->entries )
+    freeHeap(ri->entries, ri->allocated*sizeof(*ri->entries));
+  freeHeap(ri, sizeof(*ri));
+}
+
+
+/* Add an entry for cl to the pending entries of ri.  Our clause references
+   are not part of any clause list.
+*/
+
+static void
+addRangeEntry(RangeIndex ri, Clause cl, int64_t order)
+{ range_key key;
+  range_entry *e;
+
+  if ( !rangeKeyFromClause(cl, ri->arg-1, &key) )
+    return;
+
+  if ( ri->size+ri->pending == ri->allocated )
+  { size_t allocated = ri->allocated ? ri->allocated*2 : 16;
+    range_entry *new = allocHeapOrHalt(allocated*sizeof(*new));
+
+    if ( ri->entries )
+    { memcpy(new, ri->entries, ri->allocated*sizeof(*new));
+      freeHeap(ri->entries, ri->allocated*sizeof(*new));
+    }
+    ri->entries   = new;
+    ri->allocated = allocated;
+  }
+
+  e = &ri->entries[ri->size+ri->pending++];
+  e->key   = key;
+  e->order = order;
+  e->cref  = newClauseRef(cl, 0);
+}
+
+
+/* Sort the pending entries and merge them with the sorted ones */
+
+static void
+mergeRangeIndex(RangeIndex ri)
+{ size_t n = ri->size+ri->pending;
+
+  qsort(ri->entries+ri->size, ri->pending, sizeof(*ri->entries),
+	compare_range_entries);
+
+  if ( ri->size > 0 )
+  { range_entry *tmp = allocHeapOrHalt(n*sizeof(*tmp));
+    range_entry *s = ri->entries,          *se = s+ri->size;
+    range_entry *p = ri->entries+ri->size, *pe = p+ri->pending;
+    range_entry *o = tmp;
+
+    while( s < se && p < pe )
+    { if ( compare_range_entries(s, p) == CMP_LESS )
+	*o++ = *s++;
+      else
+	*o++ = *p++;
+    }
+    while( s < se ) *o++ = *s++;
+    while( p < pe ) *o++ = *p++;
+
+    memcpy(ri->entries, tmp, n*sizeof(*tmp));
+    freeHeap(tmp, n*sizeof(*tmp));
+  }
+
+  ri->size    = n;
+  ri->pending = 0;
+}
+
+
+static void
+fillRangeIndex(RangeIndex ri, Definition def)
+{ ClauseRef cref;
+  int64_t nth = 0;
+
+  for(cref = def->impl.clauses.first_clause; cref; cref = cref->next)
+  { Clause cl = cref->value.clause;
+
+    if ( false(cl, CL_ERASED) )
+      addRangeEntry(ri, cl, ++nth);
+  }
+
+  ri->first_order = 1;
+  ri->last_order  = nth;
+  ri->dirty       = FALSE;
+  mergeRangeIndex(ri);
+}
+
+
+/* Make the index up-to-date for a query.  Must hold LOCKDEF() */
+
+static void
+syncRangeIndex(RangeIndex ri, Definition def)
+{ if ( ri->dirty )
+  { clearRangeIndex(ri);
+    fillRangeIndex(ri, def);
+  } else if ( RANGE_MERGE(ri) )
+  { mergeRangeIndex(ri);
+  }
+}
+
+
+/* Find or create the range index for argument an (0-based).  Must hold
+   LOCKDEF().  A new index is linked before waiting for the unlocked
+   writers, such that each of these has either added its clause to the
+   clause list or sees the index and waits for our lock.
+*/
+
+static RangeIndex
+getRangeIndex(Definition def, int an)
+{ RangeIndex ri;
+
+  for(ri = def->range_indexes; ri; ri = ri->next)
+  { if ( ri->arg == an+1 )
+    { syncRangeIndex(ri, def);
+      return ri;
+    }
+  }
+
+  ri = allocHeapOrHalt(sizeof(*ri));
+  memset(ri, 0, sizeof(*ri));
+  ri->arg  = (iarg_t)(an+1);
+  ri->next = def->range_indexes;
+  MemoryBarrier();
+  def->range_indexes = ri;
+  waitUnlockedWriters(def);
+
+  fillRangeIndex(ri, def);
+  ATOMIC_INC(&GD->statistics.indexes.created);
+
+  return ri;
+}
+
+
+/* addClauseToRangeIndexes() is called by addClauseToIndexes() and
+   addClausesToIndexes(), which hold LOCKDEF().
+*/
+
+static void
+addClauseToRangeIndexes(Definition def, Clause cl, ClauseRef where)
+{ RangeIndex ri;
+
+  for(ri = def->range_indexes; ri; ri = ri->next)
+  { if ( ri->dirty )
+      continue;
+    if ( where == CL_END )
+      addRangeEntry(ri, cl, ++ri->last_order);
+    else if ( where == CL_START )
+      addRangeEntry(ri, cl, --ri->first_order);
+    else
+      ri->dirty = TRUE;
+  }
+}
+
+
+/* cleanRangeIndexes() is called from cleanClauseIndexes() to remove
+   clauses erased before generation `active`.  Removing entries keeps the
+   sorted part sorted.
+*/
+
+static void
+cleanRangeIndexes(Definition def, gen_t active)
+{ RangeIndex ri;
+
+  for(ri = def->range_indexes; ri; ri = ri->next)
+  { size_t i, o = 0, n = ri->size+ri->pending, size = ri->size;
+
+    for(i=0; i<n; i++)
+    { range_entry *e = &ri->entries[i];
+      Clause cl = e->cref->value.clause;
+
+      if ( true(cl, CL_ERASED) && cl->generation.erased < active )
+      { lingerClauseRef(e->cref);
+	if ( i < ri->size )
+	  size--;
+      } else
+      { ri->entries[o++] = *e;
+      }
+    }
+    ri->size    = size;
+    ri->pending = o-size;
+  }
+}
+
+
+/* Called when the predicate is destroyed */
+
+void
+deleteRangeIndexes(Definition def)
+{ RangeIndex ri, next;
+
+  for(ri = def->range_indexes; ri; ri = next)
+  { next = ri->next;
+    freeRangeIndex(ri);
+  }
+  def->range_indexes = NULL;
+}
+
+
+static int
+get_range_key(term_t t, range_key *key ARG_LD)
+{ Word p = valTermRef(t);
+
+  deRef(p);
+  if ( isAtom(*p) )			/* also [] and blobs, see */
+  { key->type    = RK_ATOM;		/* rangeKeyFromClause() */
+    key->value.a = *p;
+  } else if ( isInteger(*p) )
+  { number n;
+
+    get_integer(*p, &n);
+    if ( n.type == V_INTEGER )
+    { key->type    = RK_INTEGER;
+      key->value.i = n.value.i;
+    } else
+    { key->type    = RK_FLOAT;	/* outside int64: beyond all keys */
+      key->value.f = ar_sign_i(&n) < 0 ? -HUGE_VAL : HUGE_VAL;
+      clearNumber(&n);
+    }
+  } else if ( isFloat(*p) )
+  { key->type    = RK_FLOAT;
+    key->value.f = valFloat(*p);
+  } else if ( canBind(*p) )
+  { return -1;				/* open bound */
+  } else
+  { return PL_type_error("atomic", t);
+  }
+
+  return TRUE;
+}
+
+
+static size_t
+range_lower_bound(RangeIndex ri, const range_key *key)
+{ size_t lo = 0, hi = ri->size;
+
+  while ( lo < hi )
+  { size_t m = lo + (hi-lo)/2;
+
+    if ( compare_range_keys(&ri->entries[m].key, key) == CMP_LESS )
+      lo = m+1;
+    else
+      hi = m;
+  }
+
+  return lo;
+}
+
+
+typedef struct range_query
+{ range_key	low;
+  range_key	high;
+  int		has_low;		/* > 0: Low is a bound */
+  int		has_high;		/* > 0: High is a bound */
+  gen_t		generation;		/* Visibility */
+} range_query;
+
+static int
+in_range(const range_entry *e, const range_query *q ARG_LD)
+{ return ( (q->has_low <= 0 ||
+	    compare_range_keys(&e->key, &q->low) != CMP_LESS) &&
+	   (q->has_high <= 0 ||
+	    compare_range_keys(&e->key, &q->high) != CMP_GREATER) &&
+	   visibleClause(e->cref->value.clause, q->generation) );
+}
+
+
+/* Add the visible clauses of ri that are in the range to `clauses`,
+   ordered by key.  Must hold LOCKDEF().
+*/
+
+static void
+find_range(RangeIndex ri, const range_query *q, Buffer clauses ARG_LD)
+{ size_t i = q->has_low > 0 ? range_lower_bound(ri, &q->low) : 0;
+  range_entry *p = ri->entries+ri->size, *pe = p+ri->pending;
+  tmp_buffer pbuf;
+  range_entry *pm, *pme;
+
+  initBuffer(&pbuf);
+  for(; p < pe; p++)
+  { if ( in_range(p, q PASS_LD) )
+      addBuffer(&pbuf, *p, range_entry);
+  }
+  pm  = baseBuffer(&pbuf, range_entry);
+  pme = pm + entriesBuffer(&pbuf, range_entry);
+  qsort(pm, pme-pm, sizeof(*pm), compare_range_entries);
+
+  for(; i<ri->size; i++)
+  { range_entry *e = &ri->entries[i];
+
+    if ( q->has_high > 0 &&
+	 compare_range_keys(&e->key, &q->high) == CMP_GREATER )
+      break;
+    if ( !visibleClause(e->cref->value.clause, q->generation) )
+      continue;
+    for(; pm < pme && compare_range_entries(pm, e) == CMP_LESS; pm++)
+      addBuffer(clauses, pm->cref->value.clause, Clause);
+    addBuffer(clauses, e->cref->value.clause, Clause);
+  }
+  for(; pm < pme; pm++)
+    addBuffer(clauses, pm->cref->value.clause, Clause);
+
+  discardBuffer(&pbuf);
+}
+
+
+static int
+get_range_procedure(term_t head, term_t arg, Definition *defp, int *anp
+		    ARG_LD)
+{ Procedure proc;
+  Definition def;
+  int an;
+
+  if ( !get_procedure(head, &proc, 0, GP_FIND) )
+    return -1;
+  def = getProcDefinition(proc);
+  if ( true(def, P_FOREIGN) )
+    return PL_error(NULL, 0, NULL, ERR_PERMISSION_PROC,
+		    ATOM_access, ATOM_private_procedure, proc);
+  if ( !PL_get_integer_ex(arg, &an) )
+    return FALSE;
+  if ( an < 1 || an > def->functor->arity || an > MAXINDEXARG )
+    return PL_domain_error("argument_position", arg);
+
+  *defp = def;
+  *anp  = an-1;
+  return TRUE;
+}
+
+
+/** '$jiti_range_index'(:Head, +Arg) is det.
+ *
+ * Select a range index on argument Arg of the predicate Head.  The index
+ * is created immediately and maintained on assert/retract.
+ */
+
+static
+PRED_IMPL("$jiti_range_index", 2, jiti_range_index, PL_FA_TRANSPARENT)
+{ PRED_LD
+  Definition def;
+  int an, rc;
+
+  if ( (rc=get_range_procedure(A1, A2, &def, &an PASS_LD)) <= 0 )
+    return rc < 0 ? TRUE : FALSE;
+
+  LOCKDEF(def);
+  getRangeIndex(def, an);
+  UNLOCKDEF(def);
+
+  return TRUE;
+}
+
+
+/** '$clause_range'(:Head, +Arg, ?Low, ?High, -ClauseRefs) is det.
+ *
+ * ClauseRefs is a list of  references  to   the  visible  clauses of
+ * Head whose Arg-th argument is an integer,   float or atom that is in
+ * the range Low..High in the standard order of terms, ordered by this
+ * argument. If Low or High is unbound the range is open on that side.
+ * Selects a range index on Arg if there is none.
+ */
+
+static
+PRED_IMPL("$clause_range", 5, clause_range, PL_FA_TRANSPARENT)
+{ PRED_LD
+  Definition def;
+  range_query q;
+  int an, rc;
+  tmp_buffer clauses;
+  term_t tail = PL_copy_term_ref(A5);
+  term_t head = PL_new_term_ref();
+  Clause *cp, *ep;
+
+  if ( (rc=get_range_procedure(A1, A2, &def, &an PASS_LD)) <= 0 )
+    return rc < 0 ? PL_unify_nil(A5) : FALSE;
+  if ( (q.has_low=get_range_key(A3, &q.low PASS_LD)) == FALSE ||
+       (q.has_high=get_range_key(A4, &q.high PASS_LD)) == FALSE )
+    return FALSE;
+
+  initBuffer(&clauses);
+  q.generation = global_generation();
+  acquire_def(def);			/* keeps the clauses alive */
+  LOCKDEF(def);
+  find_range(getRangeIndex(def, an), &q, (Buffer)&clauses PASS_LD);
+  UNLOCKDEF(def);
+
+  rc = TRUE;
+  cp = baseBuffer(&clauses, Clause);
+  ep = cp + entriesBuffer(&clauses, Clause);
+  for(; cp < ep; cp++)
+  { if ( !PL_unify_list(tail, head, tail) ||
+	 !PL_unify_clref(head, *cp) )
+    { rc = FALSE;
+      break;
+    }
+  }
+  release_def(def);
+  discardBuffer(&clauses);
+
+  return rc && PL_unify_nil(tail);
+}
+
+
+		 /*******************************
+		 *	   EAGER INDEXES	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Create indexes on request rather than   from  a concrete goal. This uses
+the `Where` notation of  predicate_property(Head,   indexed(List)),  so a
+process can dump the indexes  it  has   created  and  a  new process can
+create them before the first goal needs  them (see library(prolog_jiti),
+jiti_save_manifest/1 and jiti_load_manifest/1).
+
+The index is assessed as usual. If  the   current  clauses  do  not make
+the index worthwhile we  fail  silently:  the   manifest  may  be out of
+date. Deep indexes are created for   all  compound keys that are present
+in the list index on the outer argument   as  we do not remember the key
+for which the original JIT index was created.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static ClauseIndex
+createIndexOnArgs(ClauseList clist, size_t arity, iarg_t *args,
+		  unsigned int buckets, IndexContext ctx)
+{ assessment_set aset;
+  hash_assessment *a;
+  hash_hints hints;
+  ClauseIndex ci;
+
+  canonicalHap(args);
+  if ( (ci=existingIndex(clist, args, 0)) )
+    goto out;
+  if ( clist->number_of_clauses == 0 )
+    return NULL;
+
+  init_assessment_set(&aset);
+  a = alloc_assessment(&aset, args);
+  assess_scan_clauses(clist, arity, a, 1, ctx);
+  if ( assess_remove_duplicates(a, clist->number_of_clauses) )
+  { memset(&hints, 0, sizeof(hints));
+    memcpy(hints.args, a->args, sizeof(hints.args));
+    hints.ln_buckets = MSB(a->size);
+    hints.speedup    = a->speedup;
+    hints.list       = a->list;
+    if ( buckets > (2U<<hints.ln_buckets) )
+      hints.ln_buckets = MSB(buckets)-1;
+  } else
+  { hints.speedup = 0.0;
+  }
+  if ( a->keys )
+    free(a->keys);
+  free_assessment_set(&aset);
+
+  if ( hints.speedup == 0.0 )
+  { DEBUG(MSG_JIT, Sdprintf("Eager index %s of %s: not indexable\n",
+			    iargsName(args, NULL),
+			    predicateName(ctx->predicate)));
+    return NULL;
+  }
+
+  ci = hashDefinition(clist, &hints, ctx);
+
+out:
+  while ( ci->incomplete )
+    wait_for_index(ci);
+
+  return ci;
+}
+
+
+/* get_index_args() returns -1 on error and 0 if an argument is out of
+   range for the (sub-)clauses.  Out of range only raises an error for
+   the predicate itself as deep indexes may apply to compounds with
+   different arities.
+*/
+
+static int
+get_index_args(term_t spec, size_t arity, iarg_t *args,
+	       IndexContext ctx ARG_LD)
+{ int n = 0;
+  int in_range = TRUE;
+  term_t a;
+
+  memset(args, 0, sizeof(iarg_t)*MAX_MULTI_INDEX);
+  if ( !(a = PL_new_term_ref()) )
+    return -1;
+
+  if ( PL_is_functor(spec, FUNCTOR_single1) )
+  { int an;
+
+    _PL_get_arg(1, spec, a);
+    if ( !PL_get_integer_ex(a, &an) )
+      return -1;
+    if ( an < 1 || an > MAXINDEXARG )
+      goto domain_error;
+    if ( an > arity )
+      in_range = FALSE;
+    args[n++] = (iarg_t)an;
+  } else if ( PL_is_functor(spec, FUNCTOR_multi1) )
+  { term_t head = PL_new_term_ref();
+    int an;
+
+    _PL_get_arg(1, spec, a);
+    while( PL_get_list(a, head, a) )
+    { if ( !PL_get_integer_ex(head, &an) )
+	return -1;
+      if ( an < 1 || an > MAXINDEXARG || n >= MAX_MULTI_INDEX )
+	goto domain_error;
+      if ( an > arity )
+	in_range = FALSE;
+      args[n++] = (iarg_t)an;
+    }
+    if ( !PL_get_nil_ex(a) )
+      return -1;
+    if ( n < 2 )
+      goto domain_error;
+  } else
+    goto domain_error;
+
+  if ( !in_range && ctx->depth == 0 )
+    goto domain_error;
+
+  return in_range;
+
+domain_error:
+  PL_domain_error("index_specification", spec);
+  return -1;
+}
+
+
+static int
+createDictIndex(ClauseList clist, size_t arity, term_t spec,
+		unsigned int buckets, IndexContext ctx ARG_LD)
+{ term_t a;
+  iarg_t args[MAX_MULTI_INDEX];
+  hash_assessment as;
+  hash_hints hints;
+  ClauseIndex ci;
+  word name;
+  Word p;
+  int an;
+
+  if ( !(a=PL_new_term_ref()) )
+    return -1;
+  _PL_get_arg(1, spec, a);
+  if ( !PL_get_integer_ex(a, &an) )
+    return -1;
+  _PL_get_arg(2, spec, a);
+  p = valTermRef(a);
+  deRef(p);
+  if ( an < 1 || an > MAXINDEXARG || !(isAtom(*p) || isTaggedInt(*p)) ||
+       (an > arity && ctx->depth == 0) )
+  { PL_domain_error("index_specification", spec);
+    return -1;
+  }
+  if ( an > arity )
+    return FALSE;
+  name = *p;
+
+  memset(args, 0, sizeof(args));
+  args[0] = (iarg_t)an;
+  if ( (ci=existingIndex(clist, args, name)) )
+    goto out;
+  if ( clist->number_of_clauses == 0 )
+    return FALSE;
+
+  memset(&as, 0, sizeof(as));
+  assess_scan_dict_clauses(clist, an-1, &name, &as, 1, ctx);
+  if ( !assess_remove_duplicates(&as, clist->number_of_clauses) )
+  { if ( as.keys )
+      free(as.keys);
+    return FALSE;
+  }
+
+  memset(&hints, 0, sizeof(hints));
+  hints.args[0]    = (iarg_t)an;
+  hints.dict_key   = name;
+  hints.ln_buckets = MSB(as.size);
+  hints.speedup    = as.speedup;
+  if ( buckets > (2U<<hints.ln_buckets) )
+    hints.ln_buckets = MSB(buckets)-1;
+  if ( as.keys )
+    free(as.keys);
+
+  ci = hashDefinition(clist, &hints, ctx);
+
+out:
+  while ( ci->incomplete )
+    wait_for_index(ci);
+
+  return TRUE;
+}
+
+
+/* createIndex() creates the index described by spec at path */
+
+static int
+createIndex(ClauseList clist, size_t arity, term_t spec, term_t path,
+	    unsigned int buckets, IndexContext ctx ARG_LD)
+{ term_t head, tail;
+  iarg_t args[MAX_MULTI_INDEX];
+  ClauseIndex ci;
+  int an, rc, created = FALSE;
+  size_t i;
+
+  if ( !path )
+  { if ( PL_is_functor(spec, FUNCTOR_dict_key2) )
+      return createDictIndex(clist, arity, spec, buckets, ctx PASS_LD);
+    if ( (rc=get_index_args(spec, arity, args, ctx PASS_LD)) <= 0 )
+      return rc;
+    return createIndexOnArgs(clist, arity, args, buckets, ctx) != NULL;
+  }
+
+  if ( !(head = PL_new_term_ref()) ||
+       !(tail = PL_new_term_ref()) ||
+       !PL_get_list_ex(path, head, tail) )
+    return -1;
+  if ( PL_get_nil(tail) )		/* last element: index on sub terms */
+    return createIndex(clist, arity, head, 0, buckets, ctx PASS_LD);
+  if ( !PL_get_integer_ex(head, &an) )
+    return -1;
+  if ( an < 1 || an > MAXINDEXARG || ctx->depth >= MAXINDEXDEPTH ||
+       (an > arity && ctx->depth == 0) )
+  { PL_domain_error("index_specification", spec);
+    return -1;
+  }
+  if ( an > arity )
+    return FALSE;
+
+  memset(args, 0, sizeof(args));
+  args[0] = (iarg_t)an;
+  if ( !(ci=createIndexOnArgs(clist, arity, args, 0, ctx)) || !ci->is_list )
+    return FALSE;
+
+  for(i=0; i<ci->buckets; i++)
+  { ClauseRef cref;
+
+    for(cref = ci->entries[i].head; cref; cref = cref->next)
+    { if ( isFunctor(cref->d.key) )
+      { ctx->position[ctx->depth++] = an-1;
+	ctx->position[ctx->depth]   = END_INDEX_POS;
+	rc = createIndex(&cref->value.clauses, arityFunctor(cref->d.key),
+			 spec, tail, 0, ctx PASS_LD);
+	ctx->position[--ctx->depth] = END_INDEX_POS;
+
+	if ( rc < 0 )
+	  return rc;
+	if ( rc )
+	  created = TRUE;
+      }
+    }
+  }
+
+  return created;
+}
+
+
+/** '$jiti_create_index'(:Head, +Where, +Buckets) is semidet.
+ *
+ * Create the index described by Where for the predicate Head.  Where
+ * uses the notation of predicate_property/2 using indexed(List).  Fails
+ * if the index is not considered worthwhile for the current clauses.
+ */
+
+static
+PRED_IMPL("$jiti_create_index", 3, jiti_create_index, PL_FA_TRANSPARENT)
+{ PRED_LD
+  Procedure proc;
+  Definition def;
+  index_context ctx;
+  term_t path = 0;
+  int buckets;
+  int rc;
+
+  if ( !get_procedure(A1, &proc, 0, GP_FIND) )
+    return FALSE;
+  if ( !PL_get_integer_ex(A3, &buckets) )
+    return FALSE;
+  if ( PL_is_functor(A2, FUNCTOR_deep1) )
+  { path = PL_new_term_ref();
+    _PL_get_arg(1, A2, path);
+  }
+
+  def = getProcDefinition(proc);
+  if ( true(def, P_FOREIGN) )
+    return FALSE;
+
+  ctx.generation  = global_generation();
+  ctx.predicate   = def;
+  ctx.chp         = NULL;
+  ctx.depth       = 0;
+  ctx.position[0] = END_INDEX_POS;
+
+  acquire_def(def);
+  rc = createIndex(&def->impl.clauses, def->functor->arity,
+		   A2, path, buckets > 0 ? (unsigned int)buckets : 0,
+		   &ctx PASS_LD);
+  release_def(def);
+
+  return rc > 0;
+}
+
+
+		 /*******************************
+		 *      PUBLISH PREDICATES	*
+		 *******************************/
+
+BeginPredDefs(index)
+  PRED_DEF("$jiti_create_index", 3, jiti_create_index, PL_FA_TRANSPARENT)
+  PRED_DEF("$jiti_range_index", 2, jiti_range_index, PL_FA_TRANSPARENT)
+  PRED_DEF("$clause_range", 5, clause_range, PL_FA_TRANSPARENT)
+#ifdef O_PLMT
+#endif
 EndPredDefs
@@ -659,6 +659,11 @@ parseCommandLineOptions(int argc0, char **argv0, char **argvleft, int compile)
 	    GD->options.nothreads = TRUE;
 	} else
 	  return -1;
+      } else if ( (rc=is_bool_opt(s, "lazy_load", &b)) )
+      { if ( rc == TRUE )
+	  GD->options.lazy_load = b;
+	else
+	  return -1;
       } else if ( (rc=is_bool_opt(s, "tty", &b)) )
       { if ( rc == TRUE )
 	{ if ( b )
@@ -1077,6 +1082,7 @@ usage(void)
     "    --tty[=bool]             (Dis)allow tty control\n",
     "    --signals[=bool]         Do (not) modify signal handling\n",
     "    --threads[=bool]         Do (not) allow for threads\n",
+    "    --lazy_load[=bool]       Do (not) load clauses of states on first call\n",
     "    --debug[=bool]           Do (not) generate debug info\n",
     "    --quiet[=bool] (-q)      Do (not) suppress informational messages\n",
     "    --traditional            Disable extensions of version 7\n",
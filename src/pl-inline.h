@@ -366,6 +366,19 @@ stepPC_unlocked(Code PC)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+switchSlot() returns the  slot  of  an   index  key  in  the table of an
+S_SWITCH supervisor. See switchSupervisor() in pl-supervisor.c.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static inline size_t
+switchSlot(word key, unsigned int shift, size_t mask)
+{ uint64_t h = (uint64_t)key * 0x9e3779b97f4a7c15ULL;
+
+  return (size_t)(h >> shift) & mask;
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Mark() sets LD->mark_bar, indicating  that   any  assignment  above this
 value need not be trailed.
@@ -480,7 +493,7 @@ global_generation(void)
 }
 
 static inline gen_t
-next_global_generation(void)
+next_global_generation_unlocked(void)
 { uint32_t u = GD->_generation.gen_u;
   uint32_t l;
 
@@ -498,12 +511,30 @@ global_generation(void)
 }
 
 static inline gen_t
-next_global_generation(void)
+next_global_generation_unlocked(void)
 { return ATOMIC_INC(&GD->_generation);
 }
 
 #endif /*ATOMIC_GENERATION_HACK*/
 
+/* The generation is advanced while holding L_GENERATION.  This allows
+   assertz_terms() to make a set of clauses visible in one step: while
+   holding the lock it gives the clauses the next generation and only
+   then advances the global generation.  Code that holds L_GENERATION
+   must use next_global_generation_unlocked().
+*/
+
+static inline gen_t
+next_global_generation(void)
+{ gen_t gen;
+
+  PL_LOCK(L_GENERATION);
+  gen = next_global_generation_unlocked();
+  PL_UNLOCK(L_GENERATION);
+
+  return gen;
+}
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 We must ensure that cleanDefinition() does   not remove clauses that are
 valid   for   the   generation   in   the   frame.   This   means   that
@@ -527,6 +558,7 @@ setGenerationFrame__LD(LocalFrame fr ARG_LD)
     if ( unlikely(GD->clauses.cgc_active) )
       cgcActivatePredicate__LD(fr->predicate, gen PASS_LD);
   } while(gen != global_generation());
+  LD->clauses.generation_frames++;	/* see markPredicatesInEnvironments() */
 #endif
 }
 
@@ -604,6 +636,30 @@ popArgvArithStack(int n ARG_LD)
   }
 }
 
+/* floatArgvArithStack() returns the two operands at argv as doubles if at
+   least one is a float and the other is a float or small integer.
+*/
+
+static inline int
+floatArgvArithStack(Number argv, double *d1, double *d2)
+{ if ( argv[0].type == V_FLOAT )
+  { *d1 = argv[0].value.f;
+    if ( argv[1].type == V_FLOAT )
+      *d2 = argv[1].value.f;
+    else if ( argv[1].type == V_INTEGER )
+      *d2 = (double)argv[1].value.i;
+    else
+      return FALSE;
+    return TRUE;
+  } else if ( argv[0].type == V_INTEGER && argv[1].type == V_FLOAT )
+  { *d1 = (double)argv[0].value.i;
+    *d2 = argv[1].value.f;
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
 		 /*******************************
 		 *	      THREADS		*
 		 *******************************/
@@ -40,7 +40,7 @@
 #define LD LOCAL_LD
 
 static
-PRED_IMPL("is_list", 1, is_list, 0)
+PRED_IMPL("is_list", 1, is_list, PL_FA_LEAF)
 { if ( lengthList(A1, FALSE) >= 0 )
     succeed;
 
@@ -704,7 +704,7 @@ out:
 		 *******************************/
 
 BeginPredDefs(list)
-  PRED_DEF("is_list", 1, is_list, 0)
+  PRED_DEF("is_list", 1, is_list, PL_FA_LEAF)
   PRED_DEF("$length", 2, dlength, 0)
   PRED_DEF("memberchk", 2, memberchk, 0)
   PRED_DEF("sort", 2, sort, PL_FA_ISO)
@@ -672,53 +672,53 @@ PRED_IMPL("unify_with_occurs_check", 2, unify_with_occurs_check, 0)
 		*********************************/
 
 static
-PRED_IMPL("nonvar", 1, nonvar, 0)
+PRED_IMPL("nonvar", 1, nonvar, PL_FA_LEAF)
 { PRED_LD
   return PL_is_variable(A1) ? FALSE : TRUE;
 }
 
 static
-PRED_IMPL("var", 1, var, 0)
+PRED_IMPL("var", 1, var, PL_FA_LEAF)
 { PRED_LD
   return PL_is_variable(A1);
 }
 
 static
-PRED_IMPL("integer", 1, integer, 0)
+PRED_IMPL("integer", 1, integer, PL_FA_LEAF)
 { return PL_is_integer(A1);
 }
 
 static
-PRED_IMPL("float", 1, float, 0)
+PRED_IMPL("float", 1, float, PL_FA_LEAF)
 { return PL_is_float(A1);
 }
 
 static
-PRED_IMPL("rational", 1, rational, 0)
+PRED_IMPL("rational", 1, rational, PL_FA_LEAF)
 { return PL_is_rational(A1);
 }
 
 
 #if O_STRING
 static
-PRED_IMPL("string", 1, string, 0)
+PRED_IMPL("string", 1, string, PL_FA_LEAF)
 { return PL_is_string(A1);
 }
 #endif /* O_STRING */
 
 static
-PRED_IMPL("number", 1, number, 0)
+PRED_IMPL("number", 1, number, PL_FA_LEAF)
 { return PL_is_number(A1);
 }
 
 static
-PRED_IMPL("atom", 1, atom, 0)
+PRED_IMPL("atom", 1, atom, PL_FA_LEAF)
 { PRED_LD
   return PL_is_atom(A1);
 }
 
 static
-PRED_IMPL("atomic", 1, atomic, 0)
+PRED_IMPL("atomic", 1, atomic, PL_FA_LEAF)
 { PRED_LD
   return PL_is_atomic(A1);
 }
@@ -806,7 +806,7 @@ PL_is_ground(term_t t)
 
 
 static
-PRED_IMPL("ground", 1, ground, PL_FA_ISO)
+PRED_IMPL("ground", 1, ground, PL_FA_ISO|PL_FA_LEAF)
 { PRED_LD
 
   return ground__LD(valTermRef(A1) PASS_LD) == NULL;
@@ -825,13 +825,13 @@ PRED_IMPL("nonground", 2, nonground, 0)
 
 
 static
-PRED_IMPL("compound", 1, compound, 0)
+PRED_IMPL("compound", 1, compound, PL_FA_LEAF)
 { return PL_is_compound(A1);
 }
 
 
 static
-PRED_IMPL("callable", 1, callable, PL_FA_ISO)
+PRED_IMPL("callable", 1, callable, PL_FA_ISO|PL_FA_LEAF)
 { return PL_is_callable(A1);
 }
 
@@ -1127,7 +1127,7 @@ PL_is_acyclic(term_t t)
 
 
 static
-PRED_IMPL("acyclic_term", 1, acyclic_term, PL_FA_ISO)
+PRED_IMPL("acyclic_term", 1, acyclic_term, PL_FA_ISO|PL_FA_LEAF)
 { PRED_LD
 
   return PL_is_acyclic__LD(A1 PASS_LD);
@@ -1135,7 +1135,7 @@ PRED_IMPL("acyclic_term", 1, acyclic_term, PL_FA_ISO)
 
 
 static
-PRED_IMPL("cyclic_term", 1, cyclic_term, 0)
+PRED_IMPL("cyclic_term", 1, cyclic_term, PL_FA_LEAF)
 { PRED_LD
   int rc;
 
@@ -1604,6 +1604,46 @@ compareStrings(word w1, word w2 ARG_LD)
 }
 
 
+/* compareFloats() compares two floats in the standard order of terms:
+   NaN before all other floats and -0.0 before 0.0.
+*/
+
+int
+compareFloats(double f1, double f2)
+{ if ( memcmp(&f1, &f2, sizeof(f1)) == 0 )
+    return CMP_EQUAL;
+
+  if ( isnan(f1) )
+  { if ( isnan(f2) )
+    { double nf1 = NaN_value(f1);
+      double nf2 = NaN_value(f2);
+
+      if ( nf1 < nf2 )
+      { return CMP_LESS;
+      } else if ( nf1 > nf2 )
+      { return CMP_GREATER;
+      } else if ( signbit(nf1) != signbit(nf2) )
+      { return signbit(nf1) ? CMP_LESS : CMP_GREATER;
+      } else
+      { return CMP_EQUAL;
+      }
+    }
+    return CMP_LESS;
+  } else if ( isnan(f2) )
+  { return CMP_GREATER;
+  }
+
+  if ( f1 < f2 )
+  { return CMP_LESS;
+  } else if ( f1 > f2 )
+  { return CMP_GREATER;
+  } else
+  { assert(signbit(f1) != signbit(f2));
+    return signbit(f1) ? CMP_LESS : CMP_GREATER;
+  }
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 compareStandard(Word p1, Word p2, int eq)
 
@@ -1689,37 +1729,7 @@ compare_primitives(Word p1, Word p2, int eq ARG_LD)
       } else if ( eq )
       { return CMP_NOTEQ;
       } else
-      { double f1 = valFloat(w1);
-	double f2 = valFloat(w2);
-
-	if ( isnan(f1) )
-	{ if ( isnan(f2) )
-	  { double nf1 = NaN_value(f1);
-	    double nf2 = NaN_value(f2);
-
-	    if ( nf1 < nf2 )
-	    { return CMP_LESS;
-	    } else if ( nf1 > nf2 )
-	    { return CMP_GREATER;
-	    } else if ( signbit(nf1) != signbit(nf2) )
-	    { return signbit(nf1) ? CMP_LESS : CMP_GREATER;
-	    } else
-	    { return CMP_EQUAL;
-	    }
-	  }
-	  return CMP_LESS;
-	} else if ( isnan(f2) )
-	{ return CMP_GREATER;
-	}
-
-	if ( f1 < f2 )
-	{ return CMP_LESS;
-	} else if ( f1 > f2 )
-	{ return CMP_GREATER;
-	} else
-	{ assert(signbit(f1) != signbit(f2));
-	  return signbit(f1) ? CMP_LESS : CMP_GREATER;
-	}
+      { return compareFloats(valFloat(w1), valFloat(w2));
       }
     }
     case TAG_ATOM:
@@ -1833,7 +1843,7 @@ compareStandard(Word p1, Word p2, int eq ARG_LD)
 /* compare(-Diff, +T1, +T2) */
 
 static
-PRED_IMPL("compare", 3, compare, PL_FA_ISO)
+PRED_IMPL("compare", 3, compare, PL_FA_ISO|PL_FA_LEAF)
 { PRED_LD
   Word d  = valTermRef(A1);
   Word p1 = valTermRef(A2);
@@ -1876,7 +1886,7 @@ PRED_IMPL("compare", 3, compare, PL_FA_ISO)
 
 
 static
-PRED_IMPL("@<", 2, std_lt, 0)
+PRED_IMPL("@<", 2, std_lt, PL_FA_LEAF)
 { PRED_LD
   Word p1 = valTermRef(A1);
   Word p2 = p1+1;
@@ -1890,7 +1900,7 @@ PRED_IMPL("@<", 2, std_lt, 0)
 
 
 static
-PRED_IMPL("@=<", 2, std_leq, 0)
+PRED_IMPL("@=<", 2, std_leq, PL_FA_LEAF)
 { PRED_LD
   Word p1 = valTermRef(A1);
   Word p2 = p1+1;
@@ -1904,7 +1914,7 @@ PRED_IMPL("@=<", 2, std_leq, 0)
 
 
 static
-PRED_IMPL("@>", 2, std_gt, 0)
+PRED_IMPL("@>", 2, std_gt, PL_FA_LEAF)
 { PRED_LD
   Word p1 = valTermRef(A1);
   Word p2 = p1+1;
@@ -1918,7 +1928,7 @@ PRED_IMPL("@>", 2, std_gt, 0)
 
 
 static
-PRED_IMPL("@>=", 2, std_geq, 0)
+PRED_IMPL("@>=", 2, std_geq, PL_FA_LEAF)
 { PRED_LD
   Word p1 = valTermRef(A1);
   Word p2 = p1+1;
@@ -1935,7 +1945,7 @@ PRED_IMPL("@>=", 2, std_geq, 0)
 		*********************************/
 
 static
-PRED_IMPL("==", 2, equal, 0)
+PRED_IMPL("==", 2, equal, PL_FA_LEAF)
 { PRED_LD
   Word p1 = valTermRef(A1);
   Word p2 = p1+1;
@@ -1949,7 +1959,7 @@ PRED_IMPL("==", 2, equal, 0)
 
 
 static
-PRED_IMPL("\\==", 2, nonequal, 0)
+PRED_IMPL("\\==", 2, nonequal, PL_FA_LEAF)
 { PRED_LD
   Word p1 = valTermRef(A1);
   Word p2 = p1+1;
@@ -2033,7 +2043,7 @@ PRED_IMPL("same_term", 2, same_term, 0)
 /* functor(+Term, -Name, -Arity) */
 /* functor(-Term, +Name, +Arity) */
 
-PRED_IMPL("functor", 3, functor, 0)
+PRED_IMPL("functor", 3, functor, PL_FA_LEAF)
 { PRED_LD
   size_t arity;
   atom_t name;
@@ -3586,7 +3596,7 @@ PRED_IMPL("unifiable", 3, unifiable, 0)
 		 *******************************/
 
 static
-PRED_IMPL("atom_length", 2, atom_length, PL_FA_ISO)
+PRED_IMPL("atom_length", 2, atom_length, PL_FA_ISO|PL_FA_LEAF)
 { PRED_LD
   int flags;
   PL_chars_t txt;
@@ -4674,7 +4684,7 @@ Provisional String manipulation functions.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 static
-PRED_IMPL("string_length", 2, string_length, 0)
+PRED_IMPL("string_length", 2, string_length, PL_FA_LEAF)
 { PRED_LD
   PL_chars_t t;
 
@@ -5324,6 +5334,8 @@ swi_statistics__LD(atom_t key, Number v, PL_local_data_t *ld)
   else if (key == ATOM_collected)
     v->value.i = LD->gc.stats.totals.trail_gained +
                  LD->gc.stats.totals.global_gained;
+  else if (key == ATOM_young_collections)
+    v->value.i = LD->gc.stats.totals.young_collections;
 #ifdef HAVE_BOEHM_GC
   else if ( key == ATOM_heap_gc )
     v->value.i = GC_get_gc_no();
@@ -5349,6 +5361,10 @@ swi_statistics__LD(atom_t key, Number v, PL_local_data_t *ld)
   { v->type = V_FLOAT;
     v->value.f = GD->clauses.cgc_time;
   }
+  else if (key == ATOM_cgc_scans)
+    v->value.i = GD->clauses.cgc_scans;
+  else if (key == ATOM_cgc_scans_skipped)
+    v->value.i = GD->clauses.cgc_scans_skipped;
 #endif
   else if (key == ATOM_global_shifts)
     v->value.i = LD->shift_status.global_shifts;
@@ -5436,6 +5452,9 @@ pl_statistics_ld(term_t k, term_t value, PL_local_data_t *ld ARG_LD)
   }
 #endif /*QP_STATISTICS*/
 
+  if ( key == ATOM_gc_pauses )
+    return unify_pause_histograms(value, ld PASS_LD);
+
   return PL_error("statistics", 2, NULL, ERR_DOMAIN,
 		  PL_new_atom("statistics_key"), k);
 }
@@ -5501,6 +5520,7 @@ static const optdef optdefs[] =
   { "class",		CMDOPT_STRING,  &GD->options.saveclass },
   { "search_paths",	CMDOPT_LIST,	&GD->options.search_paths },
   { "pldoc_server",	CMDOPT_STRING,	&GD->options.pldoc_server },
+  { "lazy_load",	CMDOPT_BOOL,	&GD->options.lazy_load },
 #ifdef __WINDOWS__
   { "win_app",		CMDOPT_BOOL,	&GD->options.win_app },
 #endif
@@ -5615,6 +5635,17 @@ set_pl_option(const char *name, const char *value)
 	  opt_append(l, value);
 	  succeed;
 	}
+	case CMDOPT_BOOL:
+	{ bool *val = d->address;
+
+	  if ( streq(value, "true") )
+	    *val = TRUE;
+	  else if ( streq(value, "false") )
+	    *val = FALSE;
+	  else
+	    fail;
+	  succeed;
+	}
         default:
 	  assert(0);
       }
@@ -5672,34 +5703,34 @@ BeginPredDefs(prims)
   PRED_DEF("\\=", 2, not_unify, PL_FA_ISO)
   PRED_DEF("unify_with_occurs_check", 2, unify_with_occurs_check, PL_FA_ISO)
   PRED_DEF("subsumes_term", 2, subsumes_term, PL_FA_ISO)
-  PRED_DEF("nonvar", 1, nonvar, PL_FA_ISO)
-  PRED_DEF("var", 1, var, PL_FA_ISO)
-  PRED_DEF("integer", 1, integer, PL_FA_ISO)
-  PRED_DEF("float", 1, float, PL_FA_ISO)
-  PRED_DEF("rational", 1, rational, 0)
-  PRED_DEF("number", 1, number, PL_FA_ISO)
+  PRED_DEF("nonvar", 1, nonvar, PL_FA_ISO|PL_FA_LEAF)
+  PRED_DEF("var", 1, var, PL_FA_ISO|PL_FA_LEAF)
+  PRED_DEF("integer", 1, integer, PL_FA_ISO|PL_FA_LEAF)
+  PRED_DEF("float", 1, float, PL_FA_ISO|PL_FA_LEAF)
+  PRED_DEF("rational", 1, rational, PL_FA_LEAF)
+  PRED_DEF("number", 1, number, PL_FA_ISO|PL_FA_LEAF)
   PRED_DEF("arg", 3, arg, PL_FA_NONDETERMINISTIC|PL_FA_ISO)
-  PRED_DEF("atomic", 1, atomic, PL_FA_ISO)
-  PRED_DEF("atom", 1, atom, PL_FA_ISO)
-  PRED_DEF("string", 1, string, 0)
-  PRED_DEF("ground", 1, ground, PL_FA_ISO)
+  PRED_DEF("atomic", 1, atomic, PL_FA_ISO|PL_FA_LEAF)
+  PRED_DEF("atom", 1, atom, PL_FA_ISO|PL_FA_LEAF)
+  PRED_DEF("string", 1, string, PL_FA_LEAF)
+  PRED_DEF("ground", 1, ground, PL_FA_ISO|PL_FA_LEAF)
   PRED_DEF("nonground", 2, nonground, 0)
   PRED_DEF("$term_size", 3, term_size, 0)
-  PRED_DEF("acyclic_term", 1, acyclic_term, PL_FA_ISO)
-  PRED_DEF("cyclic_term", 1, cyclic_term, 0)
+  PRED_DEF("acyclic_term", 1, acyclic_term, PL_FA_ISO|PL_FA_LEAF)
+  PRED_DEF("cyclic_term", 1, cyclic_term, PL_FA_LEAF)
   PRED_DEF("$factorize_term", 3, factorize_term, 0)
-  PRED_DEF("compound", 1, compound, PL_FA_ISO)
-  PRED_DEF("callable", 1, callable, PL_FA_ISO)
-  PRED_DEF("==", 2, equal, PL_FA_ISO)
-  PRED_DEF("\\==", 2, nonequal, PL_FA_ISO)
-  PRED_DEF("compare", 3, compare, PL_FA_ISO)
-  PRED_DEF("@<", 2, std_lt, PL_FA_ISO)
-  PRED_DEF("@=<", 2, std_leq, PL_FA_ISO)
-  PRED_DEF("@>", 2, std_gt, PL_FA_ISO)
-  PRED_DEF("@>=", 2, std_geq, PL_FA_ISO)
+  PRED_DEF("compound", 1, compound, PL_FA_ISO|PL_FA_LEAF)
+  PRED_DEF("callable", 1, callable, PL_FA_ISO|PL_FA_LEAF)
+  PRED_DEF("==", 2, equal, PL_FA_ISO|PL_FA_LEAF)
+  PRED_DEF("\\==", 2, nonequal, PL_FA_ISO|PL_FA_LEAF)
+  PRED_DEF("compare", 3, compare, PL_FA_ISO|PL_FA_LEAF)
+  PRED_DEF("@<", 2, std_lt, PL_FA_ISO|PL_FA_LEAF)
+  PRED_DEF("@=<", 2, std_leq, PL_FA_ISO|PL_FA_LEAF)
+  PRED_DEF("@>", 2, std_gt, PL_FA_ISO|PL_FA_LEAF)
+  PRED_DEF("@>=", 2, std_geq, PL_FA_ISO|PL_FA_LEAF)
   PRED_DEF("?=", 2, can_compare, 0)
   PRED_DEF("same_term", 2, same_term, 0)
-  PRED_DEF("functor", 3, functor, PL_FA_ISO)
+  PRED_DEF("functor", 3, functor, PL_FA_ISO|PL_FA_LEAF)
   PRED_DEF("=..", 2, univ, PL_FA_ISO)
   PRED_DEF("compound_name_arity", 3, compound_name_arity, 0)
   PRED_DEF("compound_name_arguments", 3, compound_name_arguments, 0)
@@ -5728,7 +5759,7 @@ BeginPredDefs(prims)
   PRED_DEF("$inference_limit_false", 1, inference_limit_false, 0)
   PRED_DEF("$inference_limit_except", 3, inference_limit_except, 0)
 #endif
-  PRED_DEF("atom_length", 2, atom_length, PL_FA_ISO)
+  PRED_DEF("atom_length", 2, atom_length, PL_FA_ISO|PL_FA_LEAF)
   PRED_DEF("name", 2, name, 0)
   PRED_DEF("atom_chars", 2, atom_chars, PL_FA_ISO)
   PRED_DEF("atom_codes", 2, atom_codes, PL_FA_ISO)
@@ -5747,7 +5778,7 @@ BeginPredDefs(prims)
   PRED_DEF("atomic_list_concat", 3, atomic_list_concat, 0)
   PRED_DEF("atomic_list_concat", 2, atomic_list_concat, 0)
   PRED_DEF("string_concat", 3, string_concat, PL_FA_NONDETERMINISTIC)
-  PRED_DEF("string_length", 2, string_length, 0)
+  PRED_DEF("string_length", 2, string_length, PL_FA_LEAF)
   PRED_DEF("atomics_to_string", 3, atomics_to_string, 0)
   PRED_DEF("atomics_to_string", 2, atomics_to_string, 0)
   PRED_DEF("sub_atom_icasechk", 3, sub_atom_icasechk, 0)
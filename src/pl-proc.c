@@ -159,12 +159,18 @@ void
 destroyDefinition(Definition def)
 { ATOMIC_DEC(&GD->statistics.predicates);
   ATOMIC_SUB(&def->module->code_size, sizeof(*def));
+#ifdef O_PLMT
+  forgetIndexJobs(def);
+#endif
+  deleteRangeIndexes(def);
 
   freeCodesDefinition(def, FALSE);
 
   if ( false(def, P_FOREIGN|P_THREAD_LOCAL) )	/* normal Prolog predicate */
   { freeHeap(def->impl.any.args, sizeof(arg_info)*def->functor->arity);
     removeClausesPredicate(def, 0, FALSE);
+    if ( def->inlined_by )
+      inlinedPredicateModified(def);
     DEBUG(MSG_CGC_PRED,
 	  Sdprintf("destroyDefinition(%s)\n", predicateName(def)));
     if ( true(def, P_DIRTYREG) )
@@ -319,7 +325,7 @@ bool
 isDefinedProcedure(Procedure proc)
 { Definition def = proc->definition;
 
-  if ( true(def, PROC_DEFINED) )
+  if ( true(def, PROC_DEFINED) || def->lazy )
     succeed;
 
   return hasClausesDefinition(def) ? TRUE : FALSE;
@@ -1148,22 +1154,30 @@ static void
 setLastModifiedPredicate(Definition def, gen_t gen)
 { Module m = def->module;
 
-  def->last_modified = gen;
-
 #ifdef HAVE___SYNC_ADD_AND_FETCH_8
 { gen_t lmm;
 
+  do
+  { lmm = def->last_modified;		/* may be modified unlocked */
+  } while ( lmm < gen &&
+	    !COMPARE_AND_SWAP(&def->last_modified, lmm, gen) );
+
   do
   { lmm = m->last_modified;
   } while ( lmm < gen &&
 	    !COMPARE_AND_SWAP(&m->last_modified, lmm, gen) );
 }
 #else
+  def->last_modified = gen;
+
   LOCKMODULE(m);
   if ( m->last_modified < gen )
     m->last_modified = gen;
   UNLOCKMODULE(m);
 #endif
+
+  if ( def->inlined_by )		/* see inlineClauseBody() */
+    inlinedPredicateModified(def);
 }
 
 
@@ -1189,6 +1203,156 @@ definition this will be  called  and   an  S_TRUSTME  supervisor will be
 installed, causing further clauses to have no effect.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Unlocked assertz/1 and retract/1
+
+Dynamic predicates are often used as a store of facts to which many
+threads add and from which many  threads   remove  facts.  To avoid
+serializing these threads  on  the  predicate   mutex,  assertz/1  of a
+fact and the retract of a fact do  not lock the predicate if the
+predicate has no clause indexes  and  at   least  one  clause.  This
+only covers dynamic predicates that are used  as a small queue or set
+of facts: as soon as the  JIT  creates   a  clause  index  or range
+index (see pl-index.c) for the  predicate,   all  updates use the locked
+path again, as do asserta/1, assertz/1 of a rule, asserting the first
+clause and retracting a rule.  This works as follows:
+
+  - Writers register themselves in def->unlocked_writers and check
+    there are no indexes.  hashDefinition() and getRangeIndex() (for
+    range indexes) wait for the unlocked writers to finish after
+    publishing a new index and before adding the clauses to it.  A writer thus either sees the index and uses
+    the locked path or completes before the clauses are indexed.
+  - appendClauseRef() links the clause using compare-and-swap on the
+    `next` of the last clause, after which `last_clause` is advanced.
+    `last_clause` may lag behind: any writer that finds the last
+    clause has a successor advances it.
+  - The clause is invisible (created is GEN_MAX) until it is linked,
+    after which it gets its generation.  Concurrent asserts may thus
+    end up in the clause list in a different order than their
+    generations, which is fine for the logical update view.
+  - Clause GC (cleanDefinition()) may only unlink the last clause of
+    the predicate while there are no unlocked writers.  It sets
+    unlocked_writers from 0 to -1 while doing so, which makes writers
+    use the locked path.
+  - waitUnlockedWriters() first blocks new writers by subtracting
+    UNLOCKED_WRITERS_BLOCK and then waits for the active writers to
+    leave.  Waiting for the count to become 0 could starve: writers
+    that see the new index briefly increment the count before they
+    back out.  Multiple threads may block at the same time, so the
+    active writers are the count modulo UNLOCKED_WRITERS_BLOCK.
+  - Counters that are updated by unlocked writers are updated using
+    atomic instructions by all writers.  Only facts use the unlocked
+    path, so number_of_rules remains protected by the mutex.
+  - A clause may be erased concurrently by an unlocked retract and a
+    locked one or by reloading a file.  All of these use
+    setErasedClause(), which sets CL_ERASED using compare-and-swap and
+    thus lets exactly one of them erase the clause.  Other updates of
+    clause->flags use set() and clear(), which are atomic as well.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+enterUnlockedWriter(Definition def, Clause clause)
+{ int n;
+
+  if ( false(def, P_DYNAMIC) || false(clause, UNIT_CLAUSE) )
+    return FALSE;
+
+  do
+  { if ( (n=def->unlocked_writers) < 0 )
+      return FALSE;
+  } while ( !COMPARE_AND_SWAP(&def->unlocked_writers, n, n+1) );
+
+  if ( def->impl.clauses.clause_indexes || def->range_indexes ||
+       !def->impl.clauses.last_clause )
+  { ATOMIC_DEC(&def->unlocked_writers);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+static void
+exitUnlockedWriter(Definition def)
+{ ATOMIC_DEC(&def->unlocked_writers);
+}
+
+
+/* Set CL_ERASED.  Returns FALSE if the clause was already erased */
+
+static int
+setErasedClause(Clause clause)
+{ unsigned int flags;
+
+  do
+  { flags = clause->flags;
+    if ( (flags & CL_ERASED) )
+      return FALSE;
+  } while ( !COMPARE_AND_SWAP(&clause->flags, flags, flags|CL_ERASED) );
+
+  return TRUE;
+}
+
+
+#define UNLOCKED_WRITERS_BLOCK 0x10000000
+
+/* The count is writers - blockers*UNLOCKED_WRITERS_BLOCK - cleaners.
+   There is at most one cleaner, which only enters if there are no
+   writers.  For a negative count, `%` gives (writers-cleaners) - BLOCK
+   if there are writers and 0 or -1 otherwise.
+*/
+
+static int
+activeUnlockedWriters(Definition def)
+{ int n = def->unlocked_writers;
+
+  if ( n >= 0 )
+    return n;
+  n %= UNLOCKED_WRITERS_BLOCK;
+  return n < -1 ? n + UNLOCKED_WRITERS_BLOCK : 0;
+}
+
+
+void
+waitUnlockedWriters(Definition def)
+{
+#ifdef O_PLMT
+  ATOMIC_SUB(&def->unlocked_writers, UNLOCKED_WRITERS_BLOCK);
+  while ( activeUnlockedWriters(def) > 0 )
+    sched_yield();
+  ATOMIC_ADD(&def->unlocked_writers, UNLOCKED_WRITERS_BLOCK);
+#endif
+}
+
+
+static void
+appendClauseRef(ClauseList cl, ClauseRef cref)
+{ for(;;)
+  { ClauseRef last = cl->last_clause;
+    ClauseRef next = last->next;
+
+    if ( next )
+    { COMPARE_AND_SWAP(&cl->last_clause, last, next);
+      continue;
+    }
+    if ( COMPARE_AND_SWAP(&last->next, NULL, cref) )
+    { COMPARE_AND_SWAP(&cl->last_clause, last, cref);
+      return;
+    }
+  }
+}
+
+
+static void
+setCreatedClause(Definition def, Clause clause)
+{
+#ifdef O_LOGICAL_UPDATE
+  clause->generation.created = next_global_generation();
+  setLastModifiedPredicate(def, clause->generation.created);
+#endif
+}
+
+
 ClauseRef
 assertProcedure(Procedure proc, Clause clause, ClauseRef where ARG_LD)
 { Definition def = getProcDefinition(proc);
@@ -1197,6 +1361,29 @@ assertProcedure(Procedure proc, Clause clause, ClauseRef where ARG_LD)
 
   argKey(clause->codes, 0, &key);
   cref = newClauseRef(clause, key);
+#ifdef O_LOGICAL_UPDATE
+  clause->generation.created = GEN_MAX;	/* invisible until linked */
+  clause->generation.erased  = GEN_MAX;	/* infinite */
+#endif
+
+  if ( where == CL_END )
+  { acquire_def(def);
+    if ( enterUnlockedWriter(def, clause) )
+    { unsigned int nc;
+
+      appendClauseRef(&def->impl.clauses, cref);
+      nc = ATOMIC_INC(&def->impl.clauses.number_of_clauses);
+      ATOMIC_INC(&GD->statistics.clauses);
+      setCreatedClause(def, clause);
+      exitUnlockedWriter(def);
+      release_def(def);
+      if ( (nc & (nc-1)) == 0 )
+	reconsiderIndexes(def);
+
+      return cref;
+    }
+    release_def(def);
+  }
 
   LOCKDEF(def);
   acquire_def(def);
@@ -1206,10 +1393,7 @@ assertProcedure(Procedure proc, Clause clause, ClauseRef where ARG_LD)
   { cref->next = def->impl.clauses.first_clause;
     def->impl.clauses.first_clause = cref;
   } else if ( where == CL_END )
-  { ClauseRef last = def->impl.clauses.last_clause;
-
-    last->next = cref;
-    def->impl.clauses.last_clause = cref;
+  { appendClauseRef(&def->impl.clauses, cref);
   } else				/* insert before */
   { ClauseRef cr;
 
@@ -1223,15 +1407,11 @@ assertProcedure(Procedure proc, Clause clause, ClauseRef where ARG_LD)
     assert(cr);
   }
 
-  def->impl.clauses.number_of_clauses++;
+  ATOMIC_INC(&def->impl.clauses.number_of_clauses);
   if ( false(clause, UNIT_CLAUSE) )
     def->impl.clauses.number_of_rules++;
   ATOMIC_INC(&GD->statistics.clauses);
-#ifdef O_LOGICAL_UPDATE
-  clause->generation.created = next_global_generation();
-  clause->generation.erased  = GEN_MAX;	/* infinite */
-  setLastModifiedPredicate(def, clause->generation.created);
-#endif
+  setCreatedClause(def, clause);
 
   if ( false(def, P_DYNAMIC) )		/* see (*) above */
     freeCodesDefinition(def, TRUE);
@@ -1244,6 +1424,97 @@ assertProcedure(Procedure proc, Clause clause, ClauseRef where ARG_LD)
   return cref;
 }
 
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+assertProcedureList() adds count clauses  to  the   end  of  the dynamic
+predicate proc while holding the lock only   once. The clauses are linked
+invisible (created is GEN_MAX). The caller  is responsible for giving them
+a  generation  and  updating  the   last_modified  generation  of  the
+predicate after all clauses have been   linked, making them visible
+together. See assertz_terms() in pl-comp.c.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+assertProcedureList(Procedure proc, Clause *clauses, size_t count ARG_LD)
+{ Definition def = getProcDefinition(proc);
+  ClauseRef first = NULL, last = NULL;
+  size_t i, rules = 0;
+
+  if ( count == 0 )
+    return;
+
+  for(i=0; i<count; i++)
+  { Clause clause = clauses[i];
+    ClauseRef cref;
+    word key;
+
+    argKey(clause->codes, 0, &key);
+    cref = newClauseRef(clause, key);
+#ifdef O_LOGICAL_UPDATE
+    clause->generation.created = GEN_MAX;	/* see assertz_terms() */
+    clause->generation.erased  = GEN_MAX;
+#endif
+    if ( false(clause, UNIT_CLAUSE) )
+      rules++;
+
+    if ( last )
+      last->next = cref;
+    else
+      first = cref;
+    last = cref;
+  }
+
+  LOCKDEF(def);
+  acquire_def(def);
+  if ( !def->impl.clauses.last_clause )
+  { def->impl.clauses.first_clause = first;
+    def->impl.clauses.last_clause  = last;
+  } else
+  { appendClauseRef(&def->impl.clauses, first);
+    COMPARE_AND_SWAP(&def->impl.clauses.last_clause, first, last);
+  }
+
+  ATOMIC_ADD(&def->impl.clauses.number_of_clauses, (unsigned int)count);
+  def->impl.clauses.number_of_rules += (unsigned int)rules;
+  ATOMIC_ADD(&GD->statistics.clauses, count);
+
+  addClausesToIndexes(def, first, count);
+  release_def(def);
+  DEBUG(CHK_SECURE, checkDefinition(def));
+  UNLOCKDEF(def);
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+publishClauses() makes clauses linked   by assertProcedureList() visible.
+procs[i] is the procedure of clauses[i].  We  hold L_GENERATION, so no
+other thread can advance the global generation while we give all clauses
+the next generation. The clauses become  visible together when we finally
+advance the global generation.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+publishClauses(Procedure *procs, Clause *clauses, size_t count ARG_LD)
+{
+#ifdef O_LOGICAL_UPDATE
+  gen_t gen;
+  size_t i;
+
+  if ( count == 0 )
+    return;
+
+  PL_LOCK(L_GENERATION);
+  gen = global_generation()+1;
+  for(i=0; i<count; i++)
+  { clauses[i]->generation.created = gen;
+    if ( i == 0 || procs[i] != procs[i-1] )
+      setLastModifiedPredicate(getProcDefinition(procs[i]), gen);
+  }
+  next_global_generation_unlocked();
+  PL_UNLOCK(L_GENERATION);
+#endif
+}
+
 /*  Abolish a procedure.  Referenced  clauses  are   unlinked  and left
     dangling in the dark until the procedure referencing it deletes it.
 
@@ -1317,21 +1588,28 @@ removeClausesPredicate(Definition def, int sfindex, int fromfile)
   if ( true(def, P_THREAD_LOCAL) )
     return 0;
 
+  if ( def->lazy )
+  { if ( sfindex )
+      loadLazyDefinition(def);
+    else
+      discardLazyDefinition(def);
+  }
+
   acquire_def(def);
   for(c = def->impl.clauses.first_clause; c; c = c->next)
   { Clause cl = c->value.clause;
 
     if ( (sfindex == 0 || sfindex == cl->owner_no) &&
 	 (!fromfile || cl->line_no > 0) &&
-	 false(cl, CL_ERASED) )
-    { set(cl, CL_ERASED);
+	 setErasedClause(cl) )
+    {
 #ifdef O_LOGICAL_UPDATE
       cl->generation.erased = update;
 #endif
       deleted++;
       memory += sizeofClause(cl->code_size) + SIZEOF_CREF_CLAUSE;
-      def->impl.clauses.number_of_clauses--;
-      def->impl.clauses.erased_clauses++;
+      ATOMIC_DEC(&def->impl.clauses.number_of_clauses);
+      ATOMIC_INC(&def->impl.clauses.erased_clauses);
       if ( false(cl, UNIT_CLAUSE) )
 	def->impl.clauses.number_of_rules--;
       deleteActiveClauseFromIndexes(def, cl);
@@ -1344,7 +1622,8 @@ removeClausesPredicate(Definition def, int sfindex, int fromfile)
     next_global_generation();
 
   if ( deleted )
-  { ATOMIC_SUB(&def->module->code_size, memory);
+  { setLastModifiedPredicate(def, update);
+    ATOMIC_SUB(&def->module->code_size, memory);
     ATOMIC_ADD(&GD->clauses.erased_size, memory);
     ATOMIC_ADD(&GD->clauses.erased, deleted);
 
@@ -1366,28 +1645,39 @@ int
 retractClauseDefinition(Definition def, Clause clause)
 { GET_LD
   size_t size = sizeofClause(clause->code_size) + SIZEOF_CREF_CLAUSE;
+  int unlocked;
 
   assert(true(def, P_DYNAMIC));
 
-  LOCKDEF(def);
-  if ( true(clause, CL_ERASED) )
-  { UNLOCKDEF(def);
+  if ( !(unlocked=enterUnlockedWriter(def, clause)) )
+  { LOCKDEF(def);
+    DEBUG(CHK_SECURE, checkDefinition(def));
+  }
+  if ( !setErasedClause(clause) )
+  { if ( unlocked )
+      exitUnlockedWriter(def);
+    else
+      UNLOCKDEF(def);
     return FALSE;
   }
 
-  DEBUG(CHK_SECURE, checkDefinition(def));
-  set(clause, CL_ERASED);
-  deleteActiveClauseFromIndexes(def, clause); /* just updates "dirtyness" */
-  def->impl.clauses.number_of_clauses--;
-  def->impl.clauses.erased_clauses++;
-  if ( false(clause, UNIT_CLAUSE) )
-    def->impl.clauses.number_of_rules--;
+  if ( !unlocked )
+  { deleteActiveClauseFromIndexes(def, clause); /* just updates "dirtyness" */
+    if ( false(clause, UNIT_CLAUSE) )
+      def->impl.clauses.number_of_rules--;
+  }
+  ATOMIC_DEC(&def->impl.clauses.number_of_clauses);
+  ATOMIC_INC(&def->impl.clauses.erased_clauses);
 #ifdef O_LOGICAL_UPDATE
   clause->generation.erased = next_global_generation();
   setLastModifiedPredicate(def, clause->generation.erased);
 #endif
-  DEBUG(CHK_SECURE, checkDefinition(def));
-  UNLOCKDEF(def);
+  if ( unlocked )
+  { exitUnlockedWriter(def);
+  } else
+  { DEBUG(CHK_SECURE, checkDefinition(def));
+    UNLOCKDEF(def);
+  }
 
 					/* update stats */
   registerRetracted(clause);
@@ -1545,7 +1835,17 @@ cleanDefinition(Definition def, DirtyDefInfo ddi, gen_t start, int *rcp)
     { Clause cl = cref->value.clause;
 
       if ( true(cl, CL_ERASED) && cl->generation.erased < active )
-      { if ( !announceErasedClause(cl) )
+      { int blocked = FALSE;
+
+	if ( !cref->next )		/* last clause: see assertProcedure() */
+	{ if ( !COMPARE_AND_SWAP(&def->unlocked_writers, 0, -1) )
+	  { prev = cref;		/* leave it for the next run */
+	    continue;
+	  }
+	  blocked = TRUE;
+	}
+
+	if ( !announceErasedClause(cl) )
 	  *rcp = FALSE;
 
 	LOCKDEF(def);
@@ -1560,7 +1860,9 @@ cleanDefinition(Definition def, DirtyDefInfo ddi, gen_t start, int *rcp)
 	    def->impl.clauses.last_clause = prev;
 	}
 	removed++;
-	def->impl.clauses.erased_clauses--;
+	ATOMIC_DEC(&def->impl.clauses.erased_clauses);
+	if ( blocked )			/* waitUnlockedWriters() may */
+	  ATOMIC_INC(&def->unlocked_writers); /* have blocked as well */
 	UNLOCKDEF(def);
 
 	lingerClauseRef(cref);
@@ -1621,13 +1923,12 @@ reconsultFinalizePredicate(sf_reload *rl, Definition def, p_reload *r ARG_LD)
     for(cref = def->impl.clauses.first_clause; cref; cref=cref->next)
     { Clause cl = cref->value.clause;
 
-      if ( cl->generation.erased == rl->reload_gen && false(cl, CL_ERASED) )
-      { set(cl, CL_ERASED);
-	cl->generation.erased = update;
+      if ( cl->generation.erased == rl->reload_gen && setErasedClause(cl) )
+      { cl->generation.erased = update;
 	deleted++;
 	memory += sizeofClause(cl->code_size) + SIZEOF_CREF_CLAUSE;
-	def->impl.clauses.number_of_clauses--;
-	def->impl.clauses.erased_clauses++;
+	ATOMIC_DEC(&def->impl.clauses.number_of_clauses);
+	ATOMIC_INC(&def->impl.clauses.erased_clauses);
 	if ( false(cl, UNIT_CLAUSE) )
 	  def->impl.clauses.number_of_rules--;
 	if ( true(def, P_DYNAMIC) )
@@ -1665,6 +1966,89 @@ reconsultFinalizePredicate(sf_reload *rl, Definition def, p_reload *r ARG_LD)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+replaceClausesDefinition() replaces the clauses old[i]  of the static
+predicate def by new[i], such that   each new clause takes the position
+of the old one. This  is  used  by  recompileDefinition()  in pl-comp.c.
+As with reconsultFinalizePredicate(), the new clauses  become visible in
+the generation in which the old ones are erased.  Frames running an old
+clause continue using it until clause GC   reclaims it. If an old clause
+has been erased in the meanwhile, its replacement is discarded.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+replaceClausesDefinition(Definition def, Clause *old, Clause *new,
+			 size_t count ARG_LD)
+{ gen_t update;
+  size_t i;
+  size_t deleted = 0;
+  size_t memory  = 0;
+
+  assert(false(def, P_DYNAMIC));
+
+  LOCKDEF(def);
+  acquire_def(def);
+  update = global_generation()+1;	/* see reconsultFinalizePredicate() */
+  for(i=0; i<count; i++)
+  { Clause ocl = old[i];
+    Clause ncl = new[i];
+    ClauseRef prev = NULL;
+    ClauseRef cref;
+
+    for(cref = def->impl.clauses.first_clause; cref; cref=cref->next)
+    { if ( cref->value.clause == ocl )
+	break;
+      prev = cref;
+    }
+
+    if ( cref && false(ocl, CL_ERASED) )
+    { ClauseRef ncref;
+      word key;
+
+      argKey(ncl->codes, 0, &key);
+      ncref = newClauseRef(ncl, key);
+      ncl->generation.created = update;
+      ncl->generation.erased  = GEN_MAX;
+      ncref->next = cref;
+      if ( prev )
+	prev->next = ncref;
+      else
+	def->impl.clauses.first_clause = ncref;
+      ATOMIC_INC(&GD->statistics.clauses);
+      addClauseToIndexes(def, ncl, cref);
+
+      setErasedClause(ocl);		/* static: cannot fail */
+      ocl->generation.erased = update;
+      ATOMIC_INC(&def->impl.clauses.erased_clauses);
+      registerRetracted(ocl);
+      memory += sizeofClause(ocl->code_size) + SIZEOF_CREF_CLAUSE;
+      deleted++;
+    } else
+    { ATOMIC_SUB(&def->module->code_size,
+		 sizeofClause(ncl->code_size) + SIZEOF_CREF_CLAUSE);
+      freeClause(ncl);
+    }
+  }
+  if ( deleted )
+    freeCodesDefinition(def, TRUE);
+  release_def(def);
+
+  if ( global_generation() < update )
+    next_global_generation();
+  DEBUG(CHK_SECURE, checkDefinition(def));
+  UNLOCKDEF(def);
+
+  if ( deleted )
+  { setLastModifiedPredicate(def, update);
+    ATOMIC_SUB(&def->module->code_size, memory);
+    ATOMIC_ADD(&GD->clauses.erased_size, memory);
+    ATOMIC_ADD(&GD->clauses.erased, deleted);
+
+    registerDirtyDefinition(def PASS_LD);
+  }
+}
+
+
 		 /*******************************
 		 *	  META PREDICATE	*
 		 *******************************/
@@ -1930,7 +2314,10 @@ CGC builds on the following components and invariants:
   - CGC does:
     - Set the dirty generation of all dirty predicates to GEN_MAX
     - markPredicatesInEnvironments() finds all referenced predicates
-      from frames and pushed explicitly by pushPredicateAccess()
+      from frames and pushed explicitly by pushPredicateAccess().  The
+      stack of a thread that did not create any frames since the last
+      scan is not scanned again.  Instead, the oldest generations found
+      by the previous scan are used.
     - Remove all ClauseRefs pointing at clauses removed before the
       oldest active generation from the clause list.  Keep them using
       lingerClauseRef() as someone may be traversing the clause list.
@@ -2012,6 +2399,10 @@ PRED_IMPL("$cgc_params", 6, cgc_params, 0)
 (*) We set the initial oldest_generation to "very old" (0). This ensures
 that if a predicate is  registered   dirty  before clause-gc starts, the
 oldest generation is 0 and thus no clause reference will be collected.
+
+(**) Incrementing the epoch invalidates the   cached  stack marks of all
+threads. See markPredicatesInEnvironments(). We must  do this after the
+predicate is added to the table.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 static void
@@ -2021,8 +2412,9 @@ registerDirtyDefinition(Definition def ARG_LD)
 
     ddi->oldest_generation = GEN_NEW_DIRTY;		/* see (*) */
     if ( addHTable(GD->procedures.dirty, def, ddi) == ddi )
-      set(def, P_DIRTYREG);
-    else
+    { set(def, P_DIRTYREG);
+      ATOMIC_INC(&GD->clauses.dirty_epoch);	/* see (**) */
+    } else
       PL_free(ddi);			/* someone else did this */
   }
   if ( !isSignalledGCThread(SIG_CLAUSE_GC PASS_LD) &&	/* already asked for */
@@ -2105,6 +2497,7 @@ pl_garbage_collect_clauses(void)
   { size_t removed = 0;
     size_t erased_pending = GD->clauses.erased_size;
     double gct, t0 = ThreadCPUTime(LD, CPU_USER);
+    double wall0 = WallTime();
     gen_t start_gen = global_generation();
     int verbose = truePrologFlag(PLFLAG_TRACE_GC) && !LD->in_print_message;
 
@@ -2167,6 +2560,7 @@ pl_garbage_collect_clauses(void)
     GD->clauses.cgc_count++;
     GD->clauses.cgc_reclaimed	+= removed;
     GD->clauses.cgc_time        += (gct=ThreadCPUTime(LD, CPU_USER) - t0);
+    record_pause(PL_PAUSE_CGC, WallTime()-wall0 PASS_LD);
     GD->clauses.erased_size_last = GD->clauses.erased_size;
 
     DEBUG(MSG_CGC, Sdprintf("CGC: removed %ld clauses "
@@ -2400,7 +2794,10 @@ trapUndefined(Definition def ARG_LD)
   retry:
 					/* Auto import */
   if ( (newdef = autoImport(functor->functor, module)) )
+  { if ( newdef->lazy )			/* clauses still in QLF file */
+      loadLazyDefinition(newdef);
     return newdef;
+  }
 					/* Pred/Module does not want to trap */
   if ( true(def, PROC_DEFINED) ||
        getUnknownModule(module) == UNKNOWN_FAIL )
@@ -2896,7 +3293,9 @@ pl_get_predicate_attribute(term_t pred,
       fail;
     return PL_unify_atom(value, def->module->name);
   } else if ( key == ATOM_indexed )
-  { return unify_index_pattern(proc, value);
+  { return unify_index_pattern(proc, value, FALSE);
+  } else if ( key == ATOM_list_indexed )
+  { return unify_index_pattern(proc, value, TRUE);
   } else if ( key == ATOM_meta_predicate )
   { if ( false(def, P_META) )
       fail;
@@ -305,6 +305,9 @@ static struct signame
 #endif
   { SIG_CLAUSE_GC,     "prolog:clause_gc",     0 },
   { SIG_PLABORT,       "prolog:abort",         0 },
+#ifdef SIG_TASK_CANCEL
+  { SIG_TASK_CANCEL,   "prolog:task_cancel",   0 },
+#endif
 
   { -1,		NULL,     0}
 };
@@ -712,6 +715,14 @@ gc_tune_handler(int sig)
   call_tune_gc_hook();
 }
 
+static void
+inline_handler(int sig)
+{ GET_LD
+  (void)sig;
+
+  reinlinePredicates(PASS_LD1);
+}
+
 static void
 cgc_handler(int sig)
 { (void)sig;
@@ -791,11 +802,15 @@ initSignals(void)
 
   PL_signal(SIG_GC|PL_SIGSYNC,	          gc_handler);
   PL_signal(SIG_TUNE_GC|PL_SIGSYNC,	  gc_tune_handler);
+  PL_signal(SIG_INLINE|PL_SIGSYNC,	  inline_handler);
   PL_signal(SIG_CLAUSE_GC|PL_SIGSYNC,     cgc_handler);
   PL_signal(SIG_PLABORT|PL_SIGSYNC,       abort_handler);
 #ifdef SIG_THREAD_SIGNAL
   PL_signal(SIG_THREAD_SIGNAL|PL_SIGSYNC, executeThreadSignals);
 #endif
+#ifdef SIG_TASK_CANCEL
+  PL_signal(SIG_TASK_CANCEL|PL_SIGSYNC,   executeTaskCancel);
+#endif
 #ifdef SIG_ATOM_GC
   PL_signal(SIG_ATOM_GC|PL_SIGSYNC,       agc_handler);
 #endif
@@ -1269,7 +1284,9 @@ PRED_IMPL("$on_signal", 4, on_signal, 0)
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 initPrologStacks() creates the stacks for the calling thread. It is used
 both at system startup to create the stack   for the main thread as from
-pl-thread.c to create stacks for Prolog threads.
+pl-thread.c to create stacks for Prolog threads.  If the thread reuses
+the local data of a pooled engine, the stacks are already there and only
+need to be emptied.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 int
@@ -1277,6 +1294,10 @@ initPrologStacks(size_t limit)
 { GET_LD
 
   LD->stacks.limit = limit;
+  if ( gBase )				/* recycled engine (pl-thread.c) */
+  { emptyStacks();
+    return TRUE;
+  }
   if ( !allocStacks() )
     return FALSE;
 
@@ -1421,6 +1442,8 @@ allocStacks(void)
 	     "trail",    itrail,  256*SIZEOF_VOIDP, TRUE);
   init_stack((Stack)&LD->stacks.argument,
 	     "argument", minarg,  0,                FALSE);
+  if ( truePrologFlag(PLFLAG_GC_GENERATIONAL) )
+    setGCPolicy(GC_GENERATIONAL_POLICY PASS_LD);
 
   LD->stacks.local.min_free = LOCAL_MARGIN;
 
@@ -1552,6 +1575,19 @@ gcPolicy(Stack s, int policy)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+setGCPolicy() sets the policy  for  the   global  stack  of the calling
+thread.  Using GC_GENERATIONAL_POLICY, most collections only process the
+data created since the previous collection.   See "GENERATIONAL GC" in
+pl-gc.c.  This is controlled by the Prolog flag gc_generational.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+setGCPolicy(int policy ARG_LD)
+{ gcPolicy((Stack)&LD->stacks.global, policy);
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 trimStacks() reclaims all unused space on the stack.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
@@ -1618,6 +1654,8 @@ freePrologLocalData(PL_local_data_t *ld)
   }
 
   freeVarDefs(ld);
+  freeInlineRefs(ld->comp.inline_pending);
+  ld->comp.inline_pending = NULL;
 
 #ifdef O_GVAR
   if ( ld->gvar.nb_vars )
@@ -770,6 +770,13 @@ startReconsultFile(SourceFile sf)
   if ( (r = allocHeap(sizeof(*sf->reload))) )
   { ListCell cell, next;
 
+    for(cell = sf->procedures; cell; cell = cell->next)
+    { Procedure proc = cell->value;
+
+      if ( proc->definition->lazy )	/* reload compares the clauses */
+	loadLazyDefinition(proc->definition);
+    }
+
     memset(r, 0, sizeof(*r));
     r->procedures        = newHTable(16);
     r->reload_gen        = GEN_RELOAD;
@@ -1497,10 +1504,47 @@ PRED_IMPL("$start_consult", 2, start_consult, 0)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+inlineSourceFile() is called after a file has been loaded if the flag
+optimise_inline is true. It inlines calls to predicates that are defined
+after the caller and recompiles callers whose inlined predicates changed
+while the file was being reloaded.  See inlineClauseBody().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+inlineSourceFile(SourceFile sf)
+{ GET_LD
+  tmp_buffer buf;
+  ListCell cell;
+  size_t i, count;
+
+  initBuffer(&buf);
+  LOCKSRCFILE(sf);
+  for(cell=sf->procedures; cell; cell = cell->next)
+  { Procedure proc = cell->value;
+
+    addBuffer(&buf, proc->definition, Definition);
+  }
+  UNLOCKSRCFILE(sf);
+
+  count = entriesBuffer(&buf, Definition);
+  for(i=0; i<count; i++)
+    inlineDefinition(baseBuffer(&buf, Definition)[i] PASS_LD);
+  discardBuffer(&buf);
+}
+
+
 int
 endConsult(SourceFile f)
-{ f->current_procedure = NULL;
-  return endReconsult(f);
+{ GET_LD
+  int rc;
+
+  f->current_procedure = NULL;
+  rc = endReconsult(f);
+  if ( rc && truePrologFlag(PLFLAG_OPTIMISE_INLINE) )
+    inlineSourceFile(f);
+
+  return rc;
 }
 
 
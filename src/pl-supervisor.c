@@ -49,12 +49,32 @@ allocCodes(size_t n)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+forAtomsInSupervisor() calls func on the atom keys   of  the S_CASE entries
+of an S_SWITCH supervisor.  Each entry holds  a reference to its atom,
+such that atom garbage collection cannot reclaim   the key while the
+supervisor exists.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+forAtomsInSupervisor(Code codes, size_t size, void (*func)(atom_t a))
+{ Code PC, ep = codes+size;
+
+  for(PC=codes; PC < ep; PC = stepPC(PC))
+  { if ( decode(*PC) == S_CASE && isAtom(PC[1]) )
+      (*func)(PC[1]);
+  }
+}
+
+
 static void
 freeCodes(Code codes)
 { size_t size = (size_t)codes[-1];
 
   if ( size > 0 )		/* 0: built-in, see initSupervisors() */
+  { forAtomsInSupervisor(codes, size, PL_unregister_atom);
     freeHeap(&codes[-1], (size+1)*sizeof(code));
+  }
 }
 
 
@@ -87,7 +107,7 @@ freeCodesDefinition(Definition def, int do_linger)
       { if ( do_linger )
 	  linger(&def->lingering, free_codes_ptr, codes);
 	else
-	  freeHeap(&codes[-1], (size+1)*sizeof(code));
+	  freeCodes(codes);
       }
     } else
       def->codes = SUPERVISOR(virgin);
@@ -269,6 +289,138 @@ listSupervisor(Definition def)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+switchSupervisor() creates a supervisor for  static predicates with 2 to
+MAX_SWITCH_CLAUSES clauses that  all  have  a   different  key  on the
+first argument (atoms, small integers, other constants or functors). A
+call with a bound first argument  can   match  at  most one clause. The
+supervisor embeds a perfect hash table  over   the  keys, which selects
+this clause without using the clause  indexes   or  creating  a choice
+point. The code is
+
+	S_SWITCH <mask> <shift>
+	S_CASE <key> <clause>		(mask+1 times)
+
+The slot of a key is  switchSlot(key,   shift,  mask). We search for a
+table size and shift for which  the   keys  use distinct slots. Unused
+slots are filled with  a  copy  of  another   entry.  As  no other key
+hashes to this slot, the key comparison   in  S_SWITCH fails for them.
+S_CASE is never executed; it only makes the table look like VM code for
+vm_list/1 and friends.  Its opcode  tells   the  type of the key: S_CASE
+for an atom or small integer,  S_FCASE   for  a functor and S_HCASE for
+the hash of another constant (see  switchCase()). If the first argument
+is unbound, S_SWITCH continues as S_STATIC.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define MAX_SWITCH_CLAUSES 32
+
+static int
+perfectSwitchHash(word *keys, int n, size_t mask, unsigned int *shiftp)
+{ unsigned int shift;
+  char used[4*MAX_SWITCH_CLAUSES];
+
+  for(shift=0; shift <= 56; shift++)
+  { int i;
+
+    memset(used, 0, mask+1);
+    for(i=0; i<n; i++)
+    { size_t slot = switchSlot(keys[i], shift, mask);
+
+      if ( used[slot] )
+	break;
+      used[slot] = TRUE;
+    }
+    if ( i == n )
+    { *shiftp = shift;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+
+static vmi
+switchCase(Code PC, word key)
+{ if ( isFunctor(key) )
+    return S_FCASE;
+
+  for(;; PC = stepPC(PC))
+  { switch(fetchop(PC))
+    { case I_NOP:
+	continue;
+      case H_ATOM:
+      case H_SMALLINT:
+      case H_NIL:
+	return S_CASE;
+      default:				/* hashed constant */
+	return S_HCASE;
+    }
+  }
+}
+
+
+static Code
+switchSupervisor(Definition def)
+{ int n = def->impl.clauses.number_of_clauses;
+
+  if ( n >= 2 && n <= MAX_SWITCH_CLAUSES && def->functor->arity > 0 )
+  { ClauseRef cref[MAX_SWITCH_CLAUSES];
+    word keys[MAX_SWITCH_CLAUSES];
+    size_t mask;
+    unsigned int shift;
+    int i, j;
+
+    if ( getClauses(def, cref, MAX_SWITCH_CLAUSES) != n )
+      return NULL;
+    for(i=0; i<n; i++)
+    { if ( !argKey(cref[i]->value.clause->codes, 0, &keys[i]) )
+	return NULL;
+      for(j=0; j<i; j++)
+      { if ( keys[j] == keys[i] )
+	  return NULL;
+      }
+    }
+
+    for(mask=1; mask < (size_t)n; mask = mask*2+1)
+      ;
+    for(; mask < 4*MAX_SWITCH_CLAUSES; mask = mask*2+1)
+    { if ( perfectSwitchHash(keys, n, mask, &shift) )
+      { Code codes = allocCodes(3+3*(mask+1));
+	Code table = codes+3;
+
+	DEBUG(1, Sdprintf("Switch supervisor for %s (%d clauses, %d slots)\n",
+			  predicateName(def), n, (int)(mask+1)));
+
+	codes[0] = encode(S_SWITCH);
+	codes[1] = (code)mask;
+	codes[2] = (code)shift;
+	memset(table, 0, 3*(mask+1)*sizeof(code));
+	for(i=0; i<n; i++)
+	{ Code e = table + 3*switchSlot(keys[i], shift, mask);
+
+	  e[0] = encode(switchCase(cref[i]->value.clause->codes, keys[i]));
+	  e[1] = (code)keys[i];
+	  e[2] = (code)cref[i];
+	}
+	for(j=0; j<=(int)mask; j++)
+	{ Code e = table + 3*j;
+
+	  if ( !e[0] )
+	    memcpy(e, table + 3*switchSlot(keys[0], shift, mask),
+		   3*sizeof(code));
+	}
+	forAtomsInSupervisor(codes, 3+3*(mask+1), PL_register_atom);
+
+	return codes;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+
 static Code
 multifileSupervisor(Definition def)
 { if ( true(def, (P_DYNAMIC|P_MULTIFILE)) )
@@ -300,6 +452,7 @@ copySuperVisorCode(Buffer buf, Code add)
 { size_t len = supervisorLength(add);
 
   addMultipleBuffer(buf, add, len, code);
+  forAtomsInSupervisor(add, len, PL_register_atom); /* caller frees add */
 }
 
 
@@ -380,6 +533,7 @@ createSupervisor(Definition def)
 	       (codes = multifileSupervisor(def)) ||
 	       (codes = singleClauseSupervisor(def)) ||
 	       (codes = listSupervisor(def)) ||
+	       (codes = switchSupervisor(def)) ||
 	       (codes = staticSupervisor(def)));
   assert(has_codes);
   codes = chainMetaPredicateSupervisor(def, codes);
@@ -309,7 +309,9 @@ counting_mutex _PL_mutexes[] =
   COUNT_MUTEX_INITIALIZER("L_SORTR"),
   COUNT_MUTEX_INITIALIZER("L_UMUTEX"),
   COUNT_MUTEX_INITIALIZER("L_INIT_ATOMS"),
-  COUNT_MUTEX_INITIALIZER("L_CGCGEN")
+  COUNT_MUTEX_INITIALIZER("L_CGCGEN"),
+  COUNT_MUTEX_INITIALIZER("L_QLF"),
+  COUNT_MUTEX_INITIALIZER("L_GENERATION")
 #ifdef __WINDOWS__
 , COUNT_MUTEX_INITIALIZER("L_DDE")
 , COUNT_MUTEX_INITIALIZER("L_CSTACK")
@@ -435,7 +437,7 @@ win_thread_initialize(void)
 		 *	  LOCAL PROTOTYPES	*
 		 *******************************/
 
-static PL_thread_info_t *alloc_thread(void);
+static PL_thread_info_t *alloc_thread(int pooled);
 static void	destroy_message_queue(message_queue *queue);
 static void	destroy_thread_message_queue(message_queue *queue);
 static void	init_message_queue(message_queue *queue, size_t max_size);
@@ -581,6 +583,91 @@ maybe_free_local_data(PL_local_data_t *ld)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Engine pool.  Engines created with PL_THREAD_POOLED (engine_create/4
+option pool(true)) do not release their local data and stacks when they
+are destroyed.  Instead, freePrologThread() runs the normal cleanup,
+empties and trims the stacks and pool_local_data() clears the remainder
+of the local data and adds it to GD->thread.engines.  alloc_thread()
+takes local data from this pool for the next pooled engine, so the only
+difference with a new engine is that initPrologStacks() finds the stacks
+in place.  The pool holds at most engine_pool_size engines.  Surplus
+engines, as well as engines whose data may be accessed by another
+thread, are freed as usual.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+trim_pooled_stacks(ARG1_LD)
+{ simpleMutexLock(&LD->thread.scan_lock);
+  emptyStacks();
+  simpleMutexUnlock(&LD->thread.scan_lock);
+  trimStacks(TRUE PASS_LD);
+}
+
+
+static void
+pool_local_data(PL_local_data_t *ld)
+{ if ( !ldata_in_use(ld) )
+  { pl_stacks_t stacks = ld->stacks;
+    uintptr_t bases[STG_MASK+1];
+
+    memcpy(bases, ld->bases, sizeof(bases));
+    simpleMutexDelete(&ld->thread.scan_lock);
+    memset(ld, 0, sizeof(*ld));
+    ld->stacks = stacks;
+    memcpy(ld->bases, bases, sizeof(bases));
+
+    PL_LOCK(L_THREAD);
+    if ( GD->thread.engines.count < GD->thread.engines.max )
+    { ld->next_free = GD->thread.engines.free;
+      GD->thread.engines.free = ld;
+      GD->thread.engines.count++;
+      ld = NULL;
+    }
+    PL_UNLOCK(L_THREAD);
+
+    if ( ld )
+    { freeStacks(ld);
+      freeHeap(ld, sizeof(*ld));
+    }
+  } else
+  { simpleMutexLock(&ld->thread.scan_lock);
+    freeStacks(ld);
+    simpleMutexUnlock(&ld->thread.scan_lock);
+    maybe_free_local_data(ld);
+  }
+}
+
+
+static PL_local_data_t *
+pooled_local_data(void)
+{ PL_local_data_t *ld;
+
+  PL_LOCK(L_THREAD);
+  if ( (ld = GD->thread.engines.free) )
+  { GD->thread.engines.free = ld->next_free;
+    GD->thread.engines.count--;
+    ld->next_free = NULL;
+  }
+  PL_UNLOCK(L_THREAD);
+
+  return ld;
+}
+
+
+static void
+free_engine_pool(void)
+{ PL_local_data_t *ld;
+
+  while( (ld = GD->thread.engines.free) )
+  { GD->thread.engines.free = ld->next_free;
+    freeStacks(ld);
+    freeHeap(ld, sizeof(*ld));
+  }
+  GD->thread.engines.count = 0;
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 free_prolog_thread()
     Called from a cleanup-handler to release all resources associated
@@ -591,6 +678,7 @@ static void
 freePrologThread(PL_local_data_t *ld, int after_fork)
 { PL_thread_info_t *info;
   int acknowledge;
+  int pool;
   double time;
 
   if ( !threads_ready )
@@ -634,9 +722,15 @@ freePrologThread(PL_local_data_t *ld, int after_fork)
 
   cleanupLocalDefinitions(ld);
 
+  pool = ( info->pooled && !after_fork &&
+	   GD->cleaning == CLN_NORMAL &&
+	   ld == GLOBAL_LD && ld->stacks.global.base );
+  if ( pool )
+    trim_pooled_stacks(ld);
+
   DEBUG(MSG_THREAD, Sdprintf("Destroying data\n"));
   ld->magic = 0;
-  if ( ld->stacks.global.base )		/* otherwise not initialised */
+  if ( ld->stacks.global.base && !pool ) /* otherwise not initialised */
   { simpleMutexLock(&ld->thread.scan_lock);
     freeStacks(ld);
     simpleMutexUnlock(&ld->thread.scan_lock);
@@ -673,7 +767,10 @@ freePrologThread(PL_local_data_t *ld, int after_fork)
     free_thread_info(info);
 
   ld->thread.info = NULL;		/* help force a crash if ld used */
-  maybe_free_local_data(ld);
+  if ( pool )
+    pool_local_data(ld);
+  else
+    maybe_free_local_data(ld);
 
   if ( acknowledge )			/* == canceled */
   { DEBUG(MSG_CLEANUP_THREAD,
@@ -729,6 +826,24 @@ reinit_threads_after_fork(void)
   PL_thread_info_t *info;
   int i;
 
+  pthread_mutex_init(&GD->thread.mark.mutex, NULL); /* GC mark helpers */
+  pthread_cond_init(&GD->thread.mark.cond, NULL);   /* are gone */
+  GD->thread.mark.chunks  = NULL;
+  GD->thread.mark.running = 0;
+  GD->thread.mark.joined  = 0;
+  GD->thread.mark.owned   = FALSE;
+  pthread_mutex_init(&GD->thread.qlf.mutex, NULL); /* QLF load helpers */
+  pthread_cond_init(&GD->thread.qlf.cond, NULL);
+  GD->thread.qlf.queue      = NULL;
+  GD->thread.qlf.queue_tail = NULL;
+  GD->thread.qlf.running    = 0;
+  pthread_mutex_init(&GD->thread.tasks.mutex, NULL); /* Task workers */
+  pthread_cond_init(&GD->thread.tasks.cond, NULL);
+  GD->thread.tasks.workers  = NULL;
+  GD->thread.tasks.count    = 0;
+  GD->thread.tasks.idle     = 0;
+  GD->thread.tasks.queued   = 0;
+
   if ( will_exec ||
        (GD->statistics.threads_created - GD->statistics.threads_finished) == 1)
     return;					/* no point */
@@ -855,6 +970,15 @@ initPrologThreads(void)
     GD->statistics.threads_created = 1;
     pthread_mutex_init(&GD->thread.index.mutex, NULL);
     pthread_cond_init(&GD->thread.index.cond, NULL);
+    pthread_cond_init(&GD->thread.index.builder_cond, NULL);
+    GD->thread.index.bg_threshold = 100000;
+    pthread_mutex_init(&GD->thread.mark.mutex, NULL);
+    pthread_cond_init(&GD->thread.mark.cond, NULL);
+    pthread_mutex_init(&GD->thread.qlf.mutex, NULL);
+    pthread_cond_init(&GD->thread.qlf.cond, NULL);
+    pthread_mutex_init(&GD->thread.tasks.mutex, NULL);
+    pthread_cond_init(&GD->thread.tasks.cond, NULL);
+    GD->thread.engines.max = 16;
     initMutexes();
     link_mutexes();
     threads_ready = TRUE;
@@ -884,6 +1008,7 @@ cleanupThreads(void)
   { destroyHTable(threadTable);
     threadTable = NULL;
   }
+  free_engine_pool();
   for(i=1; i<GD->thread.thread_max; i++)
   { PL_thread_info_t *info = GD->thread.threads[i];
 
@@ -1328,7 +1453,7 @@ resizeThreadMax(void)
 /* MT: thread-safe */
 
 static PL_thread_info_t *
-alloc_thread(void)
+alloc_thread(int pooled)
 { PL_thread_info_t *info;
   PL_local_data_t *ld;
   int mx;
@@ -1358,8 +1483,10 @@ alloc_thread(void)
     PL_UNLOCK(L_THREAD);
   }
 
-  ld = allocHeapOrHalt(sizeof(PL_local_data_t));
-  memset(ld, 0, sizeof(PL_local_data_t));
+  if ( !pooled || !(ld = pooled_local_data()) )
+  { ld = allocHeapOrHalt(sizeof(PL_local_data_t));
+    memset(ld, 0, sizeof(PL_local_data_t));
+  }
 
   ld->thread.info = info;
   ld->thread.magic = PL_THREAD_MAGIC;
@@ -1944,7 +2071,7 @@ pl_thread_create(term_t goal, term_t id, term_t options)
 		      ERR_PERMISSION,
 		      ATOM_create, ATOM_thread, goal);
 
-  if ( !(info = alloc_thread()) )
+  if ( !(info = alloc_thread(FALSE)) )
     return PL_error(NULL, 0, NULL, ERR_RESOURCE, ATOM_threads);
 
   ldnew = info->thread_data;
@@ -3172,6 +3299,7 @@ static const opt_spec make_engine_options[] =
 { { ATOM_stack_limit,	OPT_SIZE|OPT_INF },
   { ATOM_alias,		OPT_ATOM },
   { ATOM_inherit_from,	OPT_TERM },
+  { ATOM_pool,		OPT_BOOL },
   { NULL_ATOM,		0 }
 };
 
@@ -3184,15 +3312,20 @@ PRED_IMPL("$engine_create", 3, engine_create, 0)
   size_t stack	      =	0;
   atom_t alias	      =	NULL_ATOM;
   term_t inherit_from =	0;
+  int pool	      = FALSE;
 
   memset(&attrs, 0, sizeof(attrs));
   if ( !scan_options(A3, 0,
 		     ATOM_engine_option, make_engine_options,
 		     &stack,
 		     &alias,
-		     &inherit_from) )
+		     &inherit_from,
+		     &pool) )
     return FALSE;
 
+  if ( pool )
+    attrs.flags |= PL_THREAD_POOLED;
+
   if ( stack )
     attrs.stack_limit = stack;
   else
@@ -3583,17 +3716,12 @@ PRED_IMPL("is_engine", 1, is_engine, 0)
 		 *	  MESSAGE QUEUES	*
 		 *******************************/
 
-typedef enum
-{ QUEUE_WAIT_READ,			/* wait for message */
-  QUEUE_WAIT_DRAIN			/* wait for queue to drain */
-} queue_wait_type;
-
 #define MSG_WAIT_INTR		(-1)
 #define MSG_WAIT_TIMEOUT	(-2)
 #define MSG_WAIT_DESTROYED	(-3)
 
 static int dispatch_cond_wait(message_queue *queue,
-			      queue_wait_type wait,
+			      queue_cond_t *cv,
 			      struct timespec *deadline);
 
 #ifdef __WINDOWS__
@@ -3762,22 +3890,43 @@ This code deals with telling other threads something.  The interface:
 	thread_send_message(+Id, +Message)
 
 Queues can be waited for by   multiple  threads using different (partly)
-instantiated patterns for Message. For this   reason all waiting threads
-should be restarted using pthread_cond_broadcast().   However,  if there
-are a large number of workers only   waiting for `any' message this will
-cause all of them to wakeup for only   one  to grab the message. This is
-highly undesirable and therefore the queue  keeps two counts: the number
-of waiting threads and the number waiting  with a variable. Only if they
-are not equal and there are multiple waiters we must be using broadcast.
+instantiated patterns for Message. Messages are   indexed on the key of
+getIndexOfTerm(): besides the queue  itself,   each  message is part of
+the chain of messages with the  same   key  (see message_chain). Keyless
+messages (variables) are in queue->unkeyed.  A reader with an indexable
+pattern merges its key chain with the   unkeyed chain rather than trying
+to unify against every message in the queue.
+
+Each blocked reader registers a queue_waiter with   its own condition
+variable and key. A new message only   wakes the readers whose key is
+compatible. If there are a large number of workers waiting for `any'
+message, only one of them is woken.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 typedef struct thread_message
 { struct thread_message *next;		/* next in queue */
+  struct thread_message *prev;		/* previous in queue */
+  struct thread_message *next_key;	/* next with the same key */
+  struct thread_message *prev_key;	/* previous with the same key */
   record_t            message;		/* message in queue */
   word		      key;		/* Indexing key */
   uint64_t	      sequence_id;	/* Numbered sequence */
 } thread_message;
 
+typedef struct queue_waiter
+{ struct queue_waiter *next;		/* next blocked reader */
+  word		      key;		/* Indexing key of the pattern */
+  int		      isvar;		/* Pattern is unbound */
+  int		      signalled;	/* Woken up, but not yet running */
+  queue_cond_t	      cond;		/* condvar for this reader */
+} queue_waiter;
+
+typedef struct message_cursor
+{ thread_message     *keyed;		/* next in chain of the key */
+  thread_message     *unkeyed;		/* next in queue->unkeyed */
+  int		      all;		/* Walk the entire queue */
+} message_cursor;
+
 
 static thread_message *
 create_thread_message(term_t msg ARG_LD)
@@ -3788,8 +3937,11 @@ create_thread_message(term_t msg ARG_LD)
     return NULL;
 
   if ( (msgp = allocHeap(sizeof(*msgp))) )
-  { msgp->next    = NULL;
-    msgp->message = rec;
+  { msgp->next     = NULL;
+    msgp->prev     = NULL;
+    msgp->next_key = NULL;
+    msgp->prev_key = NULL;
+    msgp->message  = rec;
     msgp->key     = getIndexOfTerm(msg);
   } else
   { freeRecord(rec);
@@ -3808,6 +3960,171 @@ free_thread_message(thread_message *msg)
 }
 
 
+		 /*******************************
+		 *	   MESSAGE INDEX	*
+		 *******************************/
+
+static void
+free_message_chain(void *name, void *value)
+{ message_chain *ch = value;
+
+  (void)name;
+  freeHeap(ch, sizeof(*ch));
+}
+
+
+static message_chain *
+lookup_message_chain(message_queue *queue, word key ARG_LD)
+{ if ( !key )
+    return &queue->unkeyed;
+  if ( queue->index )
+    return lookupHTable(queue->index, (void *)key);
+
+  return NULL;
+}
+
+
+static void
+index_message(message_queue *queue, thread_message *msgp ARG_LD)
+{ message_chain *ch;
+
+  if ( !(ch=lookup_message_chain(queue, msgp->key PASS_LD)) )
+  { if ( !queue->index )
+    { queue->index = newHTable(16);
+      queue->index->free_symbol = free_message_chain;
+    }
+    ch = allocHeapOrHalt(sizeof(*ch));
+    ch->head = ch->tail = NULL;
+    addNewHTable(queue->index, (void *)msgp->key, ch);
+  }
+
+  if ( (msgp->prev_key = ch->tail) )
+    ch->tail->next_key = msgp;
+  else
+    ch->head = msgp;
+  ch->tail = msgp;
+}
+
+
+/* unlink_message() removes msgp from the queue and its key chain.  The
+   caller must hold the queue-mutex.  We must lock gc_mutex as atom-GC
+   may be scanning the queue (see get_message()).
+*/
+
+static void
+unlink_message(message_queue *queue, thread_message *msgp ARG_LD)
+{ message_chain *ch = lookup_message_chain(queue, msgp->key PASS_LD);
+
+  simpleMutexLock(&queue->gc_mutex);
+  if ( msgp->prev )
+    msgp->prev->next = msgp->next;
+  else
+    queue->head = msgp->next;
+  if ( msgp->next )
+    msgp->next->prev = msgp->prev;
+  else
+    queue->tail = msgp->prev;
+  simpleMutexUnlock(&queue->gc_mutex);
+
+  if ( msgp->prev_key )
+    msgp->prev_key->next_key = msgp->next_key;
+  else
+    ch->head = msgp->next_key;
+  if ( msgp->next_key )
+    msgp->next_key->prev_key = msgp->prev_key;
+  else
+    ch->tail = msgp->prev_key;
+
+  if ( !ch->head && msgp->key )
+  { deleteHTable(queue->index, (void *)msgp->key);
+    free_message_chain(NULL, ch);
+  }
+
+  queue->size--;
+}
+
+
+/* A message_cursor enumerates the messages that may unify with a
+   pattern with the given key in queue order.  For a keyless pattern
+   this is the whole queue, otherwise the merge of the key chain and
+   the unkeyed messages.
+*/
+
+static void
+init_message_cursor(message_cursor *c, message_queue *queue, word key ARG_LD)
+{ if ( key )
+  { message_chain *ch = lookup_message_chain(queue, key PASS_LD);
+
+    c->all     = FALSE;
+    c->keyed   = (ch ? ch->head : NULL);
+    c->unkeyed = queue->unkeyed.head;
+  } else
+  { c->all     = TRUE;
+    c->keyed   = queue->head;
+    c->unkeyed = NULL;
+  }
+}
+
+
+static thread_message *
+next_message_cursor(message_cursor *c)
+{ thread_message *msgp;
+
+  if ( c->all )
+  { if ( (msgp=c->keyed) )
+      c->keyed = msgp->next;
+  } else if ( c->keyed &&
+	      (!c->unkeyed ||
+	       c->keyed->sequence_id < c->unkeyed->sequence_id) )
+  { msgp = c->keyed;
+    c->keyed = msgp->next_key;
+  } else if ( (msgp=c->unkeyed) )
+  { c->unkeyed = msgp->next_key;
+  }
+
+  return msgp;
+}
+
+
+/* wakeup_readers() signals the blocked readers that may be interested
+   in a message with the given key.  Only one reader with an unbound
+   pattern is woken as any of them will take the message.
+*/
+
+static void
+wakeup_readers(message_queue *queue, word key)
+{ queue_waiter *w;
+  int var_woken = FALSE;
+
+  for(w = queue->waiters; w; w = w->next)
+  { if ( w->signalled )
+      continue;
+    if ( w->isvar )
+    { if ( var_woken )
+	continue;
+      var_woken = TRUE;
+    } else if ( key && w->key && key != w->key )
+    { continue;
+    }
+
+    DEBUG(MSG_THREAD, Sdprintf("Waking reader for key %p\n", (void*)w->key));
+    w->signalled = TRUE;
+    cv_signal(&w->cond);
+  }
+}
+
+
+static void
+wakeup_all_readers(message_queue *queue)
+{ queue_waiter *w;
+
+  for(w = queue->waiters; w; w = w->next)
+  { w->signalled = TRUE;
+    cv_signal(&w->cond);
+  }
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 queue_message() adds a message to a message queue.  The caller must hold
 the queue-mutex.
@@ -3820,7 +4137,7 @@ queue_message(message_queue *queue, thread_message *msgp,
   { queue->wait_for_drain++;
 
     while ( queue->size >= queue->max_size )
-    { switch ( dispatch_cond_wait(queue, QUEUE_WAIT_DRAIN, deadline) )
+    { switch ( dispatch_cond_wait(queue, &queue->drain_var, deadline) )
       { case EINTR:
 	{ if ( !LD )			/* needed for clean exit */
 	  { Sdprintf("Forced exit from queue_message()\n");
@@ -3854,22 +4171,15 @@ queue_message(message_queue *queue, thread_message *msgp,
   if ( !queue->head )
   { queue->head = queue->tail = msgp;
   } else
-  { queue->tail->next = msgp;
+  { msgp->prev = queue->tail;
+    queue->tail->next = msgp;
     queue->tail = msgp;
   }
+  index_message(queue, msgp PASS_LD);
   queue->size++;
 
   if ( queue->waiting )
-  { if ( queue->waiting > queue->waiting_var && queue->waiting > 1 )
-    { DEBUG(MSG_THREAD,
-	    Sdprintf("%d of %d non-var waiters; broadcasting\n",
-		     queue->waiting - queue->waiting_var,
-		     queue->waiting));
-      cv_broadcast(&queue->cond_var);
-    } else
-    { DEBUG(MSG_THREAD, Sdprintf("%d var waiters; signalling\n", queue->waiting));
-      cv_signal(&queue->cond_var);
-    }
+  { wakeup_readers(queue, msgp->key);
   } else
   { DEBUG(MSG_THREAD, Sdprintf("No waiters\n"));
   }
@@ -3962,11 +4272,8 @@ carry_timespec_nanos(struct timespec *time)
 #ifdef __WINDOWS__
 
 static int
-dispatch_cond_wait(message_queue *queue, queue_wait_type wait, struct timespec *deadline)
-{ return win32_cond_wait((wait == QUEUE_WAIT_READ ? &queue->cond_var
-						  : &queue->drain_var),
-			 &queue->mutex,
-			 deadline);
+dispatch_cond_wait(message_queue *queue, queue_cond_t *cv, struct timespec *deadline)
+{ return win32_cond_wait(cv, &queue->mutex, deadline);
 }
 
 #else /*__WINDOWS__*/
@@ -3975,7 +4282,7 @@ dispatch_cond_wait(message_queue *queue, queue_wait_type wait, struct timespec *
 */
 
 static int
-dispatch_cond_wait(message_queue *queue, queue_wait_type wait, struct timespec *deadline)
+dispatch_cond_wait(message_queue *queue, queue_cond_t *cv, struct timespec *deadline)
 { GET_LD
   int rc;
 
@@ -3990,9 +4297,7 @@ dispatch_cond_wait(message_queue *queue, queue_wait_type wait, struct timespec *
     if ( deadline && timespec_cmp(&tmp_timeout, deadline) >= 0 )
       api_timeout = deadline;
 
-    rc = pthread_cond_timedwait((wait == QUEUE_WAIT_READ ? &queue->cond_var
-							 : &queue->drain_var),
-				&queue->mutex, api_timeout);
+    rc = pthread_cond_timedwait(cv, &queue->mutex, api_timeout);
 
     switch( rc )
     { case ETIMEDOUT:
@@ -4029,6 +4334,75 @@ msg_statistics(void)
 #define QSTAT(n) ((void)0)
 #endif
 
+/* wait_message() blocks until a message arrives that may unify with a
+   pattern with the given key.  It must be called with queue->mutex
+   locked.  Returns 0 if the caller must rescan the queue,
+   MSG_WAIT_INTR or MSG_WAIT_TIMEOUT.
+
+   wakeup_readers() wakes only one reader with an unbound pattern.  If
+   we were woken but leave due to a timeout or signal, we will not take
+   the message and must pass the wakeup on to another reader.
+*/
+
+static int
+wait_message(message_queue *queue, word key, int isvar,
+	     struct timespec *deadline ARG_LD)
+{ queue_waiter waiter;
+  int rc;
+
+  waiter.key       = key;
+  waiter.isvar     = isvar;
+  waiter.signalled = FALSE;
+  waiter.next      = queue->waiters;
+  cv_init(&waiter.cond, NULL);
+  queue->waiters   = &waiter;
+  queue->waiting++;
+  DEBUG(MSG_QUEUE_WAIT, Sdprintf("%d: waiting on queue\n", PL_thread_self()));
+  rc = dispatch_cond_wait(queue, &waiter.cond, deadline);
+  { queue_waiter **wp;
+
+    for(wp = &queue->waiters; *wp != &waiter; wp = &(*wp)->next)
+      ;
+    *wp = waiter.next;
+  }
+  queue->waiting--;
+  cv_destroy(&waiter.cond);
+
+  switch ( rc )
+  { case EINTR:
+    { DEBUG(MSG_QUEUE_WAIT, Sdprintf("%d: EINTR\n", PL_thread_self()));
+
+      if ( !LD )			/* needed for clean exit */
+      { Sdprintf("Forced exit from get_message()\n");
+	exit(1);
+      }
+
+      if ( is_signalled(LD) )		/* thread-signal */
+	rc = MSG_WAIT_INTR;
+      else
+	rc = 0;
+      break;
+    }
+    case ETIMEDOUT:
+      DEBUG(MSG_QUEUE_WAIT, Sdprintf("%d: ETIMEDOUT\n", PL_thread_self()));
+      rc = MSG_WAIT_TIMEOUT;
+      break;
+    case 0:
+      DEBUG(MSG_QUEUE_WAIT,
+	    Sdprintf("%d: wakeup on queue\n", PL_thread_self()));
+      break;
+    default:
+      assert(0);
+      rc = 0;
+  }
+
+  if ( rc != 0 && waiter.signalled && queue->waiting )
+    wakeup_readers(queue, key);		/* pass the wakeup on */
+
+  return rc;
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 get_message() reads the next message from the  message queue. It must be
 called with queue->mutex locked.  It returns one of
@@ -4060,12 +4434,13 @@ get_message(message_queue *queue, term_t msg, struct timespec *deadline ARG_LD)
   word key = (isvar ? 0L : getIndexOfTerm(msg));
   fid_t fid = PL_open_foreign_frame();
   uint64_t seen = 0;
+  int rc;
 
   QSTAT(getmsg);
 
   for(;;)
-  { thread_message *msgp = queue->head;
-    thread_message *prev = NULL;
+  { message_cursor cursor;
+    thread_message *msgp;
 
     if ( queue->destroyed )
       return MSG_WAIT_DESTROYED;
@@ -4075,9 +4450,9 @@ get_message(message_queue *queue, term_t msg, struct timespec *deadline ARG_LD)
 	    Sdprintf("%d: scanning queue (size=%ld)\n",
 		     PL_thread_self(), queue->size));
 
-    for( ; msgp; prev = msgp, msgp = msgp->next )
-    { int rc;
-      term_t tmp;
+    init_message_cursor(&cursor, queue, key PASS_LD);
+    while( (msgp=next_message_cursor(&cursor)) )
+    { term_t tmp;
 
       if ( msgp->sequence_id < seen )
       { QSTAT(skipped);
@@ -4087,11 +4462,6 @@ get_message(message_queue *queue, term_t msg, struct timespec *deadline ARG_LD)
       }
       seen = msgp->sequence_id;
 
-      if ( key && msgp->key && key != msgp->key )
-      { DEBUG(MSG_QUEUE, Sdprintf("Message key mismatch\n"));
-	continue;			/* fast search */
-      }
-
       QSTAT(unified);
       tmp = PL_new_term_ref();
       if ( !PL_recorded(msgp->message, tmp) )
@@ -4109,18 +4479,8 @@ get_message(message_queue *queue, term_t msg, struct timespec *deadline ARG_LD)
 	if (GD->atoms.gc_active)
 	  markAtomsRecord(msgp->message);
 
-        simpleMutexLock(&queue->gc_mutex);	/* see (*) */
-	if ( prev )
-	{ if ( !(prev->next = msgp->next) )
-	    queue->tail = prev;
-	} else
-	{ if ( !(queue->head = msgp->next) )
-	    queue->tail = NULL;
-	}
-        simpleMutexUnlock(&queue->gc_mutex);
-
+	unlink_message(queue, msgp PASS_LD);	/* see (*) */
 	free_thread_message(msgp);
-	queue->size--;
 	if ( queue->wait_for_drain )
 	{ DEBUG(MSG_QUEUE, Sdprintf("Queue drained. wakeup writers\n"));
 	  cv_signal(&queue->drain_var);
@@ -4136,61 +4496,78 @@ get_message(message_queue *queue, term_t msg, struct timespec *deadline ARG_LD)
       PL_rewind_foreign_frame(fid);
     }
 
-    queue->waiting++;
-    queue->waiting_var += isvar;
-    DEBUG(MSG_QUEUE_WAIT, Sdprintf("%d: waiting on queue\n", PL_thread_self()));
-    switch ( dispatch_cond_wait(queue, QUEUE_WAIT_READ, deadline) )
-    { case EINTR:
-      { DEBUG(MSG_QUEUE_WAIT, Sdprintf("%d: EINTR\n", PL_thread_self()));
+    if ( (rc=wait_message(queue, key, isvar, deadline PASS_LD)) != 0 )
+    { PL_discard_foreign_frame(fid);
+      return rc;
+    }
+  }
+}
+
 
-	if ( !LD )			/* needed for clean exit */
-	{ Sdprintf("Forced exit from get_message()\n");
-	  exit(1);
-	}
+/* get_messages() is the batch version of get_message() for an unbound
+   pattern.  It waits for the queue to be non-empty and unifies list
+   with up to max messages.  The messages are only removed after the
+   entire list was created.
+*/
 
-	if ( is_signalled(LD) )		/* thread-signal */
-	{ queue->waiting--;
-	  queue->waiting_var -= isvar;
-	  PL_discard_foreign_frame(fid);
-	  return MSG_WAIT_INTR;
-	}
-	break;
+static int
+get_messages(message_queue *queue, size_t max, term_t list,
+	     struct timespec *deadline ARG_LD)
+{ int rc;
+
+  for(;;)
+  { if ( queue->destroyed )
+      return MSG_WAIT_DESTROYED;
+
+    if ( queue->head )
+    { term_t tail = PL_copy_term_ref(list);
+      term_t head = PL_new_term_ref();
+      term_t tmp  = PL_new_term_ref();
+      thread_message *msgp, *next;
+      size_t n;
+
+      for(msgp=queue->head, n=0; msgp && n < max; msgp=msgp->next, n++)
+      { if ( !PL_unify_list(tail, head, tail) )
+	  return FALSE;
+	if ( !PL_recorded(msgp->message, tmp) )
+	  return raiseStackOverflow(GLOBAL_OVERFLOW);
+	if ( !PL_unify(head, tmp) )
+	  return FALSE;
       }
-      case ETIMEDOUT:
-      { DEBUG(MSG_QUEUE_WAIT, Sdprintf("%d: ETIMEDOUT\n", PL_thread_self()));
+      if ( !PL_unify_nil(tail) )
+	return FALSE;
+
+      for(msgp=queue->head; n-- > 0; msgp=next)
+      { next = msgp->next;
 
-	queue->waiting--;
-	queue->waiting_var -= isvar;
-	PL_discard_foreign_frame(fid);
-	return MSG_WAIT_TIMEOUT;
+	if ( GD->atoms.gc_active )
+	  markAtomsRecord(msgp->message);
+	unlink_message(queue, msgp PASS_LD);
+	free_thread_message(msgp);
       }
-      case 0:
-	DEBUG(MSG_QUEUE_WAIT,
-	      Sdprintf("%d: wakeup on queue\n", PL_thread_self()));
-	break;
-      default:
-	assert(0);
+      if ( queue->wait_for_drain )
+	cv_broadcast(&queue->drain_var);
+
+      return TRUE;
     }
-    queue->waiting--;
-    queue->waiting_var -= isvar;
+
+    if ( (rc=wait_message(queue, 0, TRUE, deadline PASS_LD)) != 0 )
+      return rc;
   }
 }
 
 
 static int
 peek_message(message_queue *queue, term_t msg ARG_LD)
-{ thread_message *msgp;
+{ message_cursor cursor;
+  thread_message *msgp;
   term_t tmp = PL_new_term_ref();
   word key = getIndexOfTerm(msg);
   fid_t fid = PL_open_foreign_frame();
 
-  msgp = queue->head;
-
-  for( msgp = queue->head; msgp; msgp = msgp->next )
-  { if ( key && msgp->key && key != msgp->key )
-      continue;
-
-    if ( !PL_recorded(msgp->message, tmp) )
+  init_message_cursor(&cursor, queue, key PASS_LD);
+  while( (msgp=next_message_cursor(&cursor)) )
+  { if ( !PL_recorded(msgp->message, tmp) )
       return raiseStackOverflow(GLOBAL_OVERFLOW);
 
     if ( PL_unify(msg, tmp) )
@@ -4227,8 +4604,12 @@ destroy_message_queue(message_queue *queue)
     freeHeap(msgp, sizeof(*msgp));
   }
 
+  if ( queue->index )
+  { destroyHTable(queue->index);
+    queue->index = NULL;
+  }
+
   simpleMutexDelete(&queue->gc_mutex);
-  cv_destroy(&queue->cond_var);
   if ( queue->max_size > 0 )
     cv_destroy(&queue->drain_var);
   if ( !queue->anonymous )
@@ -4253,7 +4634,7 @@ destroy_thread_message_queue(message_queue *q)
     q->destroyed = TRUE;
     if ( q->waiting || q->wait_for_drain )
     { if ( q->waiting )
-	cv_broadcast(&q->cond_var);
+	wakeup_all_readers(q);
       if ( q->wait_for_drain )
 	cv_broadcast(&q->drain_var);
     } else
@@ -4270,7 +4651,6 @@ init_message_queue(message_queue *queue, size_t max_size)
 { memset(queue, 0, sizeof(*queue));
   simpleMutexInit(&queue->mutex);
   simpleMutexInit(&queue->gc_mutex);
-  cv_init(&queue->cond_var, NULL);
   queue->max_size = max_size;
   if ( queue->max_size != 0 )
     cv_init(&queue->drain_var, NULL);
@@ -4440,6 +4820,64 @@ PRED_IMPL("thread_send_message", 3, thread_send_message, 0)
 }
 
 
+/* thread_send_messages(+Queue, +List[, +Options]) adds all elements of
+   List to Queue while holding the queue-mutex once.  Readers are woken
+   at most once (see wakeup_readers()).  If the queue is full and the
+   deadline expires, the remaining messages are not sent.
+*/
+
+static int
+thread_send_messages__LD(term_t queue, term_t list,
+			 struct timespec *deadline ARG_LD)
+{ message_queue *q;
+  term_t tail = PL_copy_term_ref(list);
+  term_t head = PL_new_term_ref();
+  int rc = TRUE;
+
+  switch( PL_skip_list(list, 0, NULL) )
+  { case PL_LIST:
+      break;
+    case PL_PARTIAL_LIST:
+      return PL_instantiation_error(list);
+    default:
+      return PL_type_error("list", list);
+  }
+  if ( !get_message_queue__LD(queue, &q PASS_LD) )
+    return FALSE;
+
+  while( rc && PL_get_list(tail, head, tail) )
+  { thread_message *msg;
+
+    if ( !(msg = create_thread_message(head PASS_LD)) )
+    { rc = PL_no_memory();
+      break;
+    }
+    if ( !(rc = wait_queue_message(queue, q, msg, deadline PASS_LD)) )
+      free_thread_message(msg);
+  }
+  release_message_queue(q);
+
+  return rc;
+}
+
+static
+PRED_IMPL("thread_send_messages", 2, thread_send_messages, 0)
+{ PRED_LD
+
+  return thread_send_messages__LD(A1, A2, NULL PASS_LD);
+}
+
+static
+PRED_IMPL("thread_send_messages", 3, thread_send_messages, 0)
+{ PRED_LD
+  struct timespec deadline;
+  struct timespec *dlop=NULL;
+
+  return process_deadline_options(A3,&deadline,&dlop)
+    &&   thread_send_messages__LD(A1, A2, dlop PASS_LD);
+}
+
+
 
 static
 PRED_IMPL("thread_get_message", 1, thread_get_message, PL_FA_ISO)
@@ -4825,7 +5263,7 @@ PRED_IMPL("message_queue_destroy", 1, message_queue_destroy, 0)
   q->destroyed = TRUE;
 
   if ( q->waiting )
-    cv_broadcast(&q->cond_var);
+    wakeup_all_readers(q);
   if ( q->wait_for_drain )
     cv_broadcast(&q->drain_var);
 
@@ -5112,31 +5550,98 @@ PRED_IMPL("thread_peek_message", 2, thread_peek_message_2, 0)
 }
 
 
-		 /*******************************
-		 *	 MUTEX PRIMITIVES	*
-		 *******************************/
-
-#ifdef NEED_RECURSIVE_MUTEX_INIT
+/* thread_get_messages(+Queue, +Max, -List[, +Options]) waits for Queue
+   to be non-empty and removes up to Max messages in one critical
+   section.
+*/
 
-#ifdef RECURSIVE_MUTEXES
 static int
-recursive_attr(pthread_mutexattr_t **ap)
-{ static int done;
-  static pthread_mutexattr_t attr;
+thread_get_messages__LD(term_t queue, term_t max, term_t list,
+			struct timespec *deadline ARG_LD)
+{ size_t n;
   int rc;
 
-  if ( done )
-  { *ap = &attr;
-    return 0;
-  }
+  if ( !PL_get_size_ex(max, &n) )
+    return FALSE;
+  if ( n == 0 )
+    return PL_domain_error("not_less_than_one", max);
 
-  PL_LOCK(L_THREAD);
-  if ( done )
-  { PL_UNLOCK(L_THREAD);
+  for(;;)
+  { message_queue *q;
 
-    *ap = &attr;
-    return 0;
-  }
+    if ( !get_message_queue__LD(queue, &q PASS_LD) )
+      return FALSE;
+
+    rc = get_messages(q, n, list, deadline PASS_LD);
+    release_message_queue(q);
+
+    switch(rc)
+    { case MSG_WAIT_INTR:
+	if ( PL_handle_signals() >= 0 )
+	  continue;
+	rc = FALSE;
+	break;
+      case MSG_WAIT_DESTROYED:
+	rc = PL_error(NULL, 0, NULL, ERR_EXISTENCE, ATOM_message_queue, queue);
+        break;
+      case MSG_WAIT_TIMEOUT:
+	rc = FALSE;
+        break;
+      default:
+	;
+    }
+
+    break;
+  }
+
+  return rc;
+}
+
+
+static
+PRED_IMPL("thread_get_messages", 3, thread_get_messages, 0)
+{ PRED_LD
+
+  return thread_get_messages__LD(A1, A2, A3, NULL PASS_LD);
+}
+
+
+static
+PRED_IMPL("thread_get_messages", 4, thread_get_messages, 0)
+{ PRED_LD
+  struct timespec deadline;
+  struct timespec *dlop=NULL;
+
+  return process_deadline_options(A4,&deadline,&dlop)
+    &&   thread_get_messages__LD(A1, A2, A3, dlop PASS_LD);
+}
+
+
+		 /*******************************
+		 *	 MUTEX PRIMITIVES	*
+		 *******************************/
+
+#ifdef NEED_RECURSIVE_MUTEX_INIT
+
+#ifdef RECURSIVE_MUTEXES
+static int
+recursive_attr(pthread_mutexattr_t **ap)
+{ static int done;
+  static pthread_mutexattr_t attr;
+  int rc;
+
+  if ( done )
+  { *ap = &attr;
+    return 0;
+  }
+
+  PL_LOCK(L_THREAD);
+  if ( done )
+  { PL_UNLOCK(L_THREAD);
+
+    *ap = &attr;
+    return 0;
+  }
   if ( (rc=pthread_mutexattr_init(&attr)) )
     goto error;
 #ifdef HAVE_PTHREAD_MUTEXATTR_SETTYPE
@@ -5326,7 +5831,7 @@ PL_thread_attach_engine(PL_thread_attr_t *attr)
     return -1;
   }
 
-  if ( !(info = alloc_thread()) )
+  if ( !(info = alloc_thread(attr && (attr->flags & PL_THREAD_POOLED))) )
     return -1;				/* out of threads */
 
   ldmain = GD->thread.threads[1]->thread_data;
@@ -5337,6 +5842,7 @@ PL_thread_attach_engine(PL_thread_attr_t *attr)
       info->stack_limit = attr->stack_limit;
 
     info->cancel = attr->cancel;
+    info->pooled = ((attr->flags & PL_THREAD_POOLED) != 0);
   }
 
   info->goal       = NULL;
@@ -5734,6 +6240,1010 @@ PRED_IMPL("$gc_stop", 0, gc_stop, 0)
 }
 
 
+		 /*******************************
+		 *	   INDEX BUILDER	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The index builder is a  system  thread   that  builds  the clause indexes
+queued by buildIndex() in pl-index.c.   Building  an index for a large
+predicate can take seconds. We do not  use   the  gc thread for this as
+atom and clause garbage collection would have to wait for the build to
+complete.
+
+The thread is created on first use. It is  not a Prolog thread that runs
+a goal: it waits for GD->thread.index.builder_cond, builds the queued
+indexes and waits again. It stops if  it   is  requested  to exit, which
+happens on halt/1 using cancelIndexBuilder().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int IB_id = 0;
+static int IB_starting = 0;
+
+static rc_cancel
+cancelIndexBuilder(int tid)
+{ (void)tid;
+
+  pthread_mutex_lock(&GD->thread.index.mutex);
+  pthread_cond_signal(&GD->thread.index.builder_cond);
+  pthread_mutex_unlock(&GD->thread.index.mutex);
+
+  return PL_THREAD_CANCEL_MUST_JOIN;
+}
+
+
+static void *
+IndexBuilderMain(void *closure)
+{ PL_thread_attr_t attrs = {0};
+#ifdef HAVE_SIGPROCMASK
+  sigset_t set;
+  allSignalMask(&set);
+  if ( GD->signals.sig_alert )
+    sigdelset(&set, GD->signals.sig_alert);
+  pthread_sigmask(SIG_BLOCK, &set, NULL);
+#endif
+
+  attrs.alias  = "__index_builder";
+  attrs.cancel = cancelIndexBuilder;
+  attrs.flags  = PL_THREAD_NO_DEBUG|PL_THREAD_NOT_DETACHED;
+  set_os_thread_name_from_charp("index_builder");
+
+  if ( PL_thread_attach_engine(&attrs) > 0 )
+  { GET_LD
+    PL_thread_info_t *info = LD->thread.info;
+
+    IB_id = PL_thread_self();
+    for(;;)
+    { pthread_mutex_lock(&GD->thread.index.mutex);
+      while ( !GD->thread.index.jobs && !LD->exit_requested )
+	pthread_cond_wait(&GD->thread.index.builder_cond,
+			  &GD->thread.index.mutex);
+      pthread_mutex_unlock(&GD->thread.index.mutex);
+
+      if ( LD->exit_requested )
+	break;
+      buildQueuedIndexes(PASS_LD1);
+    }
+    IB_id = 0;
+
+    set_thread_completion(info, TRUE, 0);
+    PL_thread_destroy_engine();
+  }
+
+  IB_starting = FALSE;
+
+  return NULL;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+signalIndexBuilder() wakes up the index builder,  creating it if needed,
+to build the queued clause indexes. If this   returns FALSE there is no
+builder and the caller must build the index itself.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+int
+signalIndexBuilder(void)
+{ if ( !GD->thread.enabled || GD->bootsession ||
+       GD->cleaning != CLN_NORMAL )
+    return FALSE;
+
+  if ( IB_id <= 0 )
+  { if ( COMPARE_AND_SWAP(&IB_starting, FALSE, TRUE) )
+    { pthread_attr_t attr;
+      pthread_t thr;
+      int rc;
+
+      pthread_attr_init(&attr);
+      rc = pthread_create(&thr, &attr, IndexBuilderMain, NULL);
+      pthread_attr_destroy(&attr);
+      if ( rc != 0 )
+      { IB_starting = FALSE;
+	return FALSE;
+      }
+    }
+    return TRUE;			/* picks up the queued jobs */
+  }
+
+  pthread_mutex_lock(&GD->thread.index.mutex);
+  pthread_cond_signal(&GD->thread.index.builder_cond);
+  pthread_mutex_unlock(&GD->thread.index.mutex);
+
+  return TRUE;
+}
+
+
+		 /*******************************
+		 *	   TASK SCHEDULER	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The task scheduler runs Prolog goals as tasks on a fixed pool of worker
+engines  that  is  shared  by  all   threads.   It  is  used  by
+concurrent_maplist/2,  concurrent_forall/2  and  first_solution/3  from
+library(thread) through '$run_tasks'/2.
+
+Each worker owns a deque of tasks. A worker pops tasks from the tail of
+its own deque and, if this is empty, steals from the head of the deques
+of the other workers. Threads outside the pool spread their tasks over
+the deques. A worker that submits tasks from inside a task pushes them
+on its own deque and, rather than blocking, runs tasks until its batch
+is decided. This provides nested parallelism without more threads.
+
+A batch is decided by the first task that fails or raises an exception
+or, for first_solution/3, the first that succeeds.  Queued tasks of a
+decided batch are skipped.  Running tasks are cancelled by raising
+SIG_TASK_CANCEL in their worker, which makes them throw '$task_cancelled'.
+The batch is reference counted, so the submitter does not have to wait
+for the cancelled tasks to finish.
+
+The workers are started on first use.  Their number is the value of the
+flag task_threads or, if this is 0, the number of CPUs.  A task in a
+deque runs in the worker that takes it and is not guaranteed to run
+concurrently with the other tasks of its batch.  The solvers of
+first_solution/3 must run concurrently, as a solver need not terminate.
+They are not queued, but handed to a _solver_ worker each.  Solver
+workers are created on demand and kept for later batches.  They never
+take tasks from the deques, except while they wait for a batch they
+submitted themselves.  Thus, no worker can start a solver while another
+solver of the same batch is still waiting to run.
+
+Cancelling a worker (see exitPrologThreads()) aborts its running task
+and stops this worker only.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define TPOOL (&GD->thread.tasks)
+#define TASK_DEQUE_INITIAL_SIZE 16	/* must be a power of 2 */
+
+#define TB_NO_RESULTS	     0x01	/* Do not return the bindings */
+#define TB_FIRST	     0x02	/* First success decides */
+#define TB_CONTINUE_ON_FAIL  0x04	/* TB_FIRST: failure does not decide */
+#define TB_CONTINUE_ON_ERROR 0x08	/* TB_FIRST: error does not decide */
+
+typedef enum
+{ TB_RUNNING = 0,			/* Not yet decided */
+  TB_TRUE,				/* Batch succeeded */
+  TB_FALSE,				/* Batch failed */
+  TB_EXCEPTION,				/* A task raised an exception */
+  TB_ABANDONED				/* The submitter was interrupted */
+} tb_status;
+
+typedef enum
+{ TASK_QUEUED = 0,			/* In some deque */
+  TASK_RUNNING,				/* Being executed by worker */
+  TASK_DONE				/* Completed or skipped */
+} task_state;
+
+typedef struct task
+{ struct task_batch *batch;		/* Batch we belong to */
+  struct task  *parent;			/* Task running below us */
+  Module	module;			/* Module to run the goal in */
+  record_t	goal;			/* The goal */
+  record_t	result;			/* Goal after success */
+  int		worker;			/* Thread id running the task */
+  task_state	state;			/* TASK_* */
+} task;
+
+typedef struct task_batch
+{ pthread_mutex_t mutex;		/* Protects the fields below */
+  pthread_cond_t  cond;			/* Signalled when decided */
+  int		flags;			/* TB_* flags */
+  volatile tb_status status;		/* TB_RUNNING until decided */
+  size_t	count;			/* # tasks */
+  size_t	pending;		/* # tasks that are not done */
+  size_t	references;		/* pending tasks + submitter */
+  record_t	exception;		/* TB_EXCEPTION: the exception */
+  task		tasks[1];		/* The tasks (count) */
+} task_batch;
+
+typedef struct task_deque
+{ pthread_mutex_t mutex;		/* Protects the deque */
+  task	      **tasks;			/* Circular buffer */
+  size_t	size;			/* Allocated size (power of 2) */
+  size_t	head;			/* Thieves take from here */
+  size_t	tail;			/* Owner pushes and pops here */
+} task_deque;
+
+typedef struct task_worker
+{ task_deque	deque;			/* Our tasks */
+  int		index;			/* Index in TPOOL->workers */
+  int		tid;			/* Prolog thread id */
+  volatile int	stop;			/* Set by cancel_task_worker() */
+  task * volatile current;		/* Innermost task we are running */
+  int		solver;			/* Solver worker (first_solution/3) */
+  int		idle;			/* Solver: waiting for a task */
+  task	       *assigned;		/* Solver: task to run next */
+  pthread_cond_t cond;			/* Solver: signalled on assign/stop */
+  struct task_worker *next;		/* Solver: next in TPOOL->solvers */
+} task_worker;
+
+
+static void
+push_task(task_deque *dq, task *t)
+{ pthread_mutex_lock(&dq->mutex);
+  if ( dq->tail - dq->head == dq->size )
+  { size_t newsize = dq->size*2;
+    task **new = PL_malloc(newsize*sizeof(*new));
+    size_t i;
+
+    for(i=dq->head; i<dq->tail; i++)
+      new[i&(newsize-1)] = dq->tasks[i&(dq->size-1)];
+    PL_free(dq->tasks);
+    dq->tasks = new;
+    dq->size  = newsize;
+  }
+  dq->tasks[dq->tail++&(dq->size-1)] = t;
+  pthread_mutex_unlock(&dq->mutex);
+
+  ATOMIC_INC(&TPOOL->queued);
+}
+
+
+/* Pop a task from the tail (owner) or head (steal) of a deque */
+
+static task *
+pop_task(task_deque *dq, int steal)
+{ task *t = NULL;
+
+  if ( dq->head == dq->tail )		/* unlocked: just a hint */
+    return NULL;
+
+  pthread_mutex_lock(&dq->mutex);
+  if ( dq->head != dq->tail )
+  { if ( steal )
+      t = dq->tasks[dq->head++&(dq->size-1)];
+    else
+      t = dq->tasks[--dq->tail&(dq->size-1)];
+  }
+  pthread_mutex_unlock(&dq->mutex);
+
+  if ( t )
+    ATOMIC_DEC(&TPOOL->queued);
+
+  return t;
+}
+
+
+/* Find a task for w.  Solver workers have no tasks in their deque and
+   only get here while waiting for a batch they submitted.
+*/
+
+static task *
+find_task(task_worker *w)
+{ int i, n = TPOOL->count;
+  task *t;
+
+  if ( (t=pop_task(&w->deque, FALSE)) )
+    return t;
+
+  for(i=0; i<n; i++)
+  { task_worker *victim = TPOOL->workers[(w->index+i)%n];
+
+    if ( victim != w && (t=pop_task(&victim->deque, TRUE)) )
+      return t;
+  }
+
+  return NULL;
+}
+
+
+/* Wait until there may be a task to run, `b` is decided or `w` must
+   stop.  TPOOL->queued is incremented before the pusher locks
+   TPOOL->mutex, so we cannot miss a wakeup.
+*/
+
+static void
+wait_for_task(task_worker *w, task_batch *b)
+{ pthread_mutex_lock(&TPOOL->mutex);
+  if ( TPOOL->queued == 0 && !w->stop &&
+       !(b && b->status != TB_RUNNING) )
+  { TPOOL->idle++;
+    pthread_cond_wait(&TPOOL->cond, &TPOOL->mutex);
+    TPOOL->idle--;
+  }
+  pthread_mutex_unlock(&TPOOL->mutex);
+}
+
+
+static void
+wake_workers(size_t n)
+{ pthread_mutex_lock(&TPOOL->mutex);
+  if ( TPOOL->idle > 0 )
+  { if ( n == 1 )
+      pthread_cond_signal(&TPOOL->cond);
+    else
+      pthread_cond_broadcast(&TPOOL->cond);
+  }
+  pthread_mutex_unlock(&TPOOL->mutex);
+}
+
+
+static void
+free_task_batch(task_batch *b)
+{ size_t i;
+
+  for(i=0; i<b->count; i++)
+  { task *t = &b->tasks[i];
+
+    if ( t->goal )
+      PL_erase(t->goal);
+    if ( t->result )
+      PL_erase(t->result);
+  }
+  if ( b->exception )
+    PL_erase(b->exception);
+
+  pthread_cond_destroy(&b->cond);
+  pthread_mutex_destroy(&b->mutex);
+  PL_free(b);
+}
+
+
+static void
+release_task_batch(task_batch *b)
+{ size_t refs;
+
+  pthread_mutex_lock(&b->mutex);
+  refs = --b->references;
+  pthread_mutex_unlock(&b->mutex);
+
+  if ( refs == 0 )
+    free_task_batch(b);
+}
+
+
+/* Decide `b`.  Must be called with b->mutex locked.  The caller must
+   call wake_workers() after unlocking to wake workers that wait for
+   the batch.
+*/
+
+static void
+decide_task_batch(task_batch *b, tb_status status)
+{ size_t i;
+
+  b->status = status;
+  for(i=0; i<b->count; i++)
+  { task *t = &b->tasks[i];
+
+    if ( t->state == TASK_RUNNING )
+      PL_thread_raise(t->worker, SIG_TASK_CANCEL);
+  }
+  pthread_cond_broadcast(&b->cond);
+}
+
+
+static void
+complete_task(task *t, int run, int rc, term_t goal, term_t ex ARG_LD)
+{ task_batch *b = t->batch;
+  tb_status status = TB_RUNNING;
+
+  pthread_mutex_lock(&b->mutex);
+  t->state = TASK_DONE;
+  b->pending--;
+  if ( b->status == TB_RUNNING )
+  { if ( run )
+    { if ( rc )
+      { if ( (b->flags&TB_FIRST) )
+	  status = TB_TRUE;
+	if ( !(b->flags&TB_NO_RESULTS) )
+	  t->result = PL_record(goal);
+      } else if ( ex )
+      { if ( !(b->flags&TB_CONTINUE_ON_ERROR) )
+	{ b->exception = PL_record(ex);
+	  status = TB_EXCEPTION;
+	}
+      } else if ( !(b->flags&TB_CONTINUE_ON_FAIL) )
+      { status = TB_FALSE;
+      }
+    }
+    if ( status == TB_RUNNING && b->pending == 0 )
+      status = ((b->flags&TB_FIRST) ? TB_FALSE : TB_TRUE);
+    if ( status != TB_RUNNING )
+      decide_task_batch(b, status);
+  }
+  pthread_mutex_unlock(&b->mutex);
+
+  if ( status != TB_RUNNING )
+    wake_workers((size_t)-1);
+  release_task_batch(b);
+}
+
+
+static void
+run_task(task_worker *w, task *t ARG_LD)
+{ task_batch *b = t->batch;
+  int run;
+
+  pthread_mutex_lock(&b->mutex);
+  if ( (run = (b->status == TB_RUNNING)) )
+  { t->state  = TASK_RUNNING;
+    t->worker = w->tid;
+  }
+  pthread_mutex_unlock(&b->mutex);
+
+  if ( run )
+  { fid_t fid;
+    term_t goal, ex = 0;
+    int rc = FALSE;
+
+    if ( (fid = PL_open_foreign_frame()) &&
+	 (goal = PL_new_term_ref()) )
+    { t->parent  = w->current;
+      w->current = t;
+      if ( PL_recorded(t->goal, goal) )
+	rc = callProlog(t->module, goal, PL_Q_CATCH_EXCEPTION, &ex);
+      else
+	ex = exception_term;
+      w->current = t->parent;
+    } else
+    { goal = 0;
+      ex = exception_term;
+    }
+
+    complete_task(t, TRUE, rc, goal, ex PASS_LD);
+    PL_clear_exception();
+    if ( fid )
+      PL_discard_foreign_frame(fid);
+  } else
+  { complete_task(t, FALSE, FALSE, 0, 0 PASS_LD);
+  }
+}
+
+
+static int
+raise_task_cancelled(ARG1_LD)
+{ term_t ex;
+
+  if ( (ex = PL_new_term_ref()) &&
+       PL_put_atom(ex, ATOM_dtask_cancelled) )
+    return PL_raise_exception(ex);
+
+  return FALSE;
+}
+
+
+/* Handler for SIG_TASK_CANCEL.  The signal may arrive late, so we only
+   throw if the innermost task of this worker was cancelled.  Cancelled
+   tasks further down are found by wait_task_batch().
+*/
+
+void
+executeTaskCancel(int sig)
+{ GET_LD
+  task_worker *w = LD->thread.task_worker;
+  task *t;
+  (void)sig;
+
+  if ( w && (t=w->current) && t->batch->status != TB_RUNNING )
+    raise_task_cancelled(PASS_LD1);
+}
+
+
+/* Cancel the worker with thread id tid.  Only this worker stops.  If it
+   runs a task we return PL_THREAD_CANCEL_FAILED, such that the caller
+   aborts the task.  The other workers steal the tasks in its deque.
+*/
+
+static void
+stop_task_worker(task_worker *w, rc_cancel *rc)
+{ w->stop = TRUE;
+  if ( w->current )
+    *rc = PL_THREAD_CANCEL_FAILED;	/* abort the running task */
+  if ( w->solver )
+    pthread_cond_signal(&w->cond);
+}
+
+
+static rc_cancel
+cancel_task_worker(int tid)
+{ rc_cancel rc = PL_THREAD_CANCEL_MUST_JOIN;
+  task_worker *w;
+  int i;
+
+  pthread_mutex_lock(&TPOOL->mutex);
+  for(i=0; i<TPOOL->count; i++)
+  { if ( TPOOL->workers[i]->tid == tid )
+      stop_task_worker(TPOOL->workers[i], &rc);
+  }
+  for(w=TPOOL->solvers; w; w=w->next)
+  { if ( w->tid == tid )
+      stop_task_worker(w, &rc);
+  }
+  pthread_cond_broadcast(&TPOOL->cond);
+  pthread_mutex_unlock(&TPOOL->mutex);
+
+  return rc;
+}
+
+
+static void *
+task_worker_main(void *closure)
+{ task_worker *w = closure;
+  PL_thread_attr_t attrs = {0};
+  char name[32];
+#ifdef HAVE_SIGPROCMASK
+  sigset_t set;
+  allSignalMask(&set);
+  if ( GD->signals.sig_alert )
+    sigdelset(&set, GD->signals.sig_alert);
+  pthread_sigmask(SIG_BLOCK, &set, NULL);
+#endif
+
+  Ssprintf(name, "__task_worker_%d", w->index+1);
+  attrs.alias  = name;
+  attrs.cancel = cancel_task_worker;
+  attrs.flags  = PL_THREAD_NO_DEBUG|PL_THREAD_NOT_DETACHED;
+  set_os_thread_name_from_charp(name+2);
+
+  if ( PL_thread_attach_engine(&attrs) > 0 )
+  { GET_LD
+    PL_thread_info_t *info = LD->thread.info;
+
+    w->tid = PL_thread_self();
+    LD->thread.task_worker = w;
+
+    while( !w->stop )
+    { task *t;
+
+      if ( (t=find_task(w)) )
+	run_task(w, t PASS_LD);
+      else
+	wait_for_task(w, NULL);
+    }
+
+    LD->thread.task_worker = NULL;
+    set_thread_completion(info, TRUE, 0);
+    PL_thread_destroy_engine();
+  }
+
+  return NULL;
+}
+
+
+/* Main loop of a solver worker.  It runs the task assigned to it by
+   assign_solver() and then waits for the next one.  If we cannot create
+   an engine, we complete the task without running it.
+*/
+
+static void *
+task_solver_main(void *closure)
+{ task_worker *w = closure;
+  PL_thread_attr_t attrs = {0};
+  char name[32];
+#ifdef HAVE_SIGPROCMASK
+  sigset_t set;
+  allSignalMask(&set);
+  if ( GD->signals.sig_alert )
+    sigdelset(&set, GD->signals.sig_alert);
+  pthread_sigmask(SIG_BLOCK, &set, NULL);
+#endif
+
+  Ssprintf(name, "__task_solver_%d", w->index+1);
+  attrs.alias  = name;
+  attrs.cancel = cancel_task_worker;
+  attrs.flags  = PL_THREAD_NO_DEBUG|PL_THREAD_NOT_DETACHED;
+  set_os_thread_name_from_charp(name+2);
+
+  if ( PL_thread_attach_engine(&attrs) > 0 )
+  { GET_LD
+    PL_thread_info_t *info = LD->thread.info;
+
+    w->tid = PL_thread_self();
+    LD->thread.task_worker = w;
+
+    for(;;)
+    { task *t;
+
+      pthread_mutex_lock(&TPOOL->mutex);
+      while( !w->assigned && !w->stop )
+	pthread_cond_wait(&w->cond, &TPOOL->mutex);
+      t = w->assigned;
+      w->assigned = NULL;
+      pthread_mutex_unlock(&TPOOL->mutex);
+
+      if ( w->stop )
+      { if ( t )
+	  complete_task(t, FALSE, FALSE, 0, 0 PASS_LD);
+	break;
+      }
+
+      run_task(w, t PASS_LD);
+
+      pthread_mutex_lock(&TPOOL->mutex);
+      w->idle = TRUE;
+      pthread_mutex_unlock(&TPOOL->mutex);
+    }
+
+    LD->thread.task_worker = NULL;
+    set_thread_completion(info, TRUE, 0);
+    PL_thread_destroy_engine();
+  } else
+  { GET_LD
+    task *t;
+
+    pthread_mutex_lock(&TPOOL->mutex);
+    w->stop = TRUE;			/* never assigned again */
+    t = w->assigned;
+    w->assigned = NULL;
+    pthread_mutex_unlock(&TPOOL->mutex);
+    if ( t )
+      complete_task(t, FALSE, FALSE, 0, 0 PASS_LD);
+  }
+
+  return NULL;
+}
+
+
+/* Hand t to an idle solver worker or create a new one.  Returns 0 or
+   the error of pthread_create().
+*/
+
+static int
+assign_solver(task *t)
+{ task_worker *w;
+  int rc = 0;
+
+  pthread_mutex_lock(&TPOOL->mutex);
+  for(w=TPOOL->solvers; w; w=w->next)
+  { if ( w->idle && !w->stop )
+    { w->idle     = FALSE;
+      w->assigned = t;
+      pthread_cond_signal(&w->cond);
+      break;
+    }
+  }
+
+  if ( !w )
+  { pthread_attr_t attr;
+    pthread_t thr;
+
+    w = PL_malloc(sizeof(*w));
+    memset(w, 0, sizeof(*w));
+    w->index    = TPOOL->solver_count;
+    w->solver   = TRUE;
+    w->assigned = t;
+    pthread_cond_init(&w->cond, NULL);
+    pthread_mutex_init(&w->deque.mutex, NULL);
+    w->deque.size  = TASK_DEQUE_INITIAL_SIZE;
+    w->deque.tasks = PL_malloc(w->deque.size*sizeof(task*));
+
+    pthread_attr_init(&attr);
+    rc = pthread_create(&thr, &attr, task_solver_main, w);
+    pthread_attr_destroy(&attr);
+    if ( rc == 0 )
+    { TPOOL->solver_count++;
+      w->next = TPOOL->solvers;
+      TPOOL->solvers = w;
+    } else
+    { PL_free(w->deque.tasks);
+      pthread_mutex_destroy(&w->deque.mutex);
+      pthread_cond_destroy(&w->cond);
+      PL_free(w);
+    }
+  }
+  pthread_mutex_unlock(&TPOOL->mutex);
+
+  return rc;
+}
+
+
+static int
+start_task_pool(void)
+{ int rc = 0;
+
+  if ( TPOOL->workers )
+    return TRUE;
+
+  pthread_mutex_lock(&TPOOL->mutex);
+  if ( !TPOOL->workers )
+  { int i, n = (TPOOL->threads > 0 ? TPOOL->threads : CpuCount());
+    task_worker **workers;
+
+    if ( n < 1 )
+      n = 1;
+    workers = PL_malloc(n*sizeof(*workers));
+    for(i=0; i<n; i++)
+    { task_worker *w = PL_malloc(sizeof(*w));
+
+      memset(w, 0, sizeof(*w));
+      w->index = i;
+      pthread_mutex_init(&w->deque.mutex, NULL);
+      w->deque.size  = TASK_DEQUE_INITIAL_SIZE;
+      w->deque.tasks = PL_malloc(w->deque.size*sizeof(task*));
+      workers[i] = w;
+    }
+
+    for(i=0; i<n; i++)
+    { pthread_attr_t attr;
+      pthread_t thr;
+
+      pthread_attr_init(&attr);
+      rc = pthread_create(&thr, &attr, task_worker_main, workers[i]);
+      pthread_attr_destroy(&attr);
+      if ( rc != 0 )
+	break;
+    }
+
+    if ( i > 0 )
+    { TPOOL->count    = i;		/* unused workers are never freed */
+      MemoryBarrier();
+      TPOOL->workers  = workers;
+      rc = 0;
+    }
+  }
+  pthread_mutex_unlock(&TPOOL->mutex);
+
+  if ( rc != 0 )
+    return PL_error(NULL, 0, ThError(rc), ERR_SYSCALL, "pthread_create");
+
+  return TRUE;
+}
+
+
+/* Submit the tasks of b.  Solver workers push on the pool deques, as
+   the other workers do not steal from them.  The solvers of a TB_FIRST
+   batch each get their own solver worker.  If this fails, the batch is
+   abandoned and we raise an exception.
+*/
+
+static int
+submit_task_batch(task_batch *b ARG_LD)
+{ task_worker *w = LD->thread.task_worker;
+  size_t i;
+
+  if ( (b->flags&TB_FIRST) )
+  { int rc = 0;
+
+    for(i=0; i<b->count; i++)
+    { if ( rc == 0 )
+	rc = assign_solver(&b->tasks[i]);
+      if ( rc != 0 )
+      { pthread_mutex_lock(&b->mutex);
+	if ( b->status == TB_RUNNING )
+	  decide_task_batch(b, TB_ABANDONED);
+	pthread_mutex_unlock(&b->mutex);
+	complete_task(&b->tasks[i], FALSE, FALSE, 0, 0 PASS_LD);
+      }
+    }
+
+    if ( rc != 0 )
+      return PL_error(NULL, 0, ThError(rc), ERR_SYSCALL, "pthread_create");
+    return TRUE;
+  }
+
+  for(i=0; i<b->count; i++)
+  { task_worker *to = w;
+
+    if ( !to || to->solver )
+      to = TPOOL->workers[ATOMIC_INC(&TPOOL->next)%TPOOL->count];
+    push_task(&to->deque, &b->tasks[i]);
+  }
+
+  wake_workers(b->count);
+  return TRUE;
+}
+
+
+/* Wait until `b` is decided.  Workers run tasks while waiting.  If we
+   are interrupted the batch is abandoned and we return FALSE with an
+   exception.
+*/
+
+static int
+wait_task_batch(task_batch *b ARG_LD)
+{ task_worker *w = LD->thread.task_worker;
+
+  if ( w )
+  { while( b->status == TB_RUNNING )
+    { task *t;
+
+      if ( is_signalled(LD) && PL_handle_signals() < 0 )
+	goto interrupted;
+      if ( w->stop )
+      { raise_task_cancelled(PASS_LD1);
+	goto interrupted;
+      }
+
+      if ( (t=find_task(w)) )
+	run_task(w, t PASS_LD);
+      else
+	wait_for_task(w, b);
+    }
+  } else
+  { pthread_mutex_lock(&b->mutex);
+    while( b->status == TB_RUNNING )
+    { struct timespec timeout;
+
+      get_current_timespec(&timeout);
+      timeout.tv_nsec += 250000000;
+      carry_timespec_nanos(&timeout);
+      pthread_cond_timedwait(&b->cond, &b->mutex, &timeout);
+
+      if ( b->status == TB_RUNNING && is_signalled(LD) )
+      { pthread_mutex_unlock(&b->mutex);
+	if ( PL_handle_signals() < 0 )
+	  goto interrupted;
+	pthread_mutex_lock(&b->mutex);
+      }
+    }
+    pthread_mutex_unlock(&b->mutex);
+  }
+
+  return TRUE;
+
+interrupted:
+  pthread_mutex_lock(&b->mutex);
+  if ( b->status == TB_RUNNING )
+    decide_task_batch(b, TB_ABANDONED);
+  pthread_mutex_unlock(&b->mutex);
+  wake_workers((size_t)-1);
+
+  return FALSE;
+}
+
+
+static int
+unify_task_results(task_batch *b, term_t goals ARG_LD)
+{ tb_status status;
+
+  pthread_mutex_lock(&b->mutex);
+  status = b->status;
+  pthread_mutex_unlock(&b->mutex);
+
+  switch(status)
+  { case TB_TRUE:
+    { term_t tail   = PL_copy_term_ref(goals);
+      term_t head   = PL_new_term_ref();
+      term_t goal   = PL_new_term_ref();
+      term_t result = PL_new_term_ref();
+      size_t i;
+
+      for(i=0; PL_get_list(tail, head, tail); i++)
+      { task *t = &b->tasks[i];
+	Module m = NULL;
+
+	if ( t->result &&
+	     !( PL_strip_module(head, &m, goal) &&
+		PL_recorded(t->result, result) &&
+		PL_unify(goal, result) ) )
+	  return FALSE;
+      }
+
+      return TRUE;
+    }
+    case TB_EXCEPTION:
+    { term_t ex = PL_new_term_ref();
+
+      return ( ex &&
+	       PL_recorded(b->exception, ex) &&
+	       PL_raise_exception(ex) );
+    }
+    default:
+      return FALSE;
+  }
+}
+
+
+static int
+get_task_action(term_t t, int i, int flag, int *flags ARG_LD)
+{ term_t a = PL_new_term_ref();
+  atom_t action;
+
+  _PL_get_arg(i, t, a);
+  if ( !PL_get_atom_ex(a, &action) )
+    return FALSE;
+  if ( action == ATOM_continue )
+    *flags |= flag;
+  else if ( action != ATOM_stop )
+    return PL_domain_error("task_action", a);
+
+  return TRUE;
+}
+
+
+static int
+get_task_mode(term_t mode, int *flags ARG_LD)
+{ atom_t a;
+
+  if ( PL_get_atom(mode, &a) )
+  { if ( a == ATOM_all )
+    { *flags = 0;
+      return TRUE;
+    } else if ( a == ATOM_forall )
+    { *flags = TB_NO_RESULTS;
+      return TRUE;
+    }
+  } else if ( PL_is_functor(mode, FUNCTOR_first2) )
+  { *flags = TB_FIRST;
+
+    return ( get_task_action(mode, 1, TB_CONTINUE_ON_FAIL,  flags PASS_LD) &&
+	     get_task_action(mode, 2, TB_CONTINUE_ON_ERROR, flags PASS_LD) );
+  }
+
+  return PL_domain_error("task_mode", mode);
+}
+
+
+/** '$run_tasks'(:Goals, +Mode)
+ *
+ * Run the goals of the list Goals as tasks on the task scheduler.  Mode
+ * is one of
+ *
+ *   - all
+ *     Succeed if all goals succeed, unifying each goal with its
+ *     instantiation.  Stop at the first failure or exception.
+ *   - forall
+ *     As `all`, but do not return the bindings.
+ *   - first(OnFail, OnError)
+ *     Succeed with the bindings of the first goal that succeeds.  Each
+ *     goal runs in a solver worker of its own.  OnFail and OnError are
+ *     `stop` or `continue` and tell whether a failure or exception of
+ *     a goal decides the batch.
+ */
+
+static
+PRED_IMPL("$run_tasks", 2, run_tasks, PL_FA_TRANSPARENT)
+{ PRED_LD
+  term_t tail = PL_copy_term_ref(A1);
+  term_t head = PL_new_term_ref();
+  term_t goal = PL_new_term_ref();
+  task_batch *b;
+  size_t i, count, bsize;
+  int flags = 0, rc;
+
+  switch( PL_skip_list(A1, 0, &count) )
+  { case PL_LIST:
+      break;
+    case PL_PARTIAL_LIST:
+      return PL_instantiation_error(A1);
+    default:
+      return PL_type_error("list", A1);
+  }
+  if ( !get_task_mode(A2, &flags PASS_LD) )
+    return FALSE;
+  if ( count == 0 )
+    return !(flags&TB_FIRST);
+  if ( !start_task_pool() )
+    return FALSE;
+
+  bsize = offsetof(task_batch, tasks) + count*sizeof(task);
+  b = PL_malloc(bsize);
+  memset(b, 0, bsize);
+  pthread_mutex_init(&b->mutex, NULL);
+  pthread_cond_init(&b->cond, NULL);
+  b->flags      = flags;
+  b->count      = count;
+  b->pending    = count;
+  b->references = count+1;
+
+  for(i=0; PL_get_list(tail, head, tail); i++)
+  { task *t = &b->tasks[i];
+    Module m = NULL;
+
+    t->batch = b;
+    if ( !PL_strip_module_ex(head, &m, goal) )
+      goto error;
+    if ( !PL_is_callable(goal) )
+    { PL_type_error("callable", goal);
+      goto error;
+    }
+    t->module = m;
+    t->goal   = PL_record(goal);
+  }
+
+  if ( (rc = submit_task_batch(b PASS_LD)) &&
+       (rc = wait_task_batch(b PASS_LD)) )
+    rc = unify_task_results(b, A1 PASS_LD);
+  release_task_batch(b);
+
+  return rc;
+
+error:
+  free_task_batch(b);
+  return FALSE;
+}
+
+
 		 /*******************************
 		 *	     STATISTICS		*
 		 *******************************/
@@ -6395,6 +7905,8 @@ localiseDefinition(Definition def)
   clear(local, P_THREAD_LOCAL|P_DIRTYREG);	/* remains P_DYNAMIC */
   local->impl.clauses.first_clause = NULL;
   local->impl.clauses.clause_indexes = NULL;
+  local->range_indexes = NULL;
+  local->unlocked_writers = 0;
   ATOMIC_INC(&GD->statistics.predicates);
   ATOMIC_ADD(&local->module->code_size, sizeof(*local));
   DEBUG(MSG_PROC_COUNT, Sdprintf("Localise %s\n", predicateName(def)));
@@ -6485,6 +7997,11 @@ signalGCThread(int sig)
   return raiseSignal(LD, sig);
 }
 
+int
+signalIndexBuilder(void)
+{ return FALSE;
+}
+
 int
 isSignalledGCThread(int sig ARG_LD)
 { return PL_pending(sig);
@@ -7042,11 +8559,15 @@ BeginPredDefs(thread)
   PRED_DEF("message_queue_property", 2,	message_property,      NDET|PL_FA_ISO)
   PRED_DEF("thread_send_message",    2,	thread_send_message,   PL_FA_ISO)
   PRED_DEF("thread_send_message",    3,	thread_send_message,   0)
+  PRED_DEF("thread_send_messages",   2,	thread_send_messages,  0)
+  PRED_DEF("thread_send_messages",   3,	thread_send_messages,  0)
   PRED_DEF("thread_get_message",     1,	thread_get_message,    PL_FA_ISO)
   PRED_DEF("thread_get_message",     2,	thread_get_message,    PL_FA_ISO)
   PRED_DEF("thread_get_message",     3,	thread_get_message,    PL_FA_ISO)
   PRED_DEF("thread_peek_message",    1,	thread_peek_message_1, PL_FA_ISO)
   PRED_DEF("thread_peek_message",    2,	thread_peek_message_2, PL_FA_ISO)
+  PRED_DEF("thread_get_messages",    3,	thread_get_messages,   0)
+  PRED_DEF("thread_get_messages",    4,	thread_get_messages,   0)
   PRED_DEF("message_queue_destroy",  1,	message_queue_destroy, PL_FA_ISO)
   PRED_DEF("thread_setconcurrency",  2,	thread_setconcurrency, 0)
 
@@ -7064,5 +8585,6 @@ BeginPredDefs(thread)
   PRED_DEF("$gc_wait",               1, gc_wait,               0)
   PRED_DEF("$gc_clear",              1, gc_clear,              0)
   PRED_DEF("$gc_stop",               0, gc_stop,               0)
+  PRED_DEF("$run_tasks",             2, run_tasks,             PL_FA_TRANSPARENT)
 #endif
 EndPredDefs
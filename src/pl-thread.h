@@ -85,6 +85,10 @@ typedef struct
 { HANDLE events[MAX_EVENTS];		/* events to be signalled */
   int    waiters;			/* # waiters */
 } win32_cond_t;
+
+typedef win32_cond_t queue_cond_t;
+#else
+typedef pthread_cond_t queue_cond_t;
 #endif
 
 typedef struct _PL_thread_info_t
@@ -99,6 +103,7 @@ typedef struct _PL_thread_info_t
   unsigned	    in_exit_hooks : 1;	/* TRUE: running exit hooks */
   unsigned	    has_tid       : 1;	/* TRUE: tid = valid */
   unsigned	    is_engine	  : 1;	/* TRUE: created as engine */
+  unsigned	    pooled	  : 1;	/* TRUE: recycle local data */
   thread_status	    status;		/* PL_THREAD_* */
   pthread_t	    tid;		/* Thread identifier */
 #ifdef __linux__
@@ -150,23 +155,24 @@ typedef struct thread_handle
 #define QTYPE_THREAD	0
 #define QTYPE_QUEUE	1
 
+typedef struct message_chain
+{ struct thread_message   *head;	/* First message with this key */
+  struct thread_message   *tail;	/* Last message with this key */
+} message_chain;
+
 typedef struct message_queue
 { simpleMutex	       mutex;		/* Message queue mutex */
-#ifdef __WINDOWS__
-  win32_cond_t	       cond_var;
-  win32_cond_t	       drain_var;
-#else
-  pthread_cond_t       cond_var;	/* condvar for reading */
-  pthread_cond_t       drain_var;	/* condvar for writing */
-#endif
+  queue_cond_t	       drain_var;	/* condvar for writing */
+  struct queue_waiter *waiters;		/* Threads blocked reading */
   struct thread_message   *head;	/* Head of message queue */
   struct thread_message   *tail;	/* Tail of message queue */
+  Table		       index;		/* Message key --> message_chain */
+  message_chain	       unkeyed;		/* Messages without a key */
   uint64_t	       sequence_next;	/* next for sequence id */
   word		       id;		/* Id of the queue */
   size_t	       size;		/* # terms in queue */
   size_t	       max_size;	/* Max # terms in queue */
   int		       waiting;		/* # waiting threads */
-  int		       waiting_var;	/* # waiting with unbound */
   int		       wait_for_drain;	/* # threads waiting for write */
   unsigned	anonymous : 1;		/* <message_queue>(0x...) */
   unsigned	initialized : 1;	/* Queue is initialised */
@@ -218,9 +224,11 @@ extern counting_mutex _PL_mutexes[];	/* Prolog mutexes */
 #define L_UMUTEX       23
 #define L_INIT_ATOMS   24
 #define L_CGCGEN       25
+#define L_QLF	       26
+#define L_GENERATION   27
 #ifdef __WINDOWS__
-#define L_DDE	       26
-#define L_CSTACK       27
+#define L_DDE	       28
+#define L_CSTACK       29
 #endif
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -366,6 +374,7 @@ extern int		PL_thread_self(void);
 
 COMMON(const char *)	threadName(int id);
 COMMON(void)		executeThreadSignals(int sig);
+COMMON(void)		executeTaskCancel(int sig);
 COMMON(foreign_t)	pl_attach_xterm(term_t in, term_t out);
 COMMON(int)		attachConsole(void);
 COMMON(Definition)	localiseDefinition(Definition def);
@@ -456,6 +465,7 @@ COMMON(size_t)	popNPredicateAccess__LD(size_t n ARG_LD);
 COMMON(void)	markAccessedPredicates(PL_local_data_t *ld);
 COMMON(int)     cgc_thread_stats(cgc_stats *stats ARG_LD);
 COMMON(int)	signalGCThread(int sig);
+COMMON(int)	signalIndexBuilder(void);
 COMMON(int)	isSignalledGCThread(int sig ARG_LD);
 
 #endif /*PL_THREAD_H_DEFINED*/
@@ -1602,6 +1602,27 @@ VMI(I_CONTEXT, 0, 1, (CA1_MODULE))
 
   setContextModule(FR, m);
 
+  NEXT_INSTRUCTION;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+I_INLINE proc stamp jmp starts a call to  proc  that has been integrated
+into the clause by the compiler (see compileInline()).  It is followed
+by the normal call, a C_JMP and the  integrated  body.  If the callee is
+still the one we integrated (its   last_modified generation is `stamp')
+we jump to the integrated body.   Otherwise,  in  debug  mode and if the
+callee has a spy point we perform the normal call.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+VMI(I_INLINE, 0, 3, (CA1_PROC,CA1_INTEGER,CA1_JUMP))
+{ Definition def = ((Procedure)PC[0])->definition;
+
+  if ( likely((code)def->last_modified == PC[1] &&
+	      !debugstatus.debugging &&
+	      false(def, SPY_ME)) )
+    PC += PC[2];
+  PC += 3;
+
   NEXT_INSTRUCTION;
 }
 
@@ -1625,6 +1646,9 @@ VMI(I_CALL, VIF_BREAK, 1, (CA1_PROC))
   NFR = lTop;
   setNextFrameFlags(NFR, FR);
   DEF = proc->definition;
+  if ( (DEF->flags & (P_LEAF|P_TRANSPARENT)) == P_LEAF &&
+       likely(!LD->alerted) )
+    goto leaf_call;
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 This is the common part of the call variations.  By now the following is
@@ -1782,6 +1806,113 @@ retry_continue:
 
   PC = DEF->codes;
   NEXT_INSTRUCTION;
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Call a foreign predicate registered with PL_FA_LEAF. Such predicates are
+deterministic, do not call Prolog and do  not depend on the context
+module.  If  nothing  is  alerted  (debugger,  signals,  profiler,
+limits) we call the function directly from here rather than running the
+I_FOPEN, I_FCALLDET* and I_FEXITDET supervisor and leaving the frame
+through I_EXIT.  We only fill the frame slots needed by GC, stack
+shifts and PL_error() and the FliFrame for term references created by
+the function.  Success continues the caller; failure and exceptions
+are handled in the context of the caller, as for the arithmetic
+instructions.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+leaf_call:
+  if ( unlikely(addPointer(lTop, LOCAL_MARGIN) > (void*)lMax) )
+    goto normal_call;
+  { Func f = DEF->impl.foreign.function;
+    int arity = DEF->functor->arity;
+    FliFrame ffr = (FliFrame)argFrameP(NFR, arity);
+    term_t h0 = argFrameP(NFR, 0) - (Word)lBase;
+    fid_t ffr_id;
+    word rc;
+
+    NFR->parent         = FR;
+    setFramePredicate(NFR, DEF);
+    NFR->programPointer = PC;
+    NFR->clause         = NULL;
+#ifdef O_PROFILE
+    NFR->prof_node      = NULL;
+#endif
+    environment_frame = FR = NFR;
+    LD->statistics.inferences++;
+
+    lTop = (LocalFrame)(ffr+1);
+    ffr->size = 0;
+    NoMark(ffr->mark);
+    ffr->parent = fli_context;
+    ffr->magic = FLI_MAGIC;
+    fli_context = ffr;
+    ffr_id = consTermRef(ffr);
+    SAVE_REGISTERS(qid);
+
+    if ( true(DEF, P_VARARG) )
+    { struct foreign_context context;
+
+      context.context   = 0L;
+      context.engine    = LD;
+      context.control   = FRG_FIRST_CALL;
+      context.predicate = DEF;
+      rc = (*f)(h0, arity, &context);
+    } else
+    { switch(arity)
+      { case 0:  rc = (*f)(); break;
+	case 1:  rc = (*f)(h0); break;
+	case 2:  rc = (*f)(h0, h0+1); break;
+	case 3:  rc = (*f)(h0, h0+1, h0+2); break;
+	case 4:  rc = (*f)(h0, h0+1, h0+2, h0+3); break;
+	case 5:  rc = (*f)(h0, h0+1, h0+2, h0+3, h0+4); break;
+	case 6:  rc = (*f)(h0, h0+1, h0+2, h0+3, h0+4, h0+5); break;
+	case 7:  rc = (*f)(h0, h0+1, h0+2, h0+3, h0+4, h0+5, h0+6); break;
+	case 8:  rc = (*f)(h0, h0+1, h0+2, h0+3, h0+4, h0+5, h0+6, h0+7);
+		 break;
+	case 9:  rc = (*f)(h0, h0+1, h0+2, h0+3, h0+4, h0+5, h0+6, h0+7,
+			   h0+8);
+		 break;
+	case 10: rc = (*f)(h0, h0+1, h0+2, h0+3, h0+4, h0+5, h0+6, h0+7,
+			   h0+8, h0+9);
+		 break;
+	default:
+	  assert(0);
+	  rc = FALSE;
+      }
+    }
+
+    LOAD_REGISTERS(qid);
+    ffr = (FliFrame)valTermRef(ffr_id);
+    fli_context = ffr->parent;
+
+    if ( unlikely(rc != TRUE) )
+    { if ( rc != FALSE )
+      { fid_t fid = PL_open_foreign_frame();
+	term_t ex = PL_new_term_ref();
+
+	PL_put_intptr(ex, rc);
+	PL_error(NULL, 0, NULL, ERR_DOMAIN,
+		 ATOM_foreign_return_value, ex);
+	PL_close_foreign_frame(fid);
+      }
+    } else if ( unlikely(exception_term != 0) )	/* false alarm */
+    { PL_clear_foreign_exception(FR);
+    }
+
+    lTop = FR;
+    PC = FR->programPointer;
+    environment_frame = FR = FR->parent;
+    DEF = FR->predicate;
+    ARGP = argFrameP(lTop, 0);
+
+    if ( rc != TRUE )
+    { if ( exception_term )
+	THROW_EXCEPTION;
+      FRAME_FAILED;
+    }
+    CHECK_WAKEUP;
+    NEXT_INSTRUCTION;
+  }
 }
 
 
@@ -1795,10 +1926,16 @@ atom-gc ok, but this destroys  the  environment   for  normal  GC if the
 undefined predicate trapping code starts a GC. Therefore, undefined code
 runs normal I_CALL. This isn't too  bad,   as  it only affects the first
 call.
+
+Leaf foreign predicates also use I_CALL (see leaf_call). This is fine as
+the code following I_DEPART always leads to I_EXIT.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 VMI(I_DEPART, VIF_BREAK, 1, (CA1_PROC))
-{ if ( (void *)BFR <= (void *)FR && truePrologFlag(PLFLAG_LASTCALL) )
+{ if ( true(((Procedure)*PC)->definition, P_LEAF) && !LD->alerted )
+    VMI_GOTO(I_CALL);			/* see leaf_call */
+
+  if ( (void *)BFR <= (void *)FR && truePrologFlag(PLFLAG_LASTCALL) )
   { Procedure proc = (Procedure) *PC++;
 
     if ( !proc->definition->impl.any.defined &&	/* see (*) */
@@ -2721,6 +2858,8 @@ END_SHAREDVARS
 S_VIRGIN: Fresh, unused predicate. Any new   predicate  is created using
 this supervisor (see resetProcedure()). The task of this is to
 
+	* Load the clauses of a lazily loaded QLF predicate (see
+	loadLazyDefinition()).
 	* Resolve the definition (i.e. auto-import or auto-load if
 	not defined).
 	* Check the indexing opportunities and install the proper
@@ -2730,6 +2869,12 @@ this supervisor (see resetProcedure()). The task of this is to
 VMI(S_VIRGIN, 0, 0, ())
 { lTop = (LocalFrame)argFrameP(FR, FR->predicate->functor->arity);
 
+  if ( DEF->lazy )			/* clauses still in QLF file */
+  { SAVE_REGISTERS(qid);
+    loadLazyDefinition(DEF);
+    LOAD_REGISTERS(qid);
+  }
+
   if ( !DEF->impl.any.defined && false(DEF, PROC_DEFINED) )
   { SAVE_REGISTERS(qid);
     DEF = getProcDefinedDefinition(DEF PASS_LD);
@@ -3024,6 +3169,59 @@ VMI(S_LIST, 0, 2, (CA1_CLAUSEREF, CA1_CLAUSEREF))
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+S_SWITCH: Predicate whose clauses  all   have  a  different first-argument
+key. The arguments are the mask and shift  for switchSlot(), which are
+followed by a table of case entries.   See  switchSupervisor()  in
+pl-supervisor.c. The case entries are never  executed. Their opcode
+only describes the key: S_CASE for  an   atom  or small integer, S_FCASE
+for a functor and S_HCASE for the   hash of another constant. This makes
+vm_list/1 and atom garbage collection handle the key correctly.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+VMI(S_SWITCH, 0, 2, (CA1_INTEGER, CA1_INTEGER))
+{ size_t mask = (size_t)PC[0];
+  unsigned int shift = (unsigned int)PC[1];
+  ClauseRef cref;
+  Word k;
+  word key;
+  Code entry;
+
+  ARGP = argFrameP(FR, 0);
+  deRef2(ARGP, k);
+  if ( canBind(*k) )
+  { PC = SUPERVISOR(staticp) + 1;
+    VMI_GOTO(S_STATIC);
+  }
+
+  key = indexOfWord(*k PASS_LD);
+  entry = PC + 2 + 3*switchSlot(key, shift, mask);
+  if ( entry[1] != key )
+    FRAME_FAILED;
+  cref = (ClauseRef)entry[2];
+
+  TRUST_CLAUSE(cref);
+}
+
+
+VMI(S_CASE, 0, 2, (CA1_DATA, CA1_CLAUSEREF))
+{ PC += 2;
+  NEXT_INSTRUCTION;
+}
+
+
+VMI(S_FCASE, 0, 2, (CA1_FUNC, CA1_CLAUSEREF))
+{ PC += 2;
+  NEXT_INSTRUCTION;
+}
+
+
+VMI(S_HCASE, 0, 2, (CA1_INTEGER, CA1_CLAUSEREF))
+{ PC += 2;
+  NEXT_INSTRUCTION;
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Meta-predicate  argument  qualification.  S_MQUAL    qualifies  the  Nth
 argument. S_LMQUAL does the same and resets   the  context module of the
@@ -3309,39 +3507,130 @@ END_SHAREDVARS
 
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-A_ADD: Shorthand for A_FUNC2 pl_ar_add()
+A_ADD, A_SUB, A_MUL: Shorthands for A_FUNC2 with pl_ar_add(), ar_minus()
+and ar_mul().  If both operands are  integers   the  operation  is done
+inline  on  the  unboxed  values.  Integer  overflow  as  well  as  all
+other types are left to the generic function.
+
+A_FADD, A_FSUB, A_FMUL, A_FDIV: Emitted  by   the  compiler  if  one of
+the operands is known to be a float, which   implies that the result is
+a float. Integer operands are converted  to   double  inline as done by
+promoteToFloatNumber(). If the result is not   finite  or one of the
+operands is a big integer or rational we  use the generic function, so
+errors are raised exactly as without specialisation.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+BEGIN_SHAREDVARS
+  Number argv;
+  ArithF f;
+  double d1, d2;
+
 VMI(A_ADD, 0, 0, ())
-{ Number argv = argvArithStack(2 PASS_LD);
-  int rc;
-  number r;
+{ argv = argvArithStack(2 PASS_LD);
 
-  SAVE_REGISTERS(qid);
-  rc = pl_ar_add(argv, argv+1, &r);
-  LOAD_REGISTERS(qid);
-  popArgvArithStack(2 PASS_LD);
-  if ( rc )
-  { pushArithStack(&r PASS_LD);
-    NEXT_INSTRUCTION;
-  }
+  if ( argv[0].type == V_INTEGER && argv[1].type == V_INTEGER )
+  { int64_t i1 = argv[0].value.i;
+    int64_t i2 = argv[1].value.i;
+    int64_t r  = (int64_t)((uint64_t)i1 + (uint64_t)i2);
 
-  resetArithStack(PASS_LD1);
-  THROW_EXCEPTION;
+    if ( ((i1^r) & (i2^r)) >= 0 )	/* no overflow */
+    { argv[0].value.i = r;
+      popArgvArithStack(1 PASS_LD);
+      NEXT_INSTRUCTION;
+    }
+  }
+  f = pl_ar_add;
+  goto a_func2_generic;
 }
 
+VMI(A_SUB, 0, 0, ())
+{ argv = argvArithStack(2 PASS_LD);
 
-/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-A_MUL: Shorthand for A_FUNC2 ar_mul()
-- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+  if ( argv[0].type == V_INTEGER && argv[1].type == V_INTEGER )
+  { int64_t i1 = argv[0].value.i;
+    int64_t i2 = argv[1].value.i;
+    int64_t r  = (int64_t)((uint64_t)i1 - (uint64_t)i2);
+
+    if ( ((i1^i2) & (i1^r)) >= 0 )	/* no overflow */
+    { argv[0].value.i = r;
+      popArgvArithStack(1 PASS_LD);
+      NEXT_INSTRUCTION;
+    }
+  }
+  f = ar_minus;
+  goto a_func2_generic;
+}
 
 VMI(A_MUL, 0, 0, ())
-{ Number argv = argvArithStack(2 PASS_LD);
-  int rc;
+{ argv = argvArithStack(2 PASS_LD);
+
+  if ( argv[0].type == V_INTEGER && argv[1].type == V_INTEGER )
+  { int64_t i1 = argv[0].value.i;
+    int64_t i2 = argv[1].value.i;
+
+    if ( i1 >= INT32_MIN && i1 <= INT32_MAX &&	/* cannot overflow */
+	 i2 >= INT32_MIN && i2 <= INT32_MAX )
+    { argv[0].value.i = i1*i2;
+      popArgvArithStack(1 PASS_LD);
+      NEXT_INSTRUCTION;
+    }
+  }
+  f = ar_mul;
+  goto a_func2_generic;
+}
+
+VMI(A_FADD, 0, 0, ())
+{ f = pl_ar_add;
+  argv = argvArithStack(2 PASS_LD);
+  if ( floatArgvArithStack(argv, &d1, &d2) )
+  { d1 = d1+d2;
+    goto a_float_result;
+  }
+  goto a_func2_generic;
+}
+
+VMI(A_FSUB, 0, 0, ())
+{ f = ar_minus;
+  argv = argvArithStack(2 PASS_LD);
+  if ( floatArgvArithStack(argv, &d1, &d2) )
+  { d1 = d1-d2;
+    goto a_float_result;
+  }
+  goto a_func2_generic;
+}
+
+VMI(A_FMUL, 0, 0, ())
+{ f = ar_mul;
+  argv = argvArithStack(2 PASS_LD);
+  if ( floatArgvArithStack(argv, &d1, &d2) )
+  { d1 = d1*d2;
+    goto a_float_result;
+  }
+  goto a_func2_generic;
+}
+
+VMI(A_FDIV, 0, 0, ())
+{ int rc;
   number r;
 
+  f = ar_divide;
+  argv = argvArithStack(2 PASS_LD);
+  if ( floatArgvArithStack(argv, &d1, &d2) &&
+       d2 != 0.0 )
+  { d1 = d1/d2;
+
+  a_float_result:
+    if ( d1-d1 == 0.0 )			/* neither inf nor nan */
+    { argv[0].value.f = d1;
+      argv[0].type    = V_FLOAT;
+      popArgvArithStack(1 PASS_LD);
+      NEXT_INSTRUCTION;
+    }
+  }
+
+a_func2_generic:
   SAVE_REGISTERS(qid);
-  rc = ar_mul(argv, argv+1, &r);
+  rc = (*f)(argv, argv+1, &r);
   LOAD_REGISTERS(qid);
   popArgvArithStack(2 PASS_LD);
   if ( rc )
@@ -3352,6 +3641,7 @@ VMI(A_MUL, 0, 0, ())
   resetArithStack(PASS_LD1);
   THROW_EXCEPTION;
 }
+END_SHAREDVARS
 
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -3534,6 +3824,117 @@ VMI(A_NE, VIF_BREAK, 0, ())		/* A \=:= B */
   cmp = NE;
   goto acmp;
 }
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+A_CMP_VV cmp var1 var2
+A_CMP_VC cmp var smallint
+
+Compare-and-branch versions of A_LT  ...  A_NE  for  comparing  two
+variables or a variable and a small integer,   where  <cmp> is one of LT
+... EQ. If both values are small integers or floats we compare these
+directly (an integer  is  compared  to  a   float  as  double,  as  in
+cmpFloatNumbers()). Otherwise, and if an integer is compared to NaN, for
+which ar_compare() does not follow IEEE comparison (see CMP_FAST() for two
+floats), we evaluate the variables on the  arithmetic stack and use
+ar_compare().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define CMP_VALUES(v1, v2) \
+  switch(cmp) \
+  { case LT: rc = (v1) <  (v2); break; \
+    case GT: rc = (v1) >  (v2); break; \
+    case LE: rc = (v1) <= (v2); break; \
+    case GE: rc = (v1) >= (v2); break; \
+    case NE: rc = (v1) != (v2); break; \
+    default: rc = (v1) == (v2); break; \
+  }
+
+VMI(A_CMP_VV, VIF_BREAK, 3, (CA1_INTEGER, CA1_VAR, CA1_VAR))
+{ Word p1 = varFrameP(FR, PC[1]);
+  Word p2 = varFrameP(FR, PC[2]);
+
+  cmp = (int)PC[0];
+  deRef(p1);
+  deRef(p2);
+
+  if ( isTaggedInt(*p1) && isTaggedInt(*p2) )
+  { intptr_t i1 = valInt(*p1);
+    intptr_t i2 = valInt(*p2);
+
+    CMP_VALUES(i1, i2);
+  } else if ( (isFloat(*p1) || isTaggedInt(*p1)) &&
+	      (isFloat(*p2) || isTaggedInt(*p2)) )
+  { double f1 = isFloat(*p1) ? valFloat(*p1) : (double)valInt(*p1);
+    double f2 = isFloat(*p2) ? valFloat(*p2) : (double)valInt(*p2);
+
+    if ( isFloat(*p1) != isFloat(*p2) && (isnan(f1) || isnan(f2)) )
+      goto a_cmp_vv_generic;
+    CMP_VALUES(f1, f2);
+  } else
+  { a_cmp_vv_generic:
+    AR_BEGIN();
+    SAVE_REGISTERS(qid);
+    rc = ( push_arith_var(FR, (int)PC[1] PASS_LD) &&
+	   push_arith_var(FR, (int)PC[2] PASS_LD) );
+    LOAD_REGISTERS(qid);
+    PC += 3;
+    goto a_cmp_v_slow;
+  }
+
+  PC += 3;
+  if ( rc )
+    NEXT_INSTRUCTION;
+  FASTCOND_FAILED;
+}
+
+VMI(A_CMP_VC, VIF_BREAK, 3, (CA1_INTEGER, CA1_VAR, CA1_INTEGER))
+{ Word p = varFrameP(FR, PC[1]);
+  intptr_t i2 = (intptr_t)PC[2];
+
+  cmp = (int)PC[0];
+  deRef(p);
+
+  if ( isTaggedInt(*p) )
+  { intptr_t i1 = valInt(*p);
+
+    CMP_VALUES(i1, i2);
+  } else if ( isFloat(*p) )
+  { double f1 = valFloat(*p);
+
+    if ( isnan(f1) )
+      goto a_cmp_vc_generic;
+    CMP_VALUES(f1, (double)i2);
+  } else
+  { a_cmp_vc_generic:
+    AR_BEGIN();
+    SAVE_REGISTERS(qid);
+    if ( (rc = push_arith_var(FR, (int)PC[1] PASS_LD)) )
+    { Number n = allocArithStack(PASS_LD1);
+
+      n->value.i = i2;
+      n->type    = V_INTEGER;
+    }
+    LOAD_REGISTERS(qid);
+    PC += 3;
+
+  a_cmp_v_slow:
+    if ( !rc )
+    { resetArithStack(PASS_LD1);
+      AR_END();
+      THROW_EXCEPTION;
+    }
+    n1 = argvArithStack(2 PASS_LD);
+    n2 = n1 + 1;
+    goto acmp;
+  }
+
+  PC += 3;
+  if ( rc )
+    NEXT_INSTRUCTION;
+  FASTCOND_FAILED;
+}
+#undef CMP_VALUES
 END_SHAREDVARS
 
 
@@ -59,6 +59,13 @@ The counting code has been added   while investigating the time critical
 WAM  instructions.  The  current  implementation  runs  on  top  of  the
 information  provided  by  code_info   (from    pl-comp.c)   and  should
 automatically addapt to modifications in the VM instruction set.
+
+Besides counting instructions, we count  the   pairs  and triples of
+instructions where the next instruction is   the one that follows in the
+clause, i.e., the candidates for  superinstructions (see SUPERVMI and
+mkvmi.c).  Instructions reached through VMI_GOTO() are not part of a
+sequence.  '$count'/0 prints the  most   frequent  sequences  in the
+format of SUPERVMI.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 typedef struct
@@ -67,16 +74,75 @@ typedef struct
   int  *vartimesptr;
 } count_info;
 
+typedef struct
+{ code	codes[3];			/* the sequence */
+  int64_t times;			/* # times executed */
+} count_seq;
+
 #define MAXVAR 8
+#define MAXTRIPLES (1<<16)
+#define SHOWSEQ 40
 
 static count_info counting[I_HIGHEST];
+static int64_t	  count_pairs[I_HIGHEST][I_HIGHEST];
+static count_seq  count_triples[MAXTRIPLES];
+
+static struct
+{ code	prev[2];			/* last two instructions */
+  int	length;				/* # valid entries in prev */
+  Code	next;				/* Fall-through of prev[1] */
+} count_state;
+
+static void
+count_triple(code c1, code c2, code c3)
+{ unsigned int k = ((c1*I_HIGHEST+c2)*I_HIGHEST+c3)*2654435761U;
+  int i;
+
+  for(i=0; i<MAXTRIPLES; i++)
+  { count_seq *s = &count_triples[(k+i)%MAXTRIPLES];
+
+    if ( s->times == 0 )
+    { s->codes[0] = c1;
+      s->codes[1] = c2;
+      s->codes[2] = c3;
+    } else if ( s->codes[0] != c1 || s->codes[1] != c2 || s->codes[2] != c3 )
+      continue;
+    s->times++;
+    return;
+  }
+}
+
+static void
+count_sequence(code c, Code PC)
+{ const code_info *info = &codeTable[c];
+
+  if ( PC[-1] != encode(c) )		/* VMI_GOTO() */
+    return;
+
+  if ( count_state.length > 0 && PC-1 == count_state.next )
+  { count_pairs[count_state.prev[1]][c]++;
+    if ( count_state.length > 1 )
+      count_triple(count_state.prev[0], count_state.prev[1], c);
+    count_state.length = 2;
+  } else
+  { count_state.length = 1;
+  }
+
+  count_state.prev[0] = count_state.prev[1];
+  count_state.prev[1] = c;
+  if ( info->arguments == VM_DYNARGC )
+    count_state.next = stepDynPC(PC, info);
+  else
+    count_state.next = PC + info->arguments;
+}
 
 static void
 count(code c, Code PC)
 { const code_info *info = &codeTable[c];
 
   counting[c].times++;
-  switch(info->argtype)
+  count_sequence(c, PC);
+  switch(info->argtype[0])
   { case CA1_VAR:
     case CA1_FVAR:
     case CA1_CHP:
@@ -101,7 +167,8 @@ count(code c, Code PC)
 
 static void
 countHeader()
-{ int m;
+{ GET_LD
+  int m;
   int amax = MAXVAR;
   char last[20];
 
@@ -125,9 +192,70 @@ cmpcounts(const void *p1, const void *p2)
 }
 
 
+static int
+cmpseqs(const void *p1, const void *p2)
+{ const count_seq *s1 = p1;
+  const count_seq *s2 = p2;
+
+  return s1->times < s2->times ? 1 : s1->times > s2->times ? -1 : 0;
+}
+
+
+static void
+printVMIName(code c)
+{ GET_LD
+  const char *s;
+
+  for(s=codeTable[c].name; *s; s++)
+    Sputc(toupper(*s), Scurout);
+  Sputc(' ', Scurout);
+}
+
+
+static void
+countSequences(void)
+{ GET_LD
+  count_seq *seqs = allocHeapOrHalt(sizeof(count_seq)*MAXTRIPLES);
+  size_t n = 0;
+  int i, j;
+
+  for(i=0; i<I_HIGHEST; i++)
+  { for(j=0; j<I_HIGHEST; j++)
+    { if ( count_pairs[i][j] && n < MAXTRIPLES )
+      { seqs[n].codes[0] = i;
+	seqs[n].codes[1] = j;
+	seqs[n].codes[2] = I_HIGHEST;
+	seqs[n].times = count_pairs[i][j];
+	n++;
+      }
+    }
+  }
+  qsort(seqs, n, sizeof(count_seq), cmpseqs);
+  Sfprintf(Scurout, "\n# Instruction pairs\n");
+  for(i=0; i<n && i<SHOWSEQ; i++)
+  { printVMIName(seqs[i].codes[0]);
+    printVMIName(seqs[i].codes[1]);
+    Sfprintf(Scurout, "\t# %lld\n", (long long)seqs[i].times);
+  }
+
+  memcpy(seqs, count_triples, sizeof(count_seq)*MAXTRIPLES);
+  qsort(seqs, MAXTRIPLES, sizeof(count_seq), cmpseqs);
+  Sfprintf(Scurout, "\n# Instruction triples\n");
+  for(i=0; i<MAXTRIPLES && i<SHOWSEQ && seqs[i].times; i++)
+  { printVMIName(seqs[i].codes[0]);
+    printVMIName(seqs[i].codes[1]);
+    printVMIName(seqs[i].codes[2]);
+    Sfprintf(Scurout, "\t# %lld\n", (long long)seqs[i].times);
+  }
+
+  freeHeap(seqs, sizeof(count_seq)*MAXTRIPLES);
+}
+
+
 word
 pl_count()
-{ int i;
+{ GET_LD
+  int i;
   count_info counts[I_HIGHEST];
   count_info *c;
 
@@ -153,6 +281,8 @@ pl_count()
     Sfprintf(Scurout, "\n");
   }
 
+  countSequences();
+
   succeed;
 }
 
@@ -986,6 +1116,27 @@ put_vm_call(term_t t, term_t frref, Code PC, code op, int has_firstvar,
       *pop = 2;
       return rc;
     }
+    case A_CMP_VV:
+    case A_CMP_VC:
+    { Word gt       = allocGlobal(2+1+2);	/* call(A<cmp>B) */
+      LocalFrame fr = (LocalFrame)valTermRef(frref);
+      Word       v1 = varFrameP(fr, (int)PC[2]);
+
+      if ( !gt )
+	return FALSE;
+
+      gt[0] = arithCompareFunctor((int)PC[1]);
+      unify_gl(&gt[1], v1, has_firstvar PASS_LD);
+      if ( op == A_CMP_VV )
+	unify_gl(&gt[2], varFrameP(fr, (int)PC[3]), has_firstvar PASS_LD);
+      else
+	gt[2] = consInt((intptr_t)PC[3]);
+      gt[3] = FUNCTOR_call1;
+      gt[4] = consPtr(gt, STG_GLOBAL|TAG_COMPOUND);
+      *valTermRef(t) = consPtr(&gt[3], STG_GLOBAL|TAG_COMPOUND);
+
+      return TRUE;
+    }
     case A_IS:
     { Number     val = argvArithStack(1 PASS_LD);
       LocalFrame NFR = LD->query->next_environment;
@@ -1279,6 +1430,8 @@ __do_undo(mark *m ARG_LD)
   { reclaim_attvars(m->globaltop PASS_LD);
     gTop = m->globaltop;
   }
+  if ( LD->gc.young_offset && gTop < gBase + LD->gc.young_offset )
+    LD->gc.young_offset = 0;		/* see young_generation() */
 }
 
 
@@ -1342,7 +1495,9 @@ destroyLocalDefinition(Definition def, unsigned int tid)
 
 Definition
 getProcDefinition__LD(Definition def ARG_LD)
-{
+{ if ( unlikely(def->lazy != NULL) )
+    loadLazyDefinition(def);
+
 #ifdef O_PLMT
   if ( true(def, P_THREAD_LOCAL) )
   { return localDefinition(def PASS_LD);
@@ -2030,6 +2185,46 @@ copyFrameArguments(LocalFrame from, LocalFrame to, size_t argc ARG_LD)
     *ARGD++ = *ARGS++;
 }
 
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+push_arith_var() evaluates variable <offset> of  fr and pushes the value
+on the arithmetic stack. This is the slow   path of the A_CMP_* VMIs and
+must be called with saved registers.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+push_arith_var(LocalFrame fr, int offset ARG_LD)
+{ Word p = varFrameP(fr, offset);
+  Word p2;
+  Number n;
+  number result;
+  fid_t fid;
+  int rc;
+
+  deRef2(p, p2);
+  switch(tag(*p2))
+  { case TAG_INTEGER:
+      n = allocArithStack(PASS_LD1);
+      get_integer(*p2, n);
+      return TRUE;
+    case TAG_FLOAT:
+      n = allocArithStack(PASS_LD1);
+      n->value.f = valFloat(*p2);
+      n->type = V_FLOAT;
+      return TRUE;
+  }
+
+  if ( (fid = PL_open_foreign_frame()) )
+  { if ( (rc = valueExpression(consTermRef(p), &result PASS_LD)) )
+      pushArithStack(&result PASS_LD);
+    PL_close_foreign_frame(fid);
+  } else
+  { rc = FALSE;
+  }
+
+  return rc;
+}
+
 		/********************************
 		*          INTERPRETER          *
 		*********************************/
@@ -2739,6 +2934,9 @@ pl-comp.c
 
 #if VMCODE_IS_ADDRESS
 #include <pl-jumptable.ic>
+#if O_SUPERVMI
+#include <pl-superjumptable.ic>
+#endif
 
 #define VMI(Name,f,na,a)	Name ## _LBL: \
 				  count(Name, PC); \
@@ -2755,6 +2953,20 @@ pl-comp.c
 #endif
 #define SEPERATE_VMI ASM_NOP
 
+#if O_SUPERVMI
+/* Superinstructions, see mkvmi.c and pl-comp.c */
+#define SVMI(Name,First)	Name ## _LBL: \
+				  START_PROF(First, #First);
+#define SVMI_NEXT(l)		do { END_PROF(); \
+				     goto l; \
+				   } while(0)
+#define SVMI_STEP(l,Name)	l: \
+				  if ( unlikely(*PC != (code)&&Name ## _LBL) ) \
+				    NEXT_INSTRUCTION; \
+				  PC++; \
+				  START_PROF(Name, #Name);
+#endif
+
 #else /* VMCODE_IS_ADDRESS */
 
 code thiscode;
@@ -2794,6 +3006,9 @@ code thiscode;
 #if VMCODE_IS_ADDRESS
   if ( qid == QID_EXPORT_WAM_TABLE )
   { interpreter_jmp_table = jmp_table;	/* make it globally known */
+#if O_SUPERVMI
+    interpreter_super_jmp_table = super_jmp_table;
+#endif
     succeed;
   }
 #endif /* VMCODE_IS_ADDRESS */
@@ -2891,6 +3106,9 @@ resumebreak:
 #endif
   {
 #include "pl-vmi.c"
+#if O_SUPERVMI
+#include <pl-supervmi.ic>
+#endif
   }
 
 #ifdef O_ATTVAR
@@ -112,11 +112,11 @@ Below is an informal description of the format of a `.qlf' file:
 <statement>	::=	'W' <string>			% include wic file
 		      | 'P' <XR/functor>		% predicate
 			    <flags>
-			    {<clause>} <pattern>
+			    <section>
 		      |	'O' <XR/modulename>		% pred out of module
 			    <XR/functor>
 			    <flags>
-			    {<clause>} <pattern>
+			    <section>
 		      | 'D'
 		        <lineno>			% source line number
 			<term>				% directive
@@ -127,6 +127,9 @@ Below is an informal description of the format of a `.qlf' file:
 		            {<statement>}
 			    'X'
 <flags>		::=	<num>				% Bitwise or of PRED_*
+<section>	::=	{<XR>} 'X'			% XRs used by the clauses
+			<size>				% size of the clauses
+			{<clause>}
 <clause>	::=	'C' <#codes>
 			    <line_no>
 			    <owner_file>
@@ -172,8 +175,8 @@ write the positive value in chunks  of   7  bits, least significant bits
 first. The last byte has its 0x80 mask set.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-#define LOADVERSION 67			/* load all versions later >= X */
-#define VERSION     67			/* save version number */
+#define LOADVERSION 68			/* load all versions later >= X */
+#define VERSION     68			/* save version number */
 #define QLFMAGICNUM 0x716c7374		/* "qlst" on little-endian machine */
 
 #define XR_REF		0		/* reference to previous */
@@ -212,6 +215,8 @@ typedef struct source_mark
 #define XR_BLOCKS 32
 typedef struct xr_table
 { unsigned int	id;			/* next id to give out */
+  unsigned int	references;		/* loader + lazy sections */
+  char	       *file;			/* file name (for lazy errors) */
   struct xr_table* previous;		/* stack */
   Word	        blocks[XR_BLOCKS];	/* main table */
   word		preallocated[7];
@@ -237,6 +242,9 @@ typedef struct wic_state
 { char *wicFile;			/* name of output file */
   char *mkWicFile;			/* Wic file under construction */
   IOSTREAM *wicFd;			/* file descriptor of wic file */
+  IOSTREAM *xrFd;			/* XR definitions of open section */
+  char	   *section_data;		/* Clauses of open section */
+  size_t    section_size;		/* Size of section_data */
 
   Definition currentPred;		/* current procedure */
   SourceFile currentSource;		/* current source file */
@@ -255,6 +263,8 @@ typedef struct wic_state
   qlf_state *load_state;		/* current load-state */
 
   xr_table *XR;				/* external references */
+  struct qlf_section *pending;		/* Sections to be published */
+  struct qlf_section *pending_tail;	/* Last of pending */
 
   struct
   { int		invalid_wide_chars;	/* Cannot represent due to UCS-2 */
@@ -287,6 +297,11 @@ static atom_t	qlfFixSourcePath(wic_state *state, const char *raw);
 static int	pushPathTranslation(wic_state *state, const char *loadname, int flags);
 static void	popPathTranslation(wic_state *state);
 static int	qlfIsCompatible(wic_state *state, const char *magic);
+#ifdef O_PLMT
+static void	publishSections(wic_state *state ARG_LD);
+#else
+#define publishSections(state) (void)0
+#endif
 
 /* Convert CA1_VAR arguments to VM independent and back
 */
@@ -312,6 +327,7 @@ pushXrIdTable(wic_state *state)
 
   memset(t, 0, sizeof(*t));
   t->id = 0;
+  t->references = 1;
   t->blocks[0] = t->preallocated - 1;
   t->blocks[1] = t->preallocated - 1;
   t->blocks[2] = t->preallocated - 1;
@@ -321,12 +337,16 @@ pushXrIdTable(wic_state *state)
 }
 
 
+/* The table is shared with the lazy sections that use it (see
+   loadLazyDefinition()) and freed when the last of these is gone.
+*/
+
 static void
-popXrIdTable(wic_state *state)
-{ XrTable t = state->XR;
-  unsigned int id, idx;
+releaseXrIdTable(XrTable t)
+{ unsigned int id, idx;
 
-  state->XR = t->previous;		/* pop the stack */
+  if ( ATOMIC_DEC(&t->references) > 0 )
+    return;
 
   for(id=0; id < 7; id++)
   { word w = t->preallocated[id];
@@ -349,10 +369,21 @@ popXrIdTable(wic_state *state)
     freeHeap(p, bs*sizeof(word));
   }
 
+  if ( t->file )
+    remove_string(t->file);
   freeHeap(t, sizeof(*t));
 }
 
 
+static void
+popXrIdTable(wic_state *state)
+{ XrTable t = state->XR;
+
+  state->XR = t->previous;		/* pop the stack */
+  releaseXrIdTable(t);
+}
+
+
 static word
 lookupXrId(wic_state *state, unsigned int id)
 { XrTable t = state->XR;
@@ -991,11 +1022,14 @@ loadWicFd(wic_state *state)
     switch( c )
     { case EOF:
       case 'T':				/* trailer */
+	publishSections(state PASS_LD);
 	popPathTranslation(state);
 	succeed;
       case 'W':
 	{ char *name = store_string(getString(fd, NULL) );
 
+	  publishSections(state PASS_LD);
+
 	  if ( (name=getString(fd, NULL)) )
 	  { name = store_string(name);
 	    loadWicFile(name);
@@ -1020,6 +1054,9 @@ static bool
 loadStatement(wic_state *state, int c, int skip ARG_LD)
 { IOSTREAM *fd = state->wicFd;
 
+  if ( c != 'P' && c != 'O' )
+    publishSections(state PASS_LD);
+
   switch(c)
   { case 'P':
       return loadPredicate(state, skip PASS_LD);
@@ -1201,14 +1238,747 @@ resolve_rlabel(vm_rlabel_state *state, unsigned int id, Code base, Clause clause
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+A predicate is saved as a  section:  the   XR  definitions  needed by its
+clauses, followed by the size of the  clauses and the clauses themselves.
+As the clauses only refer to XRs   that  are already defined, the clauses
+can be decoded without modifying the XR  table. If the Prolog flag
+qlf_load_threads is non-zero, loadPredicate() passes  sections to a pool
+of helper threads.  The decoded clauses are  added to their predicates by
+publishSections() before the loader processes  a statement that may use
+them.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+typedef struct qlf_clause
+{ Clause	clause;			/* The clause (NULL if skipped) */
+  SourceFile	owner;			/* File that owns the clause */
+  SourceFile	source;			/* File the clause comes from */
+} qlf_clause;
+
+
+/* Load a clause after the 'C'
+*/
+
+static void
+loadClause(wic_state *state, Definition def, qlf_clause *lc,
+	   int skip ARG_LD)
+{ IOSTREAM *fd = state->wicFd;
+  Clause clause;
+  int has_dicts = 0;
+  tmp_buffer tbuf;
+  tmp_buffer *buf = &tbuf;
+  vm_rlabel_state lstate;
+
+  DEBUG(MSG_QLF_PREDICATE, Sdprintf("."));
+  initBuffer(buf);
+  init_rlabels(&lstate);
+  clause = (Clause)allocFromBuffer(buf, sizeofClause(0));
+  clause->references = 0;
+  clause->line_no    = getUInt(fd);
+
+  lc->owner  = (SourceFile) loadXR(state);
+  lc->source = (SourceFile) loadXR(state);
+  clause->owner_no  = (lc->owner  ? lc->owner->index  : 0);
+  clause->source_no = (lc->source ? lc->source->index : 0);
+
+  clearFlags(clause);
+  clause->prolog_vars = (unsigned short) getUInt(fd);
+  clause->variables   = (unsigned short) getUInt(fd);
+  if ( getUInt(fd) == 0 )		/* 0: fact */
+    set(clause, UNIT_CLAUSE);
+  clause->predicate = def;
+
+#define addCode(c) addBuffer(buf, (c), code)
+
+  for(;;)
+  { code op = getUInt(fd);
+    const char *ats;
+    int n = 0;
+
+    lstate.soi = entriesBuffer(buf, code);
+    switch(op)
+    { case V_LABEL:
+      { unsigned lbl = getUInt(fd);
+	resolve_rlabel(&lstate, lbl, baseBuffer(buf, code),
+		       baseBuffer(buf, struct clause));
+	continue;
+      }
+      case V_H_INTEGER:
+      case V_B_INTEGER:
+      { int64_t val = getInt64(fd);
+	word w = consInt(val);
+
+	if ( valInt(w) == val )
+	{ addCode(encode(op==V_H_INTEGER ? H_SMALLINT : B_SMALLINT));
+	  addCode(w);
+#if SIZEOF_VOIDP == 8
+	} else
+	{ addCode(encode(op==V_H_INTEGER ? H_INTEGER : B_INTEGER));
+	  addCode((intptr_t)val);
+	}
+#else
+	} else if ( val >= INTPTR_MIN && val <= INTPTR_MAX )
+	{ addCode(encode(op==V_H_INTEGER ? H_INTEGER : B_INTEGER));
+	  addCode((intptr_t)val);
+	} else
+	{ addCode(encode(op==V_H_INTEGER ? H_INT64 : B_INT64));
+	  addMultipleBuffer(buf, (char*)&val, sizeof(int64_t), char);
+	}
+#endif
+
+	continue;
+      }
+      case V_A_INTEGER:
+      { int64_t val = getInt64(fd);
+
+#if SIZEOF_VOIDP == 8
+	addCode(encode(A_INTEGER));
+	addCode((intptr_t)val);
+#else
+	if ( val >= INTPTR_MIN && val <= INTPTR_MAX )
+	{ addCode(encode(A_INTEGER));
+	  addCode((intptr_t)val);
+	} else
+	{ addCode(encode(A_INT64));
+	  addMultipleBuffer(buf, (char*)&val, sizeof(int64_t), char);
+	}
+#endif
+	continue;
+      }
+    }
+
+    if ( op >= I_HIGHEST )
+      fatalError("Illegal op-code (%d) at %ld", op, Stell(fd));
+
+    ats = codeTable[op].argtype;
+    DEBUG(MSG_QLF_VMI,
+	  Sdprintf("\t%s from %ld\n", codeTable[op].name, Stell(fd)));
+    if ( op == I_CONTEXT )
+    { clause = baseBuffer(buf, struct clause);
+      set(clause, CL_BODY_CONTEXT);
+    }
+    addCode(encode(op));
+    DEBUG(0,
+	  { const char ca1_float[2] = {CA1_FLOAT};
+	    const char ca1_int64[2] = {CA1_INT64};
+	    assert(codeTable[op].arguments == VM_DYNARGC ||
+		   (size_t)codeTable[op].arguments == strlen(ats) ||
+		   (streq(ats, ca1_float) &&
+		    codeTable[op].arguments == WORDS_PER_DOUBLE) ||
+		   (streq(ats, ca1_int64) &&
+		    codeTable[op].arguments == WORDS_PER_INT64));
+	  });
+
+    for(n=0; ats[n]; n++)
+    { switch(ats[n])
+      { case CA1_PROC:
+	{ addCode(loadXR(state));
+	  break;
+	}
+	case CA1_FUNC:
+	{ word w = loadXR(state);
+	  FunctorDef fd = valueFunctor(w);
+	  if ( fd->name == ATOM_dict )
+	    has_dicts++;
+
+	  addCode(w);
+	  break;
+	}
+	case CA1_DATA:
+	{ word w = loadXR(state);
+	  if ( isAtom(w) )
+	    PL_register_atom(w);
+	  addCode(w);
+	  break;
+	}
+	case CA1_AFUNC:
+	{ word f = loadXR(state);
+	  int  i = indexArithFunction(f);
+	  assert(i>0);
+	  addCode(i);
+	  break;
+	}
+	case CA1_MODULE:
+	  addCode(loadXR(state));
+	  break;
+	case CA1_JUMP:
+	{ unsigned lbl = getUInt(fd);
+	  size_t off = entriesBuffer(buf, code);
+	  addCode(lbl);
+	  push_rlabel(&lstate, lbl, off);
+	  break;
+	}
+	case CA1_INTEGER:
+	  addCode((code)getInt64(fd));
+	  break;
+	case CA1_VAR:
+	case CA1_FVAR:
+	case CA1_CHP:
+	  addCode((code)OFFSET_VAR(getInt64(fd)));
+	  break;
+	case CA1_INT64:
+	{ int64_t val = getInt64(fd);
+
+	  addMultipleBuffer(buf, (char*)&val, sizeof(int64_t), char);
+	  break;
+	}
+	case CA1_FLOAT:
+	{ double f = getFloat(fd);
+
+	  addMultipleBuffer(buf, (char*)&f, sizeof(double), char);
+	  break;
+	}
+	case CA1_STRING:		/* <n> chars */
+	{ size_t l = getInt(fd);
+	  int	c0 = Qgetc(fd);
+
+	  if ( c0 == 'B' )
+	  { int lw = (l+sizeof(word))/sizeof(word);
+	    int pad = (lw*sizeof(word) - l);
+	    Code bp;
+	    char *s;
+
+	    DEBUG(MSG_QLF_VMI, Sdprintf("String of %ld bytes\n", l));
+	    bp = allocFromBuffer(buf, sizeof(word)*(lw+1));
+	    s = (char *)&bp[1];
+	    *bp = mkStrHdr(lw, pad);
+	    bp += lw;
+	    *bp++ = 0L;
+	    *s++ = 'B';
+	    l--;
+	    while(l-- > 0)
+	      *s++ = Qgetc(fd);
+	  } else
+	  { size_t i;
+	    size_t  bs = (l+1)*sizeof(pl_wchar_t);
+	    size_t  lw = (bs+sizeof(word))/sizeof(word);
+	    int	   pad = (lw*sizeof(word) - bs);
+	    word     m = mkStrHdr(lw, pad);
+	    IOENC oenc = fd->encoding;
+
+	    DEBUG(MSG_QLF_VMI,
+		  Sdprintf("Wide string of %zd chars; lw=%zd; pad=%d\n",
+			   l, lw, pad));
+
+	    assert(c0 == 'W');
+
+	    addCode(m);			/* The header */
+	    addBuffer(buf, 'W', char);
+	    for(i=1; i<sizeof(pl_wchar_t); i++)
+	      addBuffer(buf, 0, char);
+
+	    fd->encoding = ENC_UTF8;
+	    for(i=0; i<l; i++)
+	    { int code = Sgetcode(fd);
+	      pl_wchar_t c = code;
+
+	      if ( (int)c != code )
+	      { state->errors.invalid_wide_chars++;
+		c = UTF8_MALFORMED_REPLACEMENT;
+	      }
+
+	      addBuffer(buf, c, pl_wchar_t);
+	    }
+	    fd->encoding = oenc;
+
+	    for(i=0; i<pad; i++)
+	      addBuffer(buf, 0, char);
+	  }
+	  break;
+	}
+	case CA1_MPZ:
+#ifdef O_GMP
+	DEBUG(MSG_QLF_VMI, Sdprintf("Loading MPZ from %ld\n", Stell(fd)));
+	{ ssize_t hdrsize = getInt64(fd);
+	  size_t  size	  = hdrsize >= 0 ? hdrsize : -hdrsize;
+	  size_t wsize, i, limpsize;
+	  mpz_t mpz;
+	  char fast[1024];
+	  char *cbuf;
+	  word m;
+	  Word p;
+
+	  if ( size < sizeof(fast) )
+	    cbuf = fast;
+	  else
+	    cbuf = PL_malloc(size);
+
+	  for(i=0; i<size; i++)
+	    cbuf[i] = Qgetc(fd);
+
+	  limpsize = (size+sizeof(mp_limb_t)-1)/sizeof(mp_limb_t);
+	  wsize	   = (limpsize*sizeof(mp_limb_t)+sizeof(word)-1)/sizeof(word);
+	  m	   = mkIndHdr(wsize+1, TAG_INTEGER);
+	  p	   = allocFromBuffer(buf, sizeof(word)*(wsize+2));
+
+	  *p++ = m;
+	  p[wsize] = 0;
+	  *p++ = hdrsize >= 0 ? limpsize : -limpsize;
+	  mpz->_mp_size	 = limpsize;
+	  mpz->_mp_alloc = limpsize;
+	  mpz->_mp_d	 = (mp_limb_t*)p;
+
+	  mpz_import(mpz, size, 1, 1, 1, 0, cbuf);
+	  assert((Word)mpz->_mp_d == p);	/* check no (re-)allocation is done */
+	  if ( cbuf != fast )
+	    PL_free(cbuf);
+
+	  DEBUG(MSG_QLF_VMI, Sdprintf("Loaded MPZ to %ld\n", Stell(fd)));
+	  break;
+	}
+#else
+	  fatalError("No support for MPZ numbers");
+#endif
+	default:
+	  fatalError("No support for VM argtype %d (arg %d of %s)",
+		     ats[n], n, codeTable[op].name);
+      }
+    }
+    switch(op)
+    { case I_EXITFACT:
+      case I_EXIT:			/* fact */
+	goto done;
+    }
+  }
+
+done:
+  exit_rlabels(&lstate);
+  lc->clause = NULL;
+
+  if ( !skip )
+  { size_t csize  = sizeOfBuffer(buf);
+    size_t ncodes = (csize-sizeofClause(0))/sizeof(code);
+    Clause bcl    = baseBuffer(buf, struct clause);
+
+    bcl->code_size = ncodes;
+    clause = (Clause)PL_malloc_atomic(csize);
+    memcpy(clause, bcl, csize);
+
+    if ( has_dicts )
+    { if ( !resortDictsInClause(clause) )
+      { outOfCore();
+	exit(1);
+      }
+    }
+    superInstructions(clause->codes, clause->code_size);
+    lc->clause = clause;
+  }
+
+  discardBuffer(buf);
+}
+
+
+/* Add a clause loaded by loadClause() to proc.  csfp keeps track of the
+   current source file for the predicate section.
+*/
+
+static void
+publishClause(wic_state *state, Procedure proc, SourceFile *csfp,
+	      qlf_clause *lc ARG_LD)
+{ SourceFile csf = *csfp;
+
+  if ( lc->owner && lc->owner != csf )
+  { addProcedureSourceFile(lc->source, proc);
+    *csfp = csf = lc->owner;
+  }
+
+  if ( lc->clause )
+  { Clause clause = lc->clause;
+
+    if ( true(clause, CL_BODY_CONTEXT) )
+      set(proc->definition, P_MFCONTEXT);
+    if ( csf )
+      csf->current_procedure = proc;
+
+    assertProcedureSource(csf, proc, clause PASS_LD);
+    GD->statistics.codes += clause->code_size;
+  }
+}
+
+
+#ifdef O_PLMT
+
+#define QPOOL (&GD->thread.qlf)
+#define QLF_SECTION_MIN 1024		/* Decode smaller sections inline */
+
+typedef struct qlf_section
+{ struct qlf_section *next;		/* Next in the pool queue */
+  struct qlf_section *next_pending;	/* Next to publish by the loader */
+  Procedure	proc;			/* Predicate of the section */
+  XrTable	xr;			/* XR table used by the section */
+  char	       *wicFile;		/* File loaded (for errors) */
+  char	       *data;			/* The raw clauses */
+  size_t	size;			/* Size of data */
+  PL_local_data_t *ld;			/* Engine that loads the file */
+  int		done;			/* Section is decoded */
+  int		invalid_wide_chars;	/* See wic_state.errors */
+  tmp_buffer	clauses;		/* Array of qlf_clause */
+} qlf_section;
+
+
+static void
+decodeSection(qlf_section *s)
+{ PL_local_data_t *__PL_ld = s->ld;
+  Definition def = s->proc->definition;
+  wic_state state;
+  IOSTREAM in;
+
+  memset(&state, 0, sizeof(state));
+  state.wicFile = s->wicFile;
+  state.wicFd   = Sopen_string(&in, s->data, s->size, "r");
+  state.XR      = s->xr;
+
+  for(;;)
+  { switch(Qgetc(&in))
+    { case 'C':
+      { qlf_clause lc;
+
+	loadClause(&state, def, &lc, FALSE PASS_LD);
+	addBuffer(&s->clauses, lc, qlf_clause);
+	continue;
+      }
+      case 'X':
+	break;
+      default:
+	qlfLoadError(&state);
+    }
+    break;
+  }
+
+  s->invalid_wide_chars = state.errors.invalid_wide_chars;
+  free(s->data);
+  s->data = NULL;
+}
+
+
+/* Must be called with QPOOL->mutex locked */
+
+static qlf_section *
+pop_section(void)
+{ qlf_section *s;
+
+  if ( (s=QPOOL->queue) )
+  { if ( !(QPOOL->queue = s->next) )
+      QPOOL->queue_tail = NULL;
+  }
+
+  return s;
+}
+
+
+static void *
+qlf_helper(void *closure)
+{
+#ifdef HAVE_SIGPROCMASK
+  sigset_t set;
+  allSignalMask(&set);
+  pthread_sigmask(SIG_BLOCK, &set, NULL);
+#endif
+  (void)closure;
+
+  pthread_mutex_lock(&QPOOL->mutex);
+  for(;;)
+  { qlf_section *s;
+
+    if ( (s=pop_section()) )
+    { pthread_mutex_unlock(&QPOOL->mutex);
+      decodeSection(s);
+      pthread_mutex_lock(&QPOOL->mutex);
+      s->done = TRUE;
+      pthread_cond_broadcast(&QPOOL->cond);
+    } else
+    { pthread_cond_wait(&QPOOL->cond, &QPOOL->mutex);
+    }
+  }
+
+  return NULL;
+}
+
+
+/* Make sure we have enough helpers.  Must be called with QPOOL->mutex
+   locked.
+*/
+
+static int
+start_qlf_helpers(void)
+{ while( QPOOL->running < QPOOL->threads )
+  { pthread_attr_t attr;
+    pthread_t thr;
+    int rc;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    rc = pthread_create(&thr, &attr, qlf_helper, NULL);
+    pthread_attr_destroy(&attr);
+    if ( rc != 0 )
+      break;
+    QPOOL->running++;
+  }
+
+  return QPOOL->running > 0;
+}
+
+
+static bool
+queueSection(wic_state *state, Procedure proc, size_t size ARG_LD)
+{ qlf_section *s = allocHeapOrHalt(sizeof(*s));
+
+  memset(s, 0, sizeof(*s));
+  if ( !(s->data = malloc(size)) )
+    outOfCore();
+  if ( Sfread(s->data, 1, size, state->wicFd) != size )
+    return qlfLoadError(state);
+
+  s->proc    = proc;
+  s->xr      = state->XR;
+  s->wicFile = state->wicFile;
+  s->size    = size;
+  s->ld      = LD;
+  initBuffer(&s->clauses);
+
+  if ( state->pending_tail )
+    state->pending_tail->next_pending = s;
+  else
+    state->pending = s;
+  state->pending_tail = s;
+
+  if ( size >= QLF_SECTION_MIN )
+  { pthread_mutex_lock(&QPOOL->mutex);
+    if ( start_qlf_helpers() )
+    { if ( QPOOL->queue_tail )
+	QPOOL->queue_tail->next = s;
+      else
+	QPOOL->queue = s;
+      QPOOL->queue_tail = s;
+      pthread_cond_broadcast(&QPOOL->cond);
+      pthread_mutex_unlock(&QPOOL->mutex);
+
+      succeed;
+    }
+    pthread_mutex_unlock(&QPOOL->mutex);
+  }
+
+  decodeSection(s);
+  s->done = TRUE;
+
+  succeed;
+}
+
+
+/* Add the clauses of all queued sections to their predicates in the
+   order in which they appear in the file.  While waiting for a section,
+   the loader decodes queued sections itself.
+*/
+
+static void
+publishSections(wic_state *state ARG_LD)
+{ qlf_section *s;
+
+  while( (s=state->pending) )
+  { qlf_clause *lc, *end;
+    SourceFile csf = NULL;
+
+    pthread_mutex_lock(&QPOOL->mutex);
+    while( !s->done )
+    { qlf_section *h;
+
+      if ( (h=pop_section()) )
+      { pthread_mutex_unlock(&QPOOL->mutex);
+	decodeSection(h);
+	pthread_mutex_lock(&QPOOL->mutex);
+	h->done = TRUE;
+	pthread_cond_broadcast(&QPOOL->cond);
+      } else
+      { pthread_cond_wait(&QPOOL->cond, &QPOOL->mutex);
+      }
+    }
+    pthread_mutex_unlock(&QPOOL->mutex);
+
+    if ( !(state->pending = s->next_pending) )
+      state->pending_tail = NULL;
+
+    lc  = baseBuffer(&s->clauses, qlf_clause);
+    end = topBuffer(&s->clauses, qlf_clause);
+    for(; lc < end; lc++)
+      publishClause(state, s->proc, &csf, lc PASS_LD);
+
+    state->errors.invalid_wide_chars += s->invalid_wide_chars;
+    discardBuffer(&s->clauses);
+    freeHeap(s, sizeof(*s));
+  }
+}
+
+#endif /*O_PLMT*/
+
+
+		 /*******************************
+		 *	    LAZY LOADING	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+If GD->options.lazy_load is  set  (--lazy_load   or  the lazy_load option
+of qsave_program/2), loadPredicate() does not  decode the clauses of
+static predicates.  Instead it keeps a copy  of the raw section together
+with the XR table it refers to  in   def->lazy.  The clauses are decoded
+by loadLazyDefinition(), which is called by S_VIRGIN on the first call
+and by getProcDefinition() for all other access to the clauses.
+
+Clauses are always appended.  Once  a   predicate  has  lazy sections,
+subsequent sections for it are lazy as well to preserve the order.  The
+clauses are born in the generation in which   the section was read, so
+running frames see them as if they were loaded eagerly.  Reloading a
+file is always eager as the reload compares the clauses.
+
+Sections are decoded while holding  L_QLF.   lazy_loader  is  the engine
+doing so, which stops the recursion through assertProcedure().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+typedef struct qlf_lazy
+{ struct qlf_lazy *next;		/* Next section of the predicate */
+  Procedure	proc;			/* Predicate of the section */
+  XrTable	xr;			/* XR table used by the section */
+  char	       *data;			/* The raw clauses */
+  size_t	size;			/* Size of data */
+  gen_t		generation;		/* Generation at load time */
+} qlf_lazy;
+
+static PL_local_data_t *lazy_loader;	/* Engine decoding (holds L_QLF) */
+
+static bool
+lazySection(wic_state *state, Procedure proc, size_t size)
+{ Definition def = proc->definition;
+  qlf_lazy *lz = allocHeapOrHalt(sizeof(*lz));
+
+  memset(lz, 0, sizeof(*lz));
+  if ( !(lz->data = malloc(size)) )
+    outOfCore();
+  if ( Sfread(lz->data, 1, size, state->wicFd) != size )
+    return qlfLoadError(state);
+
+  lz->proc	 = proc;
+  lz->xr	 = state->XR;
+  lz->size	 = size;
+  lz->generation = global_generation();
+  if ( !lz->xr->file )
+    lz->xr->file = store_string(state->wicFile);
+  ATOMIC_INC(&lz->xr->references);
+
+  PL_LOCK(L_QLF);
+  if ( def->lazy )
+  { qlf_lazy *last;
+
+    for(last=def->lazy; last->next; last=last->next)
+      ;
+    last->next = lz;
+  } else
+  { def->lazy = lz;
+    freeCodesDefinition(def, TRUE);	/* make S_VIRGIN load it */
+  }
+  PL_UNLOCK(L_QLF);
+
+  succeed;
+}
+
+
+static void
+freeLazySection(qlf_lazy *lz)
+{ free(lz->data);
+  releaseXrIdTable(lz->xr);
+  freeHeap(lz, sizeof(*lz));
+}
+
+
+static void
+decodeLazySection(qlf_lazy *lz ARG_LD)
+{ Definition def = lz->proc->definition;
+  SourceFile csf = NULL;
+  wic_state state;
+  IOSTREAM in;
+
+  memset(&state, 0, sizeof(state));
+  state.wicFile = lz->xr->file;
+  state.wicFd   = Sopen_string(&in, lz->data, lz->size, "r");
+  state.XR      = lz->xr;
+
+  for(;;)
+  { switch(Qgetc(&in))
+    { case 'C':
+      { qlf_clause lc;
+
+	loadClause(&state, def, &lc, FALSE PASS_LD);
+	publishClause(&state, lz->proc, &csf, &lc PASS_LD);
+#ifdef O_LOGICAL_UPDATE
+	lc.clause->generation.created = lz->generation;
+#endif
+	continue;
+      }
+      case 'X':
+	break;
+      default:
+	qlfLoadError(&state);
+    }
+    break;
+  }
+}
+
+
+/* Decode the lazy sections of def, adding the clauses to it */
+
+void
+loadLazyDefinition(Definition def)
+{ GET_LD
+  qlf_lazy *lz;
+
+  if ( lazy_loader == LD )
+    return;
+
+  PL_LOCK(L_QLF);
+  if ( (lz=def->lazy) )
+  { lazy_loader = LD;
+    while(lz)
+    { qlf_lazy *next = lz->next;
+
+      decodeLazySection(lz PASS_LD);
+      freeLazySection(lz);
+      lz = next;
+    }
+    MemoryBarrier();
+    def->lazy = NULL;
+    lazy_loader = NULL;
+  }
+  PL_UNLOCK(L_QLF);
+}
+
+
+/* Drop the lazy sections of def without loading them */
+
+void
+discardLazyDefinition(Definition def)
+{ qlf_lazy *lz;
+
+  PL_LOCK(L_QLF);
+  lz = def->lazy;
+  def->lazy = NULL;
+  PL_UNLOCK(L_QLF);
+
+  while(lz)
+  { qlf_lazy *next = lz->next;
+
+    freeLazySection(lz);
+    lz = next;
+  }
+}
+
+
 static bool
 loadPredicate(wic_state *state, int skip ARG_LD)
 { IOSTREAM *fd = state->wicFd;
   Procedure proc;
   Definition def;
-  Clause clause;
   functor_t f = (functor_t) loadXR(state);
   SourceFile csf = NULL;
+  size_t size;
+  int c;
 
   proc = lookupProcedureToDefine(f, LD->modules.source);
   DEBUG(MSG_QLF_PREDICATE, Sdprintf("Loading %s%s",
@@ -1217,7 +1987,11 @@ loadPredicate(wic_state *state, int skip ARG_LD)
 
   def = proc->definition;
   if ( !skip && state->currentSource )
-  { if ( def->impl.any.defined )
+  { if ( def->lazy )
+    { publishSections(state PASS_LD);
+      loadLazyDefinition(def);
+    }
+    if ( def->impl.any.defined )
     { if ( !redefineProcedure(proc, state->currentSource, DISCONTIGUOUS_STYLE) )
       { int rc = printMessage(ATOM_error, exception_term);
 	(void)rc;
@@ -1229,325 +2003,42 @@ loadPredicate(wic_state *state, int skip ARG_LD)
   }
   loadPredicateFlags(state, def, skip);
 
+  while( (c=Qgetc(fd)) != 'X' )		/* XR definitions of the section */
+  { if ( c == EOF )
+      return qlfLoadError(state);
+    loadXRc(state, c PASS_LD);
+  }
+  size = (size_t)getInt64(fd);
+
+  if ( !skip && (GD->options.lazy_load || def->lazy) &&
+       false(def, P_DYNAMIC|P_THREAD_LOCAL) &&
+       !(state->currentSource && state->currentSource->reload) )
+  { publishSections(state PASS_LD);	/* keep the clause order */
+    return lazySection(state, proc, size);
+  }
+
+#ifdef O_PLMT
+  if ( !skip && QPOOL->threads > 0 )
+    return queueSection(state, proc, size PASS_LD);
+#else
+  (void)size;
+#endif
+
   for(;;)
-  { switch(Qgetc(fd) )
+  { switch(Qgetc(fd))
     { case 'X':
       { DEBUG(MSG_QLF_PREDICATE, Sdprintf("ok\n"));
 	succeed;
       }
       case 'C':
-      { int has_dicts = 0;
-	tmp_buffer buf;
-	vm_rlabel_state lstate;
-
-	DEBUG(MSG_QLF_PREDICATE, Sdprintf("."));
-	initBuffer(&buf);
-	init_rlabels(&lstate);
-	clause = (Clause)allocFromBuffer(&buf, sizeofClause(0));
-	clause->references = 0;
-	clause->line_no    = getUInt(fd);
-
-	{ SourceFile of = (void *) loadXR(state);
-	  SourceFile sf = (void *) loadXR(state);
-	  unsigned int ono = (of ? of->index : 0);
-	  unsigned int sno = (sf ? sf->index : 0);
-
-	  clause->owner_no = ono;
-	  clause->source_no = sno;
-	  if ( of && of != csf )
-	  { addProcedureSourceFile(sf, proc);
-	    csf = of;
-	  }
-	}
+      { qlf_clause lc;
 
-	clearFlags(clause);
-	clause->prolog_vars = (unsigned short) getUInt(fd);
-	clause->variables   = (unsigned short) getUInt(fd);
-	if ( getUInt(fd) == 0 )		/* 0: fact */
-	  set(clause, UNIT_CLAUSE);
-	clause->predicate = def;
-
-#define addCode(c) addBuffer(&buf, (c), code)
-
-	for(;;)
-	{ code op = getUInt(fd);
-	  const char *ats;
-	  int n = 0;
-
-	  lstate.soi = entriesBuffer(&buf, code);
-	  switch(op)
-	  { case V_LABEL:
-	    { unsigned lbl = getUInt(fd);
-	      resolve_rlabel(&lstate, lbl, baseBuffer(&buf, code),
-			     baseBuffer(&buf, struct clause));
-	      continue;
-	    }
-	    case V_H_INTEGER:
-	    case V_B_INTEGER:
-	    { int64_t val = getInt64(fd);
-	      word w = consInt(val);
-
-	      if ( valInt(w) == val )
-	      { addCode(encode(op==V_H_INTEGER ? H_SMALLINT : B_SMALLINT));
-		addCode(w);
-#if SIZEOF_VOIDP == 8
-	      } else
-	      { addCode(encode(op==V_H_INTEGER ? H_INTEGER : B_INTEGER));
-		addCode((intptr_t)val);
-	      }
-#else
-	      } else if ( val >= INTPTR_MIN && val <= INTPTR_MAX )
-	      { addCode(encode(op==V_H_INTEGER ? H_INTEGER : B_INTEGER));
-		addCode((intptr_t)val);
-	      } else
-	      { addCode(encode(op==V_H_INTEGER ? H_INT64 : B_INT64));
-		addMultipleBuffer(&buf, (char*)&val, sizeof(int64_t), char);
-	      }
-#endif
-
-	      continue;
-	    }
-	    case V_A_INTEGER:
-	    { int64_t val = getInt64(fd);
-
-#if SIZEOF_VOIDP == 8
-	      addCode(encode(A_INTEGER));
-	      addCode((intptr_t)val);
-#else
-	      if ( val >= INTPTR_MIN && val <= INTPTR_MAX )
-	      { addCode(encode(A_INTEGER));
-		addCode((intptr_t)val);
-	      } else
-	      { addCode(encode(A_INT64));
-		addMultipleBuffer(&buf, (char*)&val, sizeof(int64_t), char);
-	      }
-#endif
-	      continue;
-	    }
-	  }
-
-	  if ( op >= I_HIGHEST )
-	    fatalError("Illegal op-code (%d) at %ld", op, Stell(fd));
-
-	  ats = codeTable[op].argtype;
-	  DEBUG(MSG_QLF_VMI,
-		Sdprintf("\t%s from %ld\n", codeTable[op].name, Stell(fd)));
-	  if ( op == I_CONTEXT )
-	  { clause = baseBuffer(&buf, struct clause);
-	    set(clause, CL_BODY_CONTEXT);
-	    set(def, P_MFCONTEXT);
-	  }
-	  addCode(encode(op));
-	  DEBUG(0,
-		{ const char ca1_float[2] = {CA1_FLOAT};
-		  const char ca1_int64[2] = {CA1_INT64};
-		  assert(codeTable[op].arguments == VM_DYNARGC ||
-			 (size_t)codeTable[op].arguments == strlen(ats) ||
-			 (streq(ats, ca1_float) &&
-			  codeTable[op].arguments == WORDS_PER_DOUBLE) ||
-			 (streq(ats, ca1_int64) &&
-			  codeTable[op].arguments == WORDS_PER_INT64));
-		});
-
-	  for(n=0; ats[n]; n++)
-	  { switch(ats[n])
-	    { case CA1_PROC:
-	      { addCode(loadXR(state));
-		break;
-	      }
-	      case CA1_FUNC:
-	      { word w = loadXR(state);
-		FunctorDef fd = valueFunctor(w);
-		if ( fd->name == ATOM_dict )
-		  has_dicts++;
-
-		addCode(w);
-		break;
-	      }
-	      case CA1_DATA:
-	      { word w = loadXR(state);
-		if ( isAtom(w) )
-		  PL_register_atom(w);
-		addCode(w);
-		break;
-	      }
-	      case CA1_AFUNC:
-	      { word f = loadXR(state);
-		int  i = indexArithFunction(f);
-		assert(i>0);
-		addCode(i);
-		break;
-	      }
-	      case CA1_MODULE:
-		addCode(loadXR(state));
-		break;
-	      case CA1_JUMP:
-	      { unsigned lbl = getUInt(fd);
-		size_t off = entriesBuffer(&buf, code);
-		addCode(lbl);
-		push_rlabel(&lstate, lbl, off);
-		break;
-	      }
-	      case CA1_INTEGER:
-		addCode((code)getInt64(fd));
-		break;
-	      case CA1_VAR:
-	      case CA1_FVAR:
-	      case CA1_CHP:
-		addCode((code)OFFSET_VAR(getInt64(fd)));
-		break;
-	      case CA1_INT64:
-	      { int64_t val = getInt64(fd);
-
-		addMultipleBuffer(&buf, (char*)&val, sizeof(int64_t), char);
-		break;
-	      }
-	      case CA1_FLOAT:
-	      { double f = getFloat(fd);
-
-		addMultipleBuffer(&buf, (char*)&f, sizeof(double), char);
-		break;
-	      }
-	      case CA1_STRING:		/* <n> chars */
-	      { size_t l = getInt(fd);
-		int   c0 = Qgetc(fd);
-
-		if ( c0 == 'B' )
-		{ int lw = (l+sizeof(word))/sizeof(word);
-		  int pad = (lw*sizeof(word) - l);
-		  Code bp;
-		  char *s;
-
-		  DEBUG(MSG_QLF_VMI, Sdprintf("String of %ld bytes\n", l));
-		  bp = allocFromBuffer(&buf, sizeof(word)*(lw+1));
-		  s = (char *)&bp[1];
-		  *bp = mkStrHdr(lw, pad);
-		  bp += lw;
-		  *bp++ = 0L;
-		  *s++ = 'B';
-		  l--;
-		  while(l-- > 0)
-		    *s++ = Qgetc(fd);
-		} else
-		{ size_t i;
-		  size_t  bs = (l+1)*sizeof(pl_wchar_t);
-		  size_t  lw = (bs+sizeof(word))/sizeof(word);
-		  int    pad = (lw*sizeof(word) - bs);
-		  word	   m = mkStrHdr(lw, pad);
-		  IOENC oenc = fd->encoding;
-
-		  DEBUG(MSG_QLF_VMI,
-			Sdprintf("Wide string of %zd chars; lw=%zd; pad=%d\n",
-				 l, lw, pad));
-
-		  assert(c0 == 'W');
-
-		  addCode(m);		/* The header */
-		  addBuffer(&buf, 'W', char);
-		  for(i=1; i<sizeof(pl_wchar_t); i++)
-		    addBuffer(&buf, 0, char);
-
-		  fd->encoding = ENC_UTF8;
-		  for(i=0; i<l; i++)
-		  { int code = Sgetcode(fd);
-		    pl_wchar_t c = code;
-
-		    if ( (int)c != code )
-		    { state->errors.invalid_wide_chars++;
-		      c = UTF8_MALFORMED_REPLACEMENT;
-		    }
-
-		    addBuffer(&buf, c, pl_wchar_t);
-		  }
-		  fd->encoding = oenc;
-
-		  for(i=0; i<pad; i++)
-		    addBuffer(&buf, 0, char);
-		}
-		break;
-	      }
-	      case CA1_MPZ:
-#ifdef O_GMP
-	      DEBUG(MSG_QLF_VMI, Sdprintf("Loading MPZ from %ld\n", Stell(fd)));
-	      { ssize_t hdrsize = getInt64(fd);
-		size_t  size    = hdrsize >= 0 ? hdrsize : -hdrsize;
-		size_t wsize, i, limpsize;
-		mpz_t mpz;
-		char fast[1024];
-		char *cbuf;
-		word m;
-		Word p;
-
-		if ( size < sizeof(fast) )
-		  cbuf = fast;
-		else
-		  cbuf = PL_malloc(size);
-
-		for(i=0; i<size; i++)
-		  cbuf[i] = Qgetc(fd);
-
-		limpsize = (size+sizeof(mp_limb_t)-1)/sizeof(mp_limb_t);
-		wsize    = (limpsize*sizeof(mp_limb_t)+sizeof(word)-1)/sizeof(word);
-		m	 = mkIndHdr(wsize+1, TAG_INTEGER);
-		p	 = allocFromBuffer(&buf, sizeof(word)*(wsize+2));
-
-		*p++ = m;
-		p[wsize] = 0;
-		*p++ = hdrsize >= 0 ? limpsize : -limpsize;
-		mpz->_mp_size  = limpsize;
-		mpz->_mp_alloc = limpsize;
-		mpz->_mp_d     = (mp_limb_t*)p;
-
-		mpz_import(mpz, size, 1, 1, 1, 0, cbuf);
-		assert((Word)mpz->_mp_d == p);	/* check no (re-)allocation is done */
-		if ( cbuf != fast )
-		  PL_free(cbuf);
-
-		DEBUG(MSG_QLF_VMI, Sdprintf("Loaded MPZ to %ld\n", Stell(fd)));
-		break;
-	      }
-#else
-		fatalError("No support for MPZ numbers");
-#endif
-	      default:
-		fatalError("No support for VM argtype %d (arg %d of %s)",
-			   ats[n], n, codeTable[op].name);
-	    }
-	  }
-	  switch(op)
-	  { case I_EXITFACT:
-	    case I_EXIT:			/* fact */
-	      goto done;
-	  }
-	}
-
-      done:
-	exit_rlabels(&lstate);
-
-	if ( !skip )
-	{ size_t csize  = sizeOfBuffer(&buf);
-	  size_t ncodes = (csize-sizeofClause(0))/sizeof(code);
-	  Clause bcl    = baseBuffer(&buf, struct clause);
-
-	  bcl->code_size = ncodes;
-	  clause = (Clause)PL_malloc_atomic(csize);
-	  memcpy(clause, bcl, csize);
-
-	  if ( has_dicts )
-	  { if ( !resortDictsInClause(clause) )
-	    { outOfCore();
-	      exit(1);
-	    }
-	  }
-	  if ( csf )
-	    csf->current_procedure = proc;
-
-	  assertProcedureSource(csf, proc, clause PASS_LD);
-	  GD->statistics.codes += clause->code_size;
-	}
-
-        discardBuffer(&buf);
+	loadClause(state, def, &lc, skip PASS_LD);
+	publishClause(state, proc, &csf, &lc PASS_LD);
+	break;
       }
+      default:
+	return qlfLoadError(state);
     }
   }
 }
@@ -1813,7 +2304,8 @@ loadPart(wic_state *state, Module *module, int skip ARG_LD)
 
     switch(c)
     { case 'X':
-      { if ( !GD->bootsession  )
+      { publishSections(state PASS_LD);
+	if ( !GD->bootsession  )
 	{ runInitialization(state->currentSource);
 	  if ( state->currentSource )
 	    endConsult(state->currentSource);
@@ -2067,6 +2559,11 @@ that pointers are 4-byte aligned.
 savedXRConstant()  must  be  used  for    atom_t  and  functor_t,  while
 savedXRPointer  must  be  used  for   the    pointers.   The  value  for
 savedXRConstant() is or-ed with 0x1 to avoid conflict with pointers.
+
+Inside a predicate section (see openPredicateWic()), the definition of a
+new XR is written to the section header  (state->xrFd) and the clause only
+holds an XR_REF.  To realise this, savedXR()  redirects state->wicFd and
+the saveXR*() functions restore it after writing the definition.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 static int
@@ -2083,6 +2580,12 @@ savedXR(wic_state *state, void *xr)
   } else
   { id = ++state->savedXRTableId;
     addNewHTable(state->savedXRTable, xr, (void *)(intptr_t)id);
+
+    if ( state->xrFd && fd != state->xrFd )
+    { Sputc(XR_REF, fd);
+      putUInt(id, fd);
+      state->wicFd = state->xrFd;
+    }
   }
 
   fail;
@@ -2168,6 +2671,7 @@ saveXR__LD(wic_state *state, word xr ARG_LD)
   { DEBUG(MSG_QLF_XR,
 	  Sdprintf("XR(%d) = '%s'\n", state->savedXRTableId, stringAtom(xr)));
     putAtom(state, xr);
+    state->wicFd = fd;
     return;
   }
 
@@ -2178,44 +2682,50 @@ saveXR__LD(wic_state *state, word xr ARG_LD)
 
 static void
 saveXRBlobType(wic_state *state, PL_blob_t *type)
-{ IOSTREAM *fd = state->wicFd;
+{ IOSTREAM *body = state->wicFd;
+  IOSTREAM *fd;
 
   if ( savedXRPointer(state, type) )
     return;
 
+  fd = state->wicFd;
   Sputc(XR_BLOB_TYPE, fd);
   putString(type->name, STR_NOLEN, fd);
+  state->wicFd = body;
 }
 
 
 static void
 saveXRModule(wic_state *state, Module m ARG_LD)
-{ IOSTREAM *fd = state->wicFd;
+{ IOSTREAM *body = state->wicFd;
 
   if ( !m )
-  { Sputc(XR_NULL, fd);
+  { Sputc(XR_NULL, body);
     return;
   }
 
   if ( savedXRPointer(state, m) )
     return;
 
-  Sputc(XR_MODULE, fd);
+  Sputc(XR_MODULE, state->wicFd);
   DEBUG(MSG_QLF_XR,
 	Sdprintf("XR(%d) = module %s\n",
 		 state->savedXRTableId, stringAtom(m->name)));
   saveXR(state, m->name);
+  state->wicFd = body;
 }
 
 
 static void
 saveXRFunctor(wic_state *state, functor_t f ARG_LD)
-{ IOSTREAM *fd = state->wicFd;
+{ IOSTREAM *body = state->wicFd;
+  IOSTREAM *fd;
   FunctorDef fdef;
   functor_t mapped;
 
   if ( savedXRConstant(state, f) )
     return;
+  fd = state->wicFd;
 
   if ( state->idMap &&
        (mapped = (functor_t)lookupHTable(state->idMap, (void*)f)) )
@@ -2229,30 +2739,34 @@ saveXRFunctor(wic_state *state, functor_t f ARG_LD)
   Sputc(XR_FUNCTOR, fd);
   saveXR(state, fdef->name);
   putInt64(fdef->arity, fd);
+  state->wicFd = body;
 }
 
 
 static void
 saveXRProc(wic_state *state, Procedure p ARG_LD)
-{ IOSTREAM *fd = state->wicFd;
+{ IOSTREAM *body = state->wicFd;
 
   if ( savedXRPointer(state, p) )
     return;
 
   DEBUG(MSG_QLF_XR, Sdprintf("XR(%d) = proc %s\n",
 			     state->savedXRTableId, procedureName(p)));
-  Sputc(XR_PRED, fd);
+  Sputc(XR_PRED, state->wicFd);
   saveXRFunctor(state, p->definition->functor->functor PASS_LD);
   saveXRModule(state, p->definition->module PASS_LD);
+  state->wicFd = body;
 }
 
 
 static void
 saveXRSourceFile(wic_state *state, SourceFile f ARG_LD)
-{ IOSTREAM *fd = state->wicFd;
+{ IOSTREAM *body = state->wicFd;
+  IOSTREAM *fd;
 
   if ( savedXRPointer(state, f) )
     return;
+  fd = state->wicFd;
 
   Sputc(XR_FILE, fd);
 
@@ -2266,6 +2780,7 @@ saveXRSourceFile(wic_state *state, SourceFile f ARG_LD)
   { DEBUG(MSG_QLF_XR, Sdprintf("XR(%d) = <no file>\n", state->savedXRTableId));
     Sputc('-', fd);
   }
+  state->wicFd = body;
 }
 
 
@@ -2670,10 +3185,30 @@ saveWicClause(wic_state *state, Clause clause)
 		*         COMPILATION           *
 		*********************************/
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+While a predicate is open, its clauses are written to a memory stream and
+the definitions of XRs they introduce  directly  to the file.  This makes
+the clauses of a section independent from   the XR table updates and thus
+allows loadPredicate() to decode sections concurrently.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
 static void
 closePredicateWic(wic_state *state)
 { if ( state->currentPred )
-  { Sputc('X', state->wicFd);
+  { IOSTREAM *fd = state->xrFd;
+
+    Sputc('X', state->wicFd);
+    Sclose(state->wicFd);
+    state->wicFd = fd;
+    state->xrFd  = NULL;
+
+    Sputc('X', fd);
+    putInt64(state->section_size, fd);
+    Sfwrite(state->section_data, 1, state->section_size, fd);
+    Sfree(state->section_data);
+    state->section_data = NULL;
+    state->section_size = 0;
+
     state->currentPred = NULL;
   }
 }
@@ -2701,10 +3236,11 @@ predicateFlags(Definition def, atom_t sclass)
 static void
 openPredicateWic(wic_state *state, Definition def, atom_t sclass ARG_LD)
 { if ( def != state->currentPred)
-  { IOSTREAM *fd = state->wicFd;
+  { IOSTREAM *fd;
     unsigned int mode = predicateFlags(def, sclass);
 
     closePredicateWic(state);
+    fd = state->wicFd;
     state->currentPred = def;
 
     if ( def->module != LD->modules.source )
@@ -2716,6 +3252,11 @@ openPredicateWic(wic_state *state, Definition def, atom_t sclass ARG_LD)
 
     saveXRFunctor(state, def->functor->functor PASS_LD);
     putUInt(mode, fd);
+
+    state->xrFd = fd;
+    if ( !(state->wicFd = Sopenmem(&state->section_data,
+				   &state->section_size, "wb")) )
+      outOfCore();
   }
 }
 
@@ -2751,9 +3292,10 @@ writeWicHeader(wic_state *state)
 
 static bool
 writeWicTrailer(wic_state *state)
-{ IOSTREAM *fd = state->wicFd;
+{ IOSTREAM *fd;
 
   closePredicateWic(state);
+  fd = state->wicFd;
   Sputc('X', fd);
   destroyXR(state);
   Sputc('T', fd);
@@ -2791,9 +3333,10 @@ addClauseWic(wic_state *state, term_t term, atom_t file ARG_LD)
 
 static bool
 addDirectiveWic(wic_state *state, term_t term ARG_LD)
-{ IOSTREAM *fd = state->wicFd;
+{ IOSTREAM *fd;
 
   closePredicateWic(state);
+  fd = state->wicFd;
   Sputc('D', fd);
   putInt64(source_line_no, fd);
 
@@ -3330,9 +3873,11 @@ qlfSaveSource(wic_state *state, SourceFile f)
 
 static bool
 qlfStartModule(wic_state *state, Module m ARG_LD)
-{ IOSTREAM *fd = state->wicFd;
+{ IOSTREAM *fd;
   ListCell c;
+
   closePredicateWic(state);
+  fd = state->wicFd;
   Sputc('Q', fd);
   Sputc('M', fd);
   saveXR(state, m->name);
@@ -3373,9 +3918,10 @@ qlfStartModule(wic_state *state, Module m ARG_LD)
 
 static bool
 qlfStartSubModule(wic_state *state, Module m ARG_LD)
-{ IOSTREAM *fd = state->wicFd;
+{ IOSTREAM *fd;
 
   closePredicateWic(state);
+  fd = state->wicFd;
   Sputc('M', fd);
   saveXR(state, m->name);
 
@@ -3385,9 +3931,10 @@ qlfStartSubModule(wic_state *state, Module m ARG_LD)
 
 static bool
 qlfStartFile(wic_state *state, SourceFile f)
-{ IOSTREAM *fd = state->wicFd;
+{ IOSTREAM *fd;
 
   closePredicateWic(state);
+  fd = state->wicFd;
   Sputc('Q', fd);
   qlfSaveSource(state, f);
 
@@ -3397,9 +3944,10 @@ qlfStartFile(wic_state *state, SourceFile f)
 
 static bool
 qlfEndPart(wic_state *state)
-{ IOSTREAM *fd = state->wicFd;
+{ IOSTREAM *fd;
 
   closePredicateWic(state);
+  fd = state->wicFd;
   Sputc('X', fd);
 
   succeed;
@@ -3494,8 +4042,10 @@ PRED_IMPL("$qlf_include", 5, qlf_include, 0)
        PL_get_atom_ex(A4, &fn) &&
        PL_get_float(A5, &time) &&
        (state=LD->qlf.current_state) )
-  { IOSTREAM *fd = state->wicFd;
+  { IOSTREAM *fd;
 
+    closePredicateWic(state);
+    fd = state->wicFd;
     Sputc('I', fd);
     saveXR(state, owner);
     saveXR(state, pn);